@@ -0,0 +1,376 @@
+/*
+  Name:         AnalysisScheduler.cpp (implementation)
+  Author:       Kip Warner (Kip@TheVertigo.com)
+  Description:  AnalysisScheduler class. Fans many media out across a pool of
+                worker threads, each with its own WormTracker...
+*/
+
+// Includes...
+#include "AnalysisScheduler.h"
+#include <algorithm>
+#include <cassert>
+
+// Worker constructor...
+AnalysisWorker::AnalysisWorker(AnalysisScheduler &_Scheduler)
+    : wxThread(wxTHREAD_JOINABLE),
+      Scheduler(_Scheduler)
+{
+
+}
+
+// Thread entry point...
+void *AnalysisWorker::Entry()
+{
+    // Variables...
+    string  sPath;
+
+    // Our very own tracker, configured afresh for each media...
+    WormTracker Tracker;
+
+    // Our analyzer checks with us periodically whether we should stop...
+    MediaAnalyzer Analyzer(Tracker, this);
+    Analyzer.SetFrameQueueDepth(Scheduler.unFrameQueueDepth);
+    Analyzer.SetFrameStride(Scheduler.unFrameStride);
+    Analyzer.SetKeyframesOnly(Scheduler.bKeyframesOnly);
+    Analyzer.SetSegments(Scheduler.unSegments);
+
+    // Keep taking media off the queue until there is none left...
+    while(!TestDestroy() && Scheduler.TakeNextMedia(sPath))
+    {
+        // Prepare the result...
+        MediaAnalysisResult Result;
+        Result.sPath        = sPath;
+
+        // Configure the tracker just like the scheduler's again. Calibrating
+        //  the last media overwrote its threshold and candidate size window,
+        //  which would otherwise carry over to whatever this one can't
+        //  calibrate for itself...
+        Tracker.ImportSettings(Scheduler.PrototypeTracker);
+
+        // Analyze...
+        Result.bSucceeded   = Analyzer.Analyze(sPath);
+
+        // We were stopped part way through, so the result is incomplete...
+        if(TestDestroy())
+            break;
+
+        // Collect the measurements...
+        if(Result.bSucceeded)
+        {
+            Analyzer.GetMeasurements(Result.Measurements);
+            Result.PipelineStalls = Analyzer.GetPipelineStalls();
+            Result.Timings        = Tracker.GetStageTimings();
+            Result.Savings        = Analyzer.GetDecodeSavings();
+
+            // And every frame of them, if recorded...
+            if(Tracker.IsRecordingTimeSeries() &&
+               !Analyzer.GetTimeSeries(Result.TimeSeries))
+            {
+                Result.bSucceeded   = false;
+                Result.sError       = "Unable to read back the measurements"
+                                      " from every frame.";
+            }
+        }
+
+        // Or why it failed...
+        else
+            Result.sError = Analyzer.GetLastError();
+
+        // Hand it back to the scheduler...
+        Scheduler.PostResult(Result);
+    }
+
+    // Let the scheduler know we are done...
+    Scheduler.OnWorkerExit();
+
+    // Done...
+    return NULL;
+}
+
+// Has either the scheduler or wxWidgets asked us to stop?
+bool AnalysisWorker::TestDestroy()
+{
+    // Check both...
+    return Scheduler.IsCancelled() || wxThread::TestDestroy();
+}
+
+// Constructor takes the tracker whose field of view and artificial
+//  intelligence magic every worker's tracker should use...
+AnalysisScheduler::AnalysisScheduler(WormTracker const &SourceTracker)
+    : ResultPosted(ResourcesMutex),
+      unWorkersRunning(0),
+      unTotalMedia(0),
+      unCompletedMedia(0),
+      unFrameQueueDepth(MediaAnalyzer::DEFAULT_FRAME_QUEUE_DEPTH),
+      unFrameStride(1),
+      bKeyframesOnly(false),
+      unSegments(0),
+      bCancelled(false)
+{
+    // Remember the settings...
+    PrototypeTracker.ImportSettings(SourceTracker);
+}
+
+// Queue media to analyze. Must be called before Start()...
+void AnalysisScheduler::Add(string const &sPath)
+{
+    // Lock resources...
+    wxMutexLocker Lock(ResourcesMutex);
+
+    // Queue...
+    PendingMedia.push_back(sPath);
+  ++unTotalMedia;
+}
+
+// Stop every worker as soon as possible and wait for them...
+void AnalysisScheduler::Cancel()
+{
+    // Raise the flag and forget whatever has not started yet...
+    {
+        // Lock resources...
+        wxMutexLocker Lock(ResourcesMutex);
+
+        // Flag...
+        bCancelled = true;
+
+        // Forget...
+        PendingMedia.clear();
+    }
+
+    // Wait for each worker to notice and then clean it up. Workers never
+    //  touch the user interface, so there is no need to yield to it...
+    for(vector<AnalysisWorker *>::const_iterator Iterator = Workers.begin();
+        Iterator != Workers.end();
+      ++Iterator)
+    {
+        // Wait...
+        (*Iterator)->Wait(wxTHREAD_WAIT_BLOCK);
+
+        // Cleanup...
+        delete *Iterator;
+    }
+
+    // Forget the dead pointers...
+    Workers.clear();
+}
+
+// Number of media that have finished, successfully or not...
+unsigned int AnalysisScheduler::GetCompletedMedia() const
+{
+    // Lock resources...
+    wxMutexLocker Lock(ResourcesMutex);
+
+    // Return it...
+    return unCompletedMedia;
+}
+
+// Collect the next available result without blocking. False if none are ready
+//  yet...
+bool AnalysisScheduler::GetNextResult(MediaAnalysisResult &Result)
+{
+    // Lock resources...
+    wxMutexLocker Lock(ResourcesMutex);
+
+    // Nothing ready...
+    if(Results.empty())
+        return false;
+
+    // Hand over the oldest...
+    Result = Results.front();
+    Results.pop_front();
+
+    // Done...
+    return true;
+}
+
+// Total number of media queued since construction...
+unsigned int AnalysisScheduler::GetTotalMedia() const
+{
+    // Lock resources...
+    wxMutexLocker Lock(ResourcesMutex);
+
+    // Return it...
+    return unTotalMedia;
+}
+
+// Has a cancel been requested?
+bool AnalysisScheduler::IsCancelled() const
+{
+    // Lock resources...
+    wxMutexLocker Lock(ResourcesMutex);
+
+    // Return it...
+    return bCancelled;
+}
+
+// Are all workers done and every result collected?
+bool AnalysisScheduler::IsFinished() const
+{
+    // Lock resources...
+    wxMutexLocker Lock(ResourcesMutex);
+
+    // Check...
+    return (unWorkersRunning == 0) && Results.empty();
+}
+
+// A worker is about to exit...
+void AnalysisScheduler::OnWorkerExit()
+{
+    // Lock resources...
+    wxMutexLocker Lock(ResourcesMutex);
+
+    // One less...
+    assert(unWorkersRunning > 0);
+  --unWorkersRunning;
+
+    // Wake anyone waiting on a result that may now never come...
+    ResultPosted.Broadcast();
+}
+
+// A worker has finished analyzing a media...
+void AnalysisScheduler::PostResult(MediaAnalysisResult const &Result)
+{
+    // Lock resources...
+    wxMutexLocker Lock(ResourcesMutex);
+
+    // Store...
+    Results.push_back(Result);
+  ++unCompletedMedia;
+
+    // Wake anyone waiting on it...
+    ResultPosted.Broadcast();
+}
+
+// Set the number of decoded frames that may wait for each worker's tracker.
+//  Must be called before Start()...
+void AnalysisScheduler::SetFrameQueueDepth(unsigned int const unDepth)
+{
+    // Store it...
+    unFrameQueueDepth = unDepth;
+}
+
+// Set the number of frames each worker advances by through a video. Must be
+//  called before Start()...
+void AnalysisScheduler::SetFrameStride(unsigned int const unStride)
+{
+    // Store it...
+    unFrameStride = unStride;
+}
+
+// Decode and track only each video's keyframes. Must be called before
+//  Start()...
+void AnalysisScheduler::SetKeyframesOnly(bool const bEnable)
+{
+    // Store it...
+    bKeyframesOnly = bEnable;
+}
+
+// Split each long video a worker analyzes into this many segments of time,
+//  analyzed side by side. Must be called before Start()...
+void AnalysisScheduler::SetSegments(unsigned int const _unSegments)
+{
+    // Store it...
+    unSegments = _unSegments;
+}
+
+// Start the given number of workers, or one per processor if zero. Returns the
+//  number actually started...
+unsigned int AnalysisScheduler::Start(unsigned int unWorkers)
+{
+    // Use every processor if the caller didn't say...
+    if(unWorkers == 0)
+        unWorkers = std::max(wxThread::GetCPUCount(), 1);
+
+    // No point in having more workers than media...
+    unWorkers = std::min<unsigned int>(unWorkers, GetTotalMedia());
+
+    // Create and run each worker...
+    for(unsigned int unWorker = 0; unWorker < unWorkers; ++unWorker)
+    {
+        // Allocate...
+        AnalysisWorker *pWorker = new AnalysisWorker(*this);
+
+        // Create...
+        if(pWorker->Create() != wxTHREAD_NO_ERROR)
+        {
+            // Cleanup and stop trying...
+            delete pWorker;
+            break;
+        }
+
+        // Count it before it can possibly exit...
+        {
+            // Lock resources...
+            wxMutexLocker Lock(ResourcesMutex);
+
+            // Count...
+          ++unWorkersRunning;
+        }
+
+        // Run...
+        if(pWorker->Run() != wxTHREAD_NO_ERROR)
+        {
+            // Lock resources...
+            wxMutexLocker Lock(ResourcesMutex);
+
+            // Uncount, cleanup, and stop trying...
+          --unWorkersRunning;
+            delete pWorker;
+            break;
+        }
+
+        // Remember it...
+        Workers.push_back(pWorker);
+    }
+
+    // Return the number started...
+    return Workers.size();
+}
+
+// Take the next media off the queue. False if there is none...
+bool AnalysisScheduler::TakeNextMedia(string &sPath)
+{
+    // Lock resources...
+    wxMutexLocker Lock(ResourcesMutex);
+
+    // Nothing left, or we've been asked to stop...
+    if(PendingMedia.empty() || bCancelled)
+        return false;
+
+    // Take the oldest...
+    sPath = PendingMedia.front();
+    PendingMedia.pop_front();
+
+    // Done...
+    return true;
+}
+
+// Wait for the next result. False when no more will ever come...
+bool AnalysisScheduler::WaitForNextResult(MediaAnalysisResult &Result)
+{
+    // Lock resources...
+    wxMutexLocker Lock(ResourcesMutex);
+
+    // Wait until a result is posted, or there are no workers left to post...
+    while(Results.empty() && unWorkersRunning > 0)
+        ResultPosted.Wait();
+
+    // Nothing left...
+    if(Results.empty())
+        return false;
+
+    // Hand over the oldest...
+    Result = Results.front();
+    Results.pop_front();
+
+    // Done...
+    return true;
+}
+
+// Deconstructor...
+AnalysisScheduler::~AnalysisScheduler()
+{
+    // Make sure no worker is still touching us...
+    Cancel();
+}
+
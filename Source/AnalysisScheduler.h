@@ -0,0 +1,210 @@
+/*
+  Name:         AnalysisScheduler.h (definition)
+  Author:       Kip Warner (Kip@TheVertigo.com)
+  Description:  AnalysisScheduler class. Fans many media out across a pool of
+                worker threads, each with its own WormTracker...
+*/
+
+// Multiple include protection...
+#ifndef _ANALYSISSCHEDULER_H_
+#define _ANALYSISSCHEDULER_H_
+
+// Includes...
+
+    // Headless media analysis...
+    #include "MediaAnalyzer.h"
+
+    // wxWidgets threading...
+    #include <wx/thread.h>
+
+    // Standard libraries and STL...
+    #include <deque>
+    #include <string>
+    #include <vector>
+
+    // Using the standard namespace...
+    using namespace std;
+
+// Forward declarations...
+class AnalysisScheduler;
+
+// Result of analyzing a single media...
+typedef struct MediaAnalysisResult
+{
+    // Path to the media analyzed...
+    string                      sPath;
+
+    // Whether the analysis succeeded and, if not, why...
+    bool                        bSucceeded;
+    string                      sError;
+
+    // Body size measurements of every worm found...
+    vector<WormMeasurement>     Measurements;
+
+    // Each of those worms' measurements from every frame it was seen in, if
+    //  the tracker was recording them, in pixels...
+    vector<vector<WormSample> > TimeSeries;
+
+    // How much the decoder and tracker waited on each other, if a video...
+    FrameQueueStalls            PipelineStalls;
+
+    // Time the tracker spent in each stage...
+    StageTimings                Timings;
+
+    // How much decoding was avoided, if a video...
+    DecodeSavings               Savings;
+
+}MediaAnalysisResult;
+
+// Helper classes...
+
+    // A worker thread owns a tracker and keeps taking media off of the
+    //  scheduler's queue until there is nothing left...
+    class AnalysisWorker : public wxThread
+    {
+        // Public methods...
+        public:
+
+            // Constructor...
+            AnalysisWorker(AnalysisScheduler &_Scheduler);
+
+            // Thread entry point...
+            virtual void *Entry();
+
+            // Has either the scheduler or wxWidgets asked us to stop?
+            virtual bool TestDestroy();
+
+        // Protected attributes...
+        protected:
+
+            // The scheduler we take work from and report back to...
+            AnalysisScheduler  &Scheduler;
+    };
+
+// AnalysisScheduler class...
+class AnalysisScheduler
+{
+    // Friends...
+    friend class AnalysisWorker;
+
+    // Public methods...
+    public:
+
+        // Constructor takes the tracker whose field of view and artificial
+        //  intelligence magic every worker's tracker should use...
+        AnalysisScheduler(WormTracker const &SourceTracker);
+
+        // Accessors...
+
+            // Number of media that have finished, successfully or not...
+            unsigned int        GetCompletedMedia() const;
+
+            // Total number of media queued since construction...
+            unsigned int        GetTotalMedia() const;
+
+            // Are all workers done and every result collected?
+            bool                IsFinished() const;
+
+        // Mutators...
+
+            // Queue media to analyze. Must be called before Start()...
+            void                Add(string const &sPath);
+
+            // Stop every worker as soon as possible and wait for them...
+            void                Cancel();
+
+            // Collect the next available result without blocking. False if
+            //  none are ready yet...
+            bool                GetNextResult(MediaAnalysisResult &Result);
+
+            // Set the number of decoded frames that may wait for each
+            //  worker's tracker. Must be called before Start()...
+            void                SetFrameQueueDepth(unsigned int const unDepth);
+
+            // Set the number of frames each worker advances by through a
+            //  video. Must be called before Start()...
+            void                SetFrameStride(unsigned int const unStride);
+
+            // Decode and track only each video's keyframes. Must be called
+            //  before Start()...
+            void                SetKeyframesOnly(bool const bEnable);
+
+            // Split each long video a worker analyzes into this many segments
+            //  of time, analyzed side by side. Must be called before
+            //  Start()...
+            void                SetSegments(unsigned int const _unSegments);
+
+            // Start the given number of workers, or one per processor if
+            //  zero. Returns the number actually started...
+            unsigned int        Start(unsigned int unWorkers = 0);
+
+            // Wait for the next result. False when no more will ever come...
+            bool                WaitForNextResult(MediaAnalysisResult &Result);
+
+        // Deconstructor...
+       ~AnalysisScheduler();
+
+    // Protected methods...
+    protected:
+
+        // Accessors used by the workers...
+
+            // Has a cancel been requested?
+            bool                IsCancelled() const;
+
+        // Mutators used by the workers...
+
+            // A worker is about to exit...
+            void                OnWorkerExit();
+
+            // A worker has finished analyzing a media...
+            void                PostResult(MediaAnalysisResult const &Result);
+
+            // Take the next media off the queue. False if there is none...
+            bool                TakeNextMedia(string &sPath);
+
+    // Protected attributes...
+    protected:
+
+        // Every worker's tracker imports its settings from this one...
+        WormTracker                     PrototypeTracker;
+
+        // Resources mutex and the condition signalled whenever a result is
+        //  posted or a worker exits...
+        mutable wxMutex                 ResourcesMutex;
+        wxCondition                     ResultPosted;
+
+        // Media waiting to be analyzed...
+        deque<string>                   PendingMedia;
+
+        // Results waiting to be collected...
+        deque<MediaAnalysisResult>      Results;
+
+        // Worker threads...
+        vector<AnalysisWorker *>        Workers;
+
+        // Number of workers still running...
+        unsigned int                    unWorkersRunning;
+
+        // Media counts...
+        unsigned int                    unTotalMedia;
+        unsigned int                    unCompletedMedia;
+
+        // Number of decoded frames that may wait for each worker's tracker...
+        unsigned int                    unFrameQueueDepth;
+
+        // Number of frames to advance by through a video, and whether only
+        //  its keyframes are wanted...
+        unsigned int                    unFrameStride;
+        bool                            bKeyframesOnly;
+
+        // Number of segments to split each long video into, or zero for
+        //  none...
+        unsigned int                    unSegments;
+
+        // Set when a cancel has been requested...
+        bool                            bCancelled;
+};
+
+#endif
+
@@ -8,13 +8,23 @@
 #include "AnalysisThread.h"
 #include "MainFrame.h"
 #include "Experiment.h"
+#include "MediaAnalyzer.h"
 
 // Analysis thread constructor locks UI...
 AnalysisThread::AnalysisThread(MainFrame &_Frame)
     : wxThread(wxTHREAD_DETACHED),
-      Frame(_Frame),
-      pCapture(nullptr)
+      Frame(_Frame)
 {
+    // Read the decoder's queue depth and which frames to decode now, since
+    //  the configuration is not safe to touch from the thread...
+    unFrameQueueDepth = ::wxGetApp().pConfiguration->Read(
+        wxT("/Analysis/FrameQueueDepth"), 
+        (long) MediaAnalyzer::DEFAULT_FRAME_QUEUE_DEPTH);
+    unFrameStride = ::wxGetApp().pConfiguration->Read(
+        wxT("/Analysis/FrameStride"), 1L);
+    bKeyframesOnly = ::wxGetApp().pConfiguration->Read(
+        wxT("/Analysis/KeyframesOnly"), false);
+
     // Reset the tracker, if not already...
     Frame.Tracker.Reset(0);
     
@@ -43,14 +53,8 @@ void *AnalysisThread::Entry()
         if(!MediaFile.IsOk())
 	    return nullptr;
 
-    // Get the file extension...
-    wxString sExtension = MediaFile.GetExt().Lower();
-
     // It is a movie...
-    if(sExtension == wxT("mov")   ||
-       sExtension == wxT("avi")   ||
-       sExtension == wxT("mpg")   ||
-       sExtension == wxT("mpeg"))
+    if(MediaAnalyzer::IsVideo(string(sPath.mb_str())))
         AnalyzeVideo(sPath);
 
     // It is an image...
@@ -64,135 +68,55 @@ void *AnalysisThread::Entry()
 // Analyze single image...
 void AnalysisThread::AnalyzeImage(wxString sPath)
 {
-    // Variables...
-    wxString            sTemp;
-
-    // Reset the tracker, if not already...
-    Frame.Tracker.Reset(0);
+    // Prepare a user interface agnostic analyzer to feed the tracker...
+    MediaAnalyzer Analyzer(Frame.Tracker, this);
 
-    // Load the image...
-    //  2020/06/10 - updating to cv::IMREAD_* constants
-    // and general C++ best practices
-    //pGrayImage = cvLoadImage(sPath.mb_str(), CV_LOAD_IMAGE_GRAYSCALE);
-    //pGrayImage = cvLoadImage(sPath.mb_str(), cv::IMREAD_GRAYSCALE);
-    
-    string sPathStr(sPath.mb_str());
-
-    cv::Mat matImage = cv::imread(sPathStr, cv::IMREAD_GRAYSCALE);
-    IplImage copyImg = cvIplImage(matImage);
-    IplImage *pGrayImage = &copyImg;
-     
-
-        // Failed to load media...
-        if(!pGrayImage)
-        {
-            // Alert...
-            wxLogError(wxT("Unable to load image. It may be in an unrecognized"
-                           " format."));
-            
-            // Abort...
-            return;
-        }
-
-    // Feed into tracker...
-    Frame.Tracker.Advance(*pGrayImage);
-    
-    // Cleanup gray image...
-    cvReleaseImage(&pGrayImage);
+    // Analyze and alert on failure...
+    if(!Analyzer.AnalyzeImage(string(sPath.mb_str())))
+        wxLogError(wxString(Analyzer.GetLastError().c_str(), wxConvUTF8));
 }
 
 // Analyze video...
-//  2020/06/10 - updated to use renamed functions
-// in OpenCV 4
 void AnalysisThread::AnalyzeVideo(wxString sPath)
 {
-    // Variables...
-    IplImage           *pGrayImage              = NULL;
-    wxString            sTemp;
-    cv::VideoCapture	slitherCap;
-
-    // Initialize capture from AVI...
-    //  2020/06/10 - renamed function for OpenCV4
-    pCapture = cvCreateFileCapture(sPath.fn_str());
-
-        // Failed to load media...
-        if(!pCapture)
-        {
-            // Alert...
-            wxLogError(wxT("Your system does not appear to have an suitable"
-                           " codec installed to read this media."));
-            
-            // Abort...
-            return;
-        }
-
-    // Reset the tracker, if not already...
-    //  2020/06/10 - I think the new constant needs to be used
-    Frame.Tracker.Reset((unsigned int) 
-        cvGetCaptureProperty(pCapture, cv::CAP_PROP_FRAME_COUNT));
+    // Prepare a user interface agnostic analyzer to feed the tracker. It will
+    //  check with us periodically whether we have been asked to stop...
+    MediaAnalyzer Analyzer(Frame.Tracker, this);
+    Analyzer.SetFrameQueueDepth(unFrameQueueDepth);
+    Analyzer.SetFrameStride(unFrameStride);
+    Analyzer.SetKeyframesOnly(bKeyframesOnly);
 
     // Start the analysis stop watch...
     StatusUpdateStopWatch.Start();
 
-    // Keep showing media until there is nothing left or cancel requested...
-    while(!TestDestroy())
+    // Analyze and alert on failure...
+    if(!Analyzer.AnalyzeVideo(string(sPath.fn_str())))
     {
-        // Retrieve the captured image...
-        IplImage const *pOriginalImage = cvQueryFrame(pCapture);
-        
-            // There are no more...
-            if(!pOriginalImage)
-                break;
-
-        // The Quicktime backend appears to be buggy in that it keeps cycling
-        //  through the video even after we have all frames. A temporary hack
-        //  is to just break the analysis loop when we have both current frame, 
-        //  total frame, and they are equal...
-        #ifdef __APPLE__
-
-            // Get current position...
-	    //  2020/06/10 - updating to new constants in OpenCV4
-            int const nCurrentFrame = (int) 
-                cvGetCaptureProperty(pCapture, cv::CAP_PROP_POS_FRAMES);
-
-            // Get total number of frames...
-            int const nTotalFrames = (int) 
-                cvGetCaptureProperty(pCapture, CV_CAP_PROP_FRAME_COUNT);
-
-            // Reached the end...
-            if(nCurrentFrame + 1 == nTotalFrames)
-                break;
-
-        #endif
-
-	// 2020/06/10 - converting to C++ API using cv::Mat
-        // The tracker prefers grayscale 8-bit unsigned format, prepare...
-	
-	    cv::Mat pOriginalMatImage = cv::cvarrToMat(pOriginalImage); 
-	    cv::Mat pGrayMatImage(cvGetSize(pOriginalImage), CV_8UC1);
-	    //convert to grayscale
-	    cv::cvtColor(pOriginalMatImage, pGrayMatImage, CV_8UC1);
-            // Allocate blank grayscale image...
-            //pGrayImage = 
-            //    cvCreateImage(cvGetSize(pOriginalImage), IPL_DEPTH_8U, 1);
-
-            // Convert original to grayscale...
-            //cvConvertImage(pOriginalImage, pGrayImage);
-	    
-	      
-	    //replace pGrayImage
-	    IplImage copyGrayImg = cvIplImage(pGrayMatImage);
-	    pGrayImage = &copyGrayImg;
-        
-	// Feed into tracker...
-        Frame.Tracker.Advance(*pGrayImage);
-        
-        // Cleanup gray image...
-        cvReleaseImage(&pGrayImage);
+        wxLogError(wxString(Analyzer.GetLastError().c_str(), wxConvUTF8));
+        return;
     }
 
-    // Release the capture source...
-    cvReleaseCapture(&pCapture);
+    // Summarize how many frames were skipped, if any...
+    DecodeSavings const &Savings = Analyzer.GetDecodeSavings();
+    if(Savings.unFramesGrabbed > 0 || Savings.unFramesUndecoded > 0)
+        sPipelineReport.Printf(
+            wxT("Tracked %u frames, skipped %u without converting and %u"
+                " without decoding... "),
+            Savings.unFramesRetrieved, Savings.unFramesGrabbed,
+            Savings.unFramesUndecoded);
+
+    // Decoder and tracker took turns, so neither stalled...
+    if(Analyzer.GetFrameQueueDepth() == 0 || Analyzer.IsKeyframesOnly())
+        return;
+
+    // Summarize how much each waited on the other. Whichever waited the
+    //  least is the bottleneck...
+    FrameQueueStalls const &Stalls = Analyzer.GetPipelineStalls();
+    sPipelineReport += wxString::Format(
+        wxT("Decoder waited on tracker %u times (%.2f s), tracker waited on"
+            " decoder %u times (%.2f s)..."),
+        Stalls.unProducerStalls, Stalls.dProducerStallSeconds,
+        Stalls.unConsumerStalls, Stalls.dConsumerStallSeconds);
 }
 
 // Analysis thread exitting callback...
@@ -207,6 +131,7 @@ void AnalysisThread::OnExit()
         wxCommandEvent Event(wxEVT_COMMAND_BUTTON_CLICKED, 
                              MainFrame::ID_ANALYSIS_ENDED);
         Event.SetInt(true);
+        Event.SetString(sPipelineReport);
 
         // Send in a thread-safe way...
         wxPostEvent(&Frame, Event);
@@ -67,12 +67,20 @@ class AnalysisThread : public wxThread
         // Multithreading mutex lock...
         wxMutex             Mutex;
 
-        // Pointer to main frame to render on...
-        MainFrame          &Frame;
+        // Number of decoded frames that may wait for the tracker...
+        unsigned int        unFrameQueueDepth;
+
+        // Number of frames to advance by through the video, and whether only
+        //  its keyframes are wanted...
+        unsigned int        unFrameStride;
+        bool                bKeyframesOnly;
 
-        // Capture handle...
-        CvCapture          *pCapture;
+        // How much decoding was skipped and how much the decoder and tracker
+        //  waited on each other, for the user, if a video was analyzed...
+        wxString            sPipelineReport;
 
+        // Pointer to main frame to render on...
+        MainFrame          &Frame;
 };
 
 #endif
@@ -0,0 +1,212 @@
+/*
+  Name:         BackgroundModel.cpp (implementation)
+  Author:       Kip Warner (Kip@TheVertigo.com)
+  Description:  BackgroundModel class. Learns the plate's illumination as a
+                running average of reduced copies of each frame, and flattens
+                frames against it so one threshold suits the whole plate...
+*/
+
+// Includes...
+#include "BackgroundModel.h"
+#include <opencv2/core/hal/intrin.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+
+// Each of these works along a row element by element. Nothing depends on its
+//  neighbour, so they go a whole vector at a time with OpenCV's universal
+//  intrinsics, on whatever instruction set it was built for, and then finish
+//  the row one at a time. Both give exactly the same result...
+
+    // Move each 8.8 fixed point average one 2^n th of the way towards its
+    //  reduced pixel. The rise and the fall are taken apart, each clipped at
+    //  zero, so neither overflows 16 bits...
+    static inline void LearnRow(
+        unsigned char const *pReduced, unsigned short *pAverage,
+        int const nWidth, int const nShift)
+    {
+        // Variables...
+        int nColumn = 0;
+
+        // A vector at a time, while there are enough left...
+        #if CV_SIMD
+        for(; nColumn + CV_SIMD_WIDTH / 2 <= nWidth;
+            nColumn += CV_SIMD_WIDTH / 2)
+        {
+            cv::v_uint16 const Target =
+                cv::vx_load_expand(pReduced + nColumn) << 8;
+            cv::v_uint16 const Average = cv::vx_load(pAverage + nColumn);
+            cv::v_store(pAverage + nColumn,
+                        Average + ((Target - Average) >> nShift) -
+                                  ((Average - Target) >> nShift));
+        }
+        #endif
+
+        // ...then the rest one at a time...
+        for(; nColumn < nWidth; ++nColumn)
+        {
+            int const nTarget   = pReduced[nColumn] << 8;
+            int const nAverage  = pAverage[nColumn];
+            pAverage[nColumn] = (unsigned short) (nTarget > nAverage ?
+                nAverage + ((nTarget - nAverage) >> nShift) :
+                nAverage - ((nAverage - nTarget) >> nShift));
+        }
+    }
+
+    // Round each 8.8 fixed point average to the nearest 8-bit value...
+    static inline void RoundRow(
+        unsigned short const *pAverage, unsigned char *pBackground,
+        int const nWidth)
+    {
+        // Variables...
+        int nColumn = 0;
+
+        // A vector at a time, while there are enough left...
+        #if CV_SIMD
+        for(; nColumn + CV_SIMD_WIDTH <= nWidth; nColumn += CV_SIMD_WIDTH)
+            cv::v_store(pBackground + nColumn,
+                        cv::v_rshr_pack<8>(
+                            cv::vx_load(pAverage + nColumn),
+                            cv::vx_load(pAverage + nColumn +
+                                        CV_SIMD_WIDTH / 2)));
+        #endif
+
+        // ...then the rest one at a time...
+        for(; nColumn < nWidth; ++nColumn)
+            pBackground[nColumn] =
+                (unsigned char) ((pAverage[nColumn] + 0x80) >> 8);
+    }
+
+    // Subtract the background under each pixel and add back the level,
+    //  saturating to 8 bits...
+    static inline void FlattenRow(
+        unsigned char const *pGray, unsigned char const *pBackground,
+        unsigned char *pFlattened, int const nWidth, int const nLevel)
+    {
+        // Variables...
+        int nColumn = 0;
+
+        // A vector at a time, while there are enough left. Widened to signed
+        //  16 bits, where the difference can't overflow...
+        #if CV_SIMD
+        cv::v_int16 const Level = cv::vx_setall_s16((short) nLevel);
+        for(; nColumn + CV_SIMD_WIDTH <= nWidth; nColumn += CV_SIMD_WIDTH)
+        {
+            cv::v_uint16 GrayLow, GrayHigh, BackgroundLow, BackgroundHigh;
+            cv::v_expand(cv::vx_load(pGray + nColumn), GrayLow, GrayHigh);
+            cv::v_expand(cv::vx_load(pBackground + nColumn),
+                         BackgroundLow, BackgroundHigh);
+            cv::v_store(pFlattened + nColumn, cv::v_pack_u(
+                cv::v_reinterpret_as_s16(GrayLow) -
+                    cv::v_reinterpret_as_s16(BackgroundLow) + Level,
+                cv::v_reinterpret_as_s16(GrayHigh) -
+                    cv::v_reinterpret_as_s16(BackgroundHigh) + Level));
+        }
+        #endif
+
+        // ...then the rest one at a time...
+        for(; nColumn < nWidth; ++nColumn)
+            pFlattened[nColumn] = (unsigned char) std::min(std::max(
+                pGray[nColumn] - pBackground[nColumn] + nLevel, 0), 0xff);
+    }
+
+// Default constructor...
+BackgroundModel::BackgroundModel()
+    : unScale(0),
+      unLearningShift(6)
+{
+
+}
+
+// Learn from a new 8-bit grayscale frame, then flatten it into an 8-bit image
+//  of the same size. θ(n) in pixels...
+void BackgroundModel::Flatten(cv::Mat const &GrayImage,
+                              cv::Mat &FlattenedImage)
+{
+    // Frame must be 8-bit, single channel...
+    CV_Assert(GrayImage.type() == CV_8UC1);
+
+    // Nothing to learn, so nothing to flatten...
+    if(!IsEnabled())
+    {
+        GrayImage.copyTo(FlattenedImage);
+        return;
+    }
+
+    // Reduce the frame. Area averaging keeps the worms from speckling the
+    //  background...
+    cv::Size const ReducedSize(
+        (GrayImage.cols + unScale - 1) / unScale,
+        (GrayImage.rows + unScale - 1) / unScale);
+    cv::resize(GrayImage, ReducedImage, ReducedSize, 0, 0, cv::INTER_AREA);
+
+    // The first frame, or the first since the frame size changed, seeds the
+    //  average...
+    if(Average.size() != ReducedSize)
+        ReducedImage.convertTo(Average, CV_16UC1, 256.0);
+
+    // Otherwise learn from it...
+    else
+    {
+        for(int nRow = 0; nRow < ReducedSize.height; ++nRow)
+            LearnRow(ReducedImage.ptr<unsigned char>(nRow),
+                     Average.ptr<unsigned short>(nRow), ReducedSize.width,
+                     unLearningShift);
+    }
+
+    // Round it back to 8-bit...
+    ReducedBackground.create(ReducedSize, CV_8UC1);
+    for(int nRow = 0; nRow < ReducedSize.height; ++nRow)
+        RoundRow(Average.ptr<unsigned short>(nRow),
+                 ReducedBackground.ptr<unsigned char>(nRow),
+                 ReducedSize.width);
+
+    // Its mean is the level an evenly lit plate would be at...
+    int const nLevel = cvRound(cv::mean(ReducedBackground)[0]);
+
+    // Bring it back up to full size, smoothly...
+    cv::resize(ReducedBackground, Background, GrayImage.size(), 0, 0,
+               cv::INTER_LINEAR);
+
+    // Flatten the frame against it...
+    FlattenedImage.create(GrayImage.size(), CV_8UC1);
+    for(int nRow = 0; nRow < GrayImage.rows; ++nRow)
+        FlattenRow(GrayImage.ptr<unsigned char>(nRow),
+                   Background.ptr<unsigned char>(nRow),
+                   FlattenedImage.ptr<unsigned char>(nRow), GrayImage.cols,
+                   nLevel);
+}
+
+// Is the model in use?
+bool BackgroundModel::IsEnabled() const
+{
+    // Disabled at zero scale...
+    return (unScale > 0);
+}
+
+// Forget everything learnt so far...
+void BackgroundModel::Reset()
+{
+    // The next frame seeds the average again...
+    Average.release();
+}
+
+// Set how many times smaller each side of the reduced copy is, or zero to
+//  disable the model, and how quickly it learns...
+void BackgroundModel::SetParameters(
+    unsigned int const _unScale, unsigned int const _unLearningShift)
+{
+    // Learning all of each frame would subtract the worms too, and learning
+    //  less than a 2^16 th of it learns nothing at all in 8.8 fixed point...
+    unsigned int const unShift =
+        std::min(std::max(_unLearningShift, 1u), 15u);
+
+    // Unchanged...
+    if(_unScale == unScale && unShift == unLearningShift)
+        return;
+
+    // Store, and start learning again...
+    unScale         = _unScale;
+    unLearningShift = unShift;
+    Reset();
+}
+
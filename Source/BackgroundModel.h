@@ -0,0 +1,74 @@
+/*
+  Name:         BackgroundModel.h (definition)
+  Author:       Kip Warner (Kip@TheVertigo.com)
+  Description:  BackgroundModel class. Learns the plate's illumination as a
+                running average of reduced copies of each frame, and flattens
+                frames against it so one threshold suits the whole plate...
+*/
+
+// Multiple include protection...
+#ifndef _BACKGROUNDMODEL_H_
+#define _BACKGROUNDMODEL_H_
+
+// Includes...
+
+    // OpenCV...
+    #include <opencv2/core/core.hpp>
+
+// BackgroundModel class...
+class BackgroundModel
+{
+    // Public methods...
+    public:
+
+        // Default constructor...
+        BackgroundModel();
+
+        // Accessors...
+
+            // Is the model in use?
+            bool                IsEnabled() const;
+
+        // Mutators...
+
+            // Learn from a new 8-bit grayscale frame, then flatten it into an
+            //  8-bit image of the same size. Each pixel has the background
+            //  under it subtracted and the mean background added back, so an
+            //  evenly lit plate is left as it was. The background is learnt
+            //  at the reduced resolution, so only the flattening itself costs
+            //  anything per full sized pixel...
+            void                Flatten(cv::Mat const &GrayImage,
+                                        cv::Mat &FlattenedImage);
+
+            // Forget everything learnt so far. The next frame seeds the model
+            //  again...
+            void                Reset();
+
+            // Set how many times smaller each side of the reduced copy is, or
+            //  zero to disable the model, and how quickly it learns. Each
+            //  frame moves the background one 2^n th of the way towards it.
+            //  Either changing forgets what was learnt...
+            void                SetParameters(
+                                    unsigned int const _unScale,
+                                    unsigned int const _unLearningShift);
+
+    // Protected attributes...
+    protected:
+
+        // How many times smaller each side of the reduced copy is, or zero
+        //  when disabled, and how quickly the background is learnt...
+        unsigned int        unScale;
+        unsigned int        unLearningShift;
+
+        // The reduced copy of the current frame, the running average of them
+        //  in 8.8 fixed point, and that rounded back to 8-bit at the reduced
+        //  and then the full resolution. All are allocated on the first frame
+        //  and reused until the frame size changes...
+        cv::Mat             ReducedImage;
+        cv::Mat             Average;
+        cv::Mat             ReducedBackground;
+        cv::Mat             Background;
+};
+
+#endif
+
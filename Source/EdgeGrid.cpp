@@ -0,0 +1,233 @@
+/*
+  Name:         EdgeGrid.cpp (implementation)
+  Author:       Kip Warner (Kip@TheVertigo.com)
+  Description:  EdgeGrid class. A uniform grid over the edges of an outline so
+                that a line segment need only be tested against the edges that
+                lie near it...
+*/
+
+// Includes...
+#include "EdgeGrid.h"
+#include <algorithm>
+#include <cmath>
+
+// Using the SlitherMath namespace...
+using namespace SlitherMath;
+
+// Default constructor...
+EdgeGrid::EdgeGrid()
+    : nOriginX(0),
+      nOriginY(0),
+      nCellSize(1),
+      nColumns(0),
+      nRows(0),
+      unQueryStamp(0)
+{
+
+}
+
+// Index every edge of the given outline, replacing whatever was indexed
+//  before. θ(n)
+void EdgeGrid::Build(Outline const &Contour)
+{
+    // Variables...
+    vector<cv::Point> const    &Vertices    = Contour.Vertices();
+    cv::Rect const             &Bounds      = Contour.BoundingRectangle();
+    unsigned int const          unEdges     = Vertices.size();
+
+    // Size the cells so there are about as many as there are edges. A worm's
+    //  outline is thin, so most cells are empty and those that aren't hold
+    //  only a handful of edges...
+    nCellSize   = std::max(2, (int) ceil(sqrt(
+                    (double) Bounds.area() / std::max(unEdges, 1U))));
+    nOriginX    = Bounds.x;
+    nOriginY    = Bounds.y;
+    nColumns    = Bounds.width / nCellSize + 1;
+    nRows       = Bounds.height / nCellSize + 1;
+
+    // Count the edges overlapping each cell, one over, so that the running
+    //  total below leaves each cell's start in place...
+    unsigned int const unCells = nColumns * nRows;
+    CellStarts.assign(unCells + 1, 0);
+    for(unsigned int unEdge = 0; unEdge < unEdges; ++unEdge)
+    {
+        // Endpoints...
+        cv::Point const &First  = Vertices[unEdge];
+        cv::Point const &Second = Vertices[(unEdge + 1) % unEdges];
+
+        // Every cell the edge's bounding box overlaps...
+        int const nFirstColumn  =
+            (std::min(First.x, Second.x) - nOriginX) / nCellSize;
+        int const nLastColumn   =
+            (std::max(First.x, Second.x) - nOriginX) / nCellSize;
+        int const nFirstRow     =
+            (std::min(First.y, Second.y) - nOriginY) / nCellSize;
+        int const nLastRow      =
+            (std::max(First.y, Second.y) - nOriginY) / nCellSize;
+        for(int nRow = nFirstRow; nRow <= nLastRow; ++nRow)
+            for(int nColumn = nFirstColumn; nColumn <= nLastColumn; ++nColumn)
+              ++CellStarts[nRow * nColumns + nColumn + 1];
+    }
+
+    // Running total gives each cell's start...
+    for(unsigned int unCell = 1; unCell <= unCells; ++unCell)
+        CellStarts[unCell] += CellStarts[unCell - 1];
+
+    // Drop each edge into its cells, using each cell's start as a cursor. This
+    //  leaves each cell's start at the next cell's...
+    CellEdges.resize(CellStarts[unCells]);
+    for(unsigned int unEdge = 0; unEdge < unEdges; ++unEdge)
+    {
+        // Endpoints...
+        cv::Point const &First  = Vertices[unEdge];
+        cv::Point const &Second = Vertices[(unEdge + 1) % unEdges];
+
+        // Every cell the edge's bounding box overlaps...
+        int const nFirstColumn  =
+            (std::min(First.x, Second.x) - nOriginX) / nCellSize;
+        int const nLastColumn   =
+            (std::max(First.x, Second.x) - nOriginX) / nCellSize;
+        int const nFirstRow     =
+            (std::min(First.y, Second.y) - nOriginY) / nCellSize;
+        int const nLastRow      =
+            (std::max(First.y, Second.y) - nOriginY) / nCellSize;
+        for(int nRow = nFirstRow; nRow <= nLastRow; ++nRow)
+            for(int nColumn = nFirstColumn; nColumn <= nLastColumn; ++nColumn)
+                CellEdges[CellStarts[nRow * nColumns + nColumn]++] = unEdge;
+    }
+
+    // ...so shift them all back by one...
+    for(unsigned int unCell = unCells; unCell > 0; --unCell)
+        CellStarts[unCell] = CellStarts[unCell - 1];
+    CellStarts[0] = 0;
+
+    // Forget which queries reported which edges...
+    EdgeStamps.assign(unEdges, 0);
+    unQueryStamp = 0;
+}
+
+// Get the row or column of the cell containing the given coordinate, clamped to
+//  the grid...
+inline int EdgeGrid::ClampCell(
+    double const dCoordinate, int const nOrigin, int const nCells) const
+{
+    // Which cell...
+    int const nCell = (int) floor((dCoordinate - nOrigin) / nCellSize);
+
+    // Clamp...
+    return std::min(std::max(nCell, 0), nCells - 1);
+}
+
+// Collect the index of every edge in a cell that the line segment passes
+//  through, each once and in no particular order...
+void EdgeGrid::Query(LineSegment const &Segment, vector<unsigned int> &Edges)
+{
+    // Constants...
+
+        // Slack, in pixels, so that segments which only graze an edge, or
+        //  which SlitherMath rounds into touching one, still find it...
+        double const dMargin = 1.0;
+
+    // Variables...
+    double const    dStartX = Segment.first.x;
+    double const    dStartY = Segment.first.y;
+    double const    dDeltaX = Segment.second.x - Segment.first.x;
+    double const    dDeltaY = Segment.second.y - Segment.first.y;
+    double const    dRight  = nOriginX + nColumns * nCellSize;
+    double const    dBottom = nOriginY + nRows * nCellSize;
+
+    // Start with nothing...
+    Edges.clear();
+
+    // Nothing indexed...
+    if(CellEdges.empty())
+        return;
+
+    // Segment passes nowhere near the grid...
+    if(std::max(Segment.first.y, Segment.second.y) + dMargin < nOriginY ||
+       std::min(Segment.first.y, Segment.second.y) - dMargin >= dBottom ||
+       std::max(Segment.first.x, Segment.second.x) + dMargin < nOriginX ||
+       std::min(Segment.first.x, Segment.second.x) - dMargin >= dRight)
+        return;
+
+    // New query. If the stamp wraps, forget every edge's...
+    if(++unQueryStamp == 0)
+    {
+        std::fill(EdgeStamps.begin(), EdgeStamps.end(), 0);
+        unQueryStamp = 1;
+    }
+
+    // Visit each row of cells the segment passes through...
+    int const nFirstRow = ClampCell(
+        std::min(Segment.first.y, Segment.second.y) - dMargin, nOriginY, nRows);
+    int const nLastRow = ClampCell(
+        std::max(Segment.first.y, Segment.second.y) + dMargin, nOriginY, nRows);
+    for(int nRow = nFirstRow; nRow <= nLastRow; ++nRow)
+    {
+        // Variables...
+        double  dRowLeft    = 0.0;
+        double  dRowRight   = 0.0;
+
+        // Find the horizontal extent of the segment within this row...
+
+            // Horizontal segment spans the same columns in every row...
+            if(fabs(dDeltaY) < 1e-9)
+            {
+                dRowLeft    = std::min(Segment.first.x, Segment.second.x);
+                dRowRight   = std::max(Segment.first.x, Segment.second.x);
+            }
+
+            // Otherwise clip it to the row's top and bottom...
+            else
+            {
+                // Where does the segment enter and leave this row?
+                double const dRowTop    = nOriginY + nRow * nCellSize - dMargin;
+                double const dRowBottom = dRowTop + nCellSize + 2.0 * dMargin;
+                double dEnter   = (dRowTop - dStartY) / dDeltaY;
+                double dLeave   = (dRowBottom - dStartY) / dDeltaY;
+                if(dEnter > dLeave)
+                    std::swap(dEnter, dLeave);
+
+                // Only the part between its endpoints...
+                dEnter  = std::max(dEnter, 0.0);
+                dLeave  = std::min(dLeave, 1.0);
+                if(dEnter > dLeave)
+                    continue;
+
+                // Horizontal extent...
+                dRowLeft    = std::min(dStartX + dEnter * dDeltaX,
+                                       dStartX + dLeave * dDeltaX);
+                dRowRight   = std::max(dStartX + dEnter * dDeltaX,
+                                       dStartX + dLeave * dDeltaX);
+            }
+
+            // Misses the grid in this row...
+            if(dRowRight + dMargin < nOriginX || dRowLeft - dMargin >= dRight)
+                continue;
+
+        // Report every edge in every cell of this row the segment touches...
+        int const nFirstColumn  =
+            ClampCell(dRowLeft - dMargin, nOriginX, nColumns);
+        int const nLastColumn   =
+            ClampCell(dRowRight + dMargin, nOriginX, nColumns);
+        for(int nColumn = nFirstColumn; nColumn <= nLastColumn; ++nColumn)
+        {
+            // Cell's edges...
+            unsigned int const unCell = nRow * nColumns + nColumn;
+            for(unsigned int unIndex = CellStarts[unCell];
+                unIndex < CellStarts[unCell + 1];
+              ++unIndex)
+            {
+                // Already reported by another cell...
+                unsigned int const unEdge = CellEdges[unIndex];
+                if(EdgeStamps[unEdge] == unQueryStamp)
+                    continue;
+
+                // Report it...
+                EdgeStamps[unEdge] = unQueryStamp;
+                Edges.push_back(unEdge);
+            }
+        }
+    }
+}
+
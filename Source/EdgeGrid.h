@@ -0,0 +1,82 @@
+/*
+  Name:         EdgeGrid.h (definition)
+  Author:       Kip Warner (Kip@TheVertigo.com)
+  Description:  EdgeGrid class. A uniform grid over the edges of an outline so
+                that a line segment need only be tested against the edges that
+                lie near it...
+*/
+
+// Multiple include protection...
+#ifndef _EDGEGRID_H_
+#define _EDGEGRID_H_
+
+// Includes...
+
+    // Contiguous contours...
+    #include "Outline.h"
+
+    // SlitherMath...
+    #include "SlitherMath.h"
+
+    // Standard libraries and STL...
+    #include <vector>
+
+    // Using the standard namespace...
+    using namespace std;
+
+// EdgeGrid class...
+class EdgeGrid
+{
+    // Public methods...
+    public:
+
+        // Default constructor...
+        EdgeGrid();
+
+        // Mutators...
+
+            // Index every edge of the given outline, replacing whatever was
+            //  indexed before. Edge i joins vertex i to vertex i + 1, with the
+            //  last wrapping around to the first. θ(n)
+            void                Build(Outline const &Contour);
+
+            // Collect the index of every edge in a cell that the line segment
+            //  passes through, each once and in no particular order. This is a
+            //  superset of the edges the segment intersects...
+            void                Query(SlitherMath::LineSegment const &Segment,
+                                      vector<unsigned int> &Edges);
+
+    // Protected methods...
+    protected:
+
+        // Get the row or column of the cell containing the given coordinate,
+        //  clamped to the grid...
+        int                     ClampCell(double const dCoordinate,
+                                          int const nOrigin,
+                                          int const nCells) const;
+
+    // Protected attributes...
+    protected:
+
+        // Top left corner of the grid, the side length of each square cell,
+        //  and the number of cells across and down, all in pixels...
+        int                     nOriginX;
+        int                     nOriginY;
+        int                     nCellSize;
+        int                     nColumns;
+        int                     nRows;
+
+        // Edges in each cell, packed row major. The edges of cell i are in
+        //  CellEdges from CellStarts[i] up to CellStarts[i + 1]. All of these
+        //  only ever grow, so rebuilding for every frame doesn't allocate...
+        vector<unsigned int>    CellStarts;
+        vector<unsigned int>    CellEdges;
+
+        // The query each edge was last reported for, so that an edge spanning
+        //  several cells is reported only once...
+        vector<unsigned int>    EdgeStamps;
+        unsigned int            unQueryStamp;
+};
+
+#endif
+
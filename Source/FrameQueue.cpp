@@ -0,0 +1,158 @@
+/*
+  Name:         FrameQueue.cpp (implementation)
+  Author:       Kip Warner (Kip@TheVertigo.com)
+  Description:  FrameQueue class. A bounded single producer, single consumer
+                queue of preallocated frames between two threads...
+*/
+
+// Includes...
+#include "FrameQueue.h"
+#include <algorithm>
+#include <cassert>
+
+// Constructor takes the number of frames that may be in flight...
+FrameQueue::FrameQueue(unsigned int const unDepth)
+    : SlotFilled(ResourcesMutex),
+      SlotEmptied(ResourcesMutex),
+      Slots(std::max(unDepth, 1U)),
+      unHead(0),
+      unTail(0),
+      unFilled(0),
+      bClosed(false),
+      bAborted(false)
+{
+
+}
+
+// Stop the producer as soon as possible...
+void FrameQueue::Abort()
+{
+    // Lock resources...
+    wxMutexLocker Lock(ResourcesMutex);
+
+    // Flag and wake the producer if it is waiting on us...
+    bAborted = true;
+    SlotEmptied.Broadcast();
+}
+
+// Wait for a filled slot and return it, or NULL if the producer has closed
+//  the queue and it is now empty...
+cv::Mat *FrameQueue::BeginPop()
+{
+    // Lock resources...
+    wxMutexLocker Lock(ResourcesMutex);
+
+    // Nothing ready, so we are waiting on the producer...
+    if(unFilled == 0 && !bClosed)
+    {
+        // Start timing the stall...
+        int64 const nStart = cv::getTickCount();
+
+        // Wait...
+        while(unFilled == 0 && !bClosed)
+            SlotFilled.Wait();
+
+        // Remember it...
+      ++Stalls.unConsumerStalls;
+        Stalls.dConsumerStallSeconds +=
+            (cv::getTickCount() - nStart) / cv::getTickFrequency();
+    }
+
+    // Closed and drained...
+    if(unFilled == 0)
+        return NULL;
+
+    // The oldest filled slot belongs to the consumer until EndPop()...
+    return &Slots[unHead];
+}
+
+// Wait for an empty slot and return it for filling, or NULL if the consumer
+//  has aborted...
+cv::Mat *FrameQueue::BeginPush()
+{
+    // Lock resources...
+    wxMutexLocker Lock(ResourcesMutex);
+
+    // Everything is full, so we are waiting on the consumer...
+    if(unFilled == Slots.size() && !bAborted)
+    {
+        // Start timing the stall...
+        int64 const nStart = cv::getTickCount();
+
+        // Wait...
+        while(unFilled == Slots.size() && !bAborted)
+            SlotEmptied.Wait();
+
+        // Remember it...
+      ++Stalls.unProducerStalls;
+        Stalls.dProducerStallSeconds +=
+            (cv::getTickCount() - nStart) / cv::getTickFrequency();
+    }
+
+    // Consumer doesn't want any more...
+    if(bAborted)
+        return NULL;
+
+    // The next empty slot belongs to the producer until EndPush()...
+    return &Slots[unTail];
+}
+
+// There will be no more frames...
+void FrameQueue::Close()
+{
+    // Lock resources...
+    wxMutexLocker Lock(ResourcesMutex);
+
+    // Flag and wake the consumer if it is waiting on us...
+    bClosed = true;
+    SlotFilled.Broadcast();
+}
+
+// The slot from BeginPop() is no longer needed...
+void FrameQueue::EndPop()
+{
+    // Lock resources...
+    wxMutexLocker Lock(ResourcesMutex);
+
+    // Hand the slot back to the producer...
+    assert(unFilled > 0);
+    unHead = (unHead + 1) % Slots.size();
+  --unFilled;
+
+    // Wake the producer if it is waiting on us...
+    SlotEmptied.Signal();
+}
+
+// The slot from BeginPush() has been filled...
+void FrameQueue::EndPush()
+{
+    // Lock resources...
+    wxMutexLocker Lock(ResourcesMutex);
+
+    // Hand the slot over to the consumer...
+    assert(unFilled < Slots.size());
+    unTail = (unTail + 1) % Slots.size();
+  ++unFilled;
+  ++Stalls.unFrames;
+
+    // Wake the consumer if it is waiting on us...
+    SlotFilled.Signal();
+}
+
+// Number of frames that may be in flight...
+unsigned int FrameQueue::GetDepth() const
+{
+    // Fixed at construction, no need to lock...
+    return Slots.size();
+}
+
+// How much either side has had to wait on the other so far...
+FrameQueueStalls FrameQueue::GetStalls() const
+{
+    // Lock resources...
+    wxMutexLocker Lock(ResourcesMutex);
+
+    // Return a copy...
+    return Stalls;
+}
+
@@ -0,0 +1,120 @@
+/*
+  Name:         FrameQueue.h (definition)
+  Author:       Kip Warner (Kip@TheVertigo.com)
+  Description:  FrameQueue class. A bounded single producer, single consumer
+                queue of preallocated frames between two threads...
+*/
+
+// Multiple include protection...
+#ifndef _FRAMEQUEUE_H_
+#define _FRAMEQUEUE_H_
+
+// Includes...
+
+    // OpenCV...
+    #include <opencv2/core/core.hpp>
+
+    // wxWidgets threading...
+    #include <wx/thread.h>
+
+    // Standard libraries and STL...
+    #include <vector>
+
+    // Using the standard namespace...
+    using namespace std;
+
+// How often and for how long either side of the queue had to wait on the
+//  other. Whichever side waited the most is not the bottleneck...
+typedef struct FrameQueueStalls
+{
+    // Inline constructor initializer...
+    FrameQueueStalls()
+        : unFrames(0),
+          unProducerStalls(0),
+          dProducerStallSeconds(0.0),
+          unConsumerStalls(0),
+          dConsumerStallSeconds(0.0)
+    {
+    }
+
+    // Number of frames that passed through the queue...
+    unsigned int    unFrames;
+
+    // Times the producer found the queue full and how long it waited...
+    unsigned int    unProducerStalls;
+    double          dProducerStallSeconds;
+
+    // Times the consumer found the queue empty and how long it waited...
+    unsigned int    unConsumerStalls;
+    double          dConsumerStallSeconds;
+
+}FrameQueueStalls;
+
+// FrameQueue class...
+class FrameQueue
+{
+    // Public methods...
+    public:
+
+        // Constructor takes the number of frames that may be in flight...
+        FrameQueue(unsigned int const unDepth);
+
+        // Accessors...
+
+            // Number of frames that may be in flight...
+            unsigned int        GetDepth() const;
+
+            // How much either side has had to wait on the other so far...
+            FrameQueueStalls    GetStalls() const;
+
+        // Producer side...
+
+            // Wait for an empty slot and return it for filling, or NULL if
+            //  the consumer has aborted...
+            cv::Mat            *BeginPush();
+
+            // The slot from BeginPush() has been filled...
+            void                EndPush();
+
+            // There will be no more frames...
+            void                Close();
+
+        // Consumer side...
+
+            // Wait for a filled slot and return it, or NULL if the producer
+            //  has closed the queue and it is now empty...
+            cv::Mat            *BeginPop();
+
+            // The slot from BeginPop() is no longer needed...
+            void                EndPop();
+
+            // Stop the producer as soon as possible...
+            void                Abort();
+
+    // Protected attributes...
+    protected:
+
+        // Resources mutex and the conditions signalled whenever a slot is
+        //  filled or emptied...
+        mutable wxMutex     ResourcesMutex;
+        wxCondition         SlotFilled;
+        wxCondition         SlotEmptied;
+
+        // Preallocated frames, reused in a ring...
+        vector<cv::Mat>     Slots;
+
+        // Next slot to pop, next slot to push, and how many are filled...
+        unsigned int        unHead;
+        unsigned int        unTail;
+        unsigned int        unFilled;
+
+        // Producer has closed, or consumer has aborted...
+        bool                bClosed;
+        bool                bAborted;
+
+        // Stall statistics...
+        FrameQueueStalls    Stalls;
+};
+
+#endif
+
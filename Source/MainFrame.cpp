@@ -39,6 +39,7 @@ BEGIN_EVENT_TABLE(MainFrame, MainFrame_Base)
     
     // Media grid popup menu events...
     EVT_MENU                (ID_ANALYZE, MainFrame::OnAnalyze)
+    EVT_MENU                (ID_ANALYZE_ALL, MainFrame::OnAnalyzeAll)
     EVT_MENU                (ID_PLAY, MainFrame::OnPlay)
     EVT_MENU                (ID_REMOVE, MainFrame::OnRemove)
     EVT_MENU                (ID_RENAME, MainFrame::OnRename)    
@@ -71,7 +72,8 @@ MainFrame::MainFrame(wxWindow *Parent)
       pMediaPlayer(NULL),
       CaptureTimer(this, TIMER_CAPTURE),
       pAnalysisThread(NULL),
-      AnalysisTimer(this, TIMER_ANALYSIS)
+      AnalysisTimer(this, TIMER_ANALYSIS),
+      pAnalysisScheduler(NULL)
 {
     // Set the title...
     SetTitle(wxT("Slither"));
@@ -295,6 +297,117 @@ MainFrame::MainFrame(wxWindow *Parent)
     pExperiment = new Experiment(this);
 }
 
+// Append a row of body size results to the analysis grid. False if out of
+//  memory...
+bool MainFrame::AppendBodySizeResult(wxString const &sLabel,
+                                     WormMeasurement const &Measurement)
+{
+    // Append a new row for this worm and check if ok...
+    if(!AnalysisGrid->AppendRows())
+    {
+        // Alert user...
+        wxLogError(wxT("Out of memory! Check your field of view diameter."));
+        
+        // Abort...
+        return false;
+    }
+    
+    // Get the index of the new row...
+    int const nNewRow = AnalysisGrid->GetNumberRows() - 1;
+
+    // Set row label...
+    AnalysisGrid->SetRowLabelValue(nNewRow, sLabel);
+        
+    // Length...
+    AnalysisGrid->SetCellValue(nNewRow, ANALYSIS_BODY_SIZE_COLUMN_LENGTH,
+        wxString::Format(wxT("%.3f mm"), Measurement.dLength));
+
+    // Width...
+    AnalysisGrid->SetCellValue(nNewRow, ANALYSIS_BODY_SIZE_COLUMN_WIDTH,
+        wxString::Format(wxT("%.3f mm"), Measurement.dWidth));
+            
+    // Area...
+    AnalysisGrid->SetCellValue(nNewRow, ANALYSIS_BODY_SIZE_COLUMN_AREA,
+        wxString::Format(wxT("%.3f mm²"), Measurement.dArea));
+
+    // Done...
+    return true;
+}
+
+// Merge whatever results the analysis scheduler has ready into the analysis
+//  grid, and end the analysis once every media is done...
+void MainFrame::CollectScheduledAnalysisResults()
+{
+    // Variables...
+    MediaAnalysisResult Result;
+    wxString            sTemp;
+
+    // Merge each finished media...
+    while(pAnalysisScheduler->GetNextResult(Result))
+    {
+        // Get just the name of the media...
+        wxString const sMediaName = wxFileName(
+            wxString(Result.sPath.c_str(), wxConvFile)).GetFullName();
+
+        // Failed, alert user and move on...
+        if(!Result.bSucceeded)
+        {
+            // Format...
+            sTemp = sMediaName + wxT(": ") + 
+                    wxString(Result.sError.c_str(), wxConvUTF8);
+
+            // Append to analysis status list...
+            AnalysisStatusList->Append(sTemp);
+            continue;
+        }
+
+        // Append a row for each worm, labelled by the media it came from...
+        for(unsigned int unWormIndex = 0; 
+            unWormIndex < Result.Measurements.size(); 
+            unWormIndex++)
+        {
+            // Prepare label...
+            sTemp.Printf(wxT(" worm %d"), unWormIndex + 1);
+
+            // Append and check if ok...
+            if(!AppendBodySizeResult(sMediaName + sTemp, 
+                                     Result.Measurements.at(unWormIndex)))
+                break;
+        }
+
+        // Alert user...
+        sTemp.Printf(wxT(": found %d worms..."), 
+                     (int) Result.Measurements.size());
+        AnalysisStatusList->Append(sMediaName + sTemp);
+    }
+
+    // Update progress...
+    unsigned int const unCompleted  = pAnalysisScheduler->GetCompletedMedia();
+    unsigned int const unTotal      = pAnalysisScheduler->GetTotalMedia();
+    sTemp.Printf(wxT("%d / %d"), unCompleted, unTotal);
+    AnalysisCurrentFrameStatus->ChangeValue(sTemp);
+    if(unTotal > 0)
+        AnalysisGauge->SetValue((int)(((float) unCompleted / unTotal) * 100.0));
+
+    // Still working...
+    if(!pAnalysisScheduler->IsFinished())
+        return;
+
+    // Every worker is done, so stop the timer and cleanup...
+    AnalysisTimer.Stop();
+    delete pAnalysisScheduler;
+    pAnalysisScheduler = NULL;
+
+    // Unlock the UI...
+    UnlockAnalysisUserInterface();
+
+    // Automatically resize all columns and rows to fit contents...
+    AnalysisGrid->AutoSize();
+    
+    // Trigger analysis results sizer to recalculate layout...
+    AnalysisGrid->GetContainingSizer()->Layout();
+}
+
 // Compare two integers. Used for sorting rows in the media grid...
 int wxCMPFUNC_CONV MainFrame::CompareIntegers(int *pnFirst, int *pnSecond)
 {
@@ -302,6 +415,53 @@ int wxCMPFUNC_CONV MainFrame::CompareIntegers(int *pnFirst, int *pnSecond)
     return *pnFirst - *pnSecond;
 }
 
+// Lock the user interface while an analysis is running...
+void MainFrame::LockAnalysisUserInterface()
+{
+    // Variables...
+    wxString    sTemp;
+
+    // Begin analysis button...
+    BeginAnalysisButton->Disable();
+
+    // Cancel analysis button...
+    CancelAnalysisButton->Enable();
+
+    // Microscope set...
+    ChosenMicroscopeName->Disable();
+    ChosenMicroscopeTotalZoom->Disable();
+    FieldOfViewDiameter->Disable();
+
+    // Analysis type...
+    ChosenAnalysisType->Disable();
+
+    // Analysis gauge...
+    AnalysisGauge->SetRange(100);
+    AnalysisGauge->SetValue(0);
+
+    // Clear the status list...
+    AnalysisStatusList->Clear();
+
+    // Analysis grid...
+    AnalysisGrid->Disable();
+
+    // Artificial intelligence settings...
+    AISettingsScrolledWindow->Disable();
+
+    // Alert user...
+    sTemp = ChosenAnalysisType->GetString(
+                ChosenAnalysisType->GetCurrentSelection()) + 
+            wxT(" analysis is running...");
+    AnalysisStatusList->Append(sTemp);
+
+    // Show some information about the AI settings we are using...
+    if(InletDetectionCheckBox->IsChecked())
+        AnalysisStatusList->Append(wxT("Inlet detection enabled..."));
+
+    // Refresh the main frame...
+    Refresh();
+}
+
 // Media grid popup menu events for analyze...
 void MainFrame::OnAnalyze(wxCommandEvent &Event)
 {
@@ -320,6 +480,92 @@ void MainFrame::OnAnalyze(wxCommandEvent &Event)
         MainNotebook->ChangeSelection(ANALYSIS_PANE);
 }
 
+// Media grid popup menu events for analyze all...
+void MainFrame::OnAnalyzeAll(wxCommandEvent &Event)
+{
+    // Variables...
+    wxString    sTemp;
+
+    // Analysis already running, abort...
+    if(AnalysisTimer.IsRunning())
+        return;
+
+    // Nothing to analyze...
+    if(!IsExperimentLoaded() || MediaGrid->GetNumberRows() == 0)
+    {
+        // Alert user...
+        wxMessageBox(wxT("There is no media in this experiment to analyze."));
+
+        // Done...
+        return;
+    }
+
+    // Load the artificial intelligence settings. Every worker's tracker will
+    //  copy them from ours...
+    Tracker.SetArtificialIntelligenceMagic(
+        ThresholdSpinner->GetValue(),
+        MaxThresholdValueSpinner->GetValue(),
+        MinimumCandidateSizeSpinner->GetValue(),
+        MaximumCandidateSizeSpinner->GetValue(),
+        InletDetectionCheckBox->IsChecked(),
+        InletCorrectionSpinner->GetValue());
+
+    // Create the scheduler and queue every media in the experiment...
+    pAnalysisScheduler = new AnalysisScheduler(Tracker);
+    pAnalysisScheduler->SetFrameQueueDepth(
+        ::wxGetApp().pConfiguration->Read(wxT("/Analysis/FrameQueueDepth"),
+            (long) MediaAnalyzer::DEFAULT_FRAME_QUEUE_DEPTH));
+    pAnalysisScheduler->SetFrameStride(
+        ::wxGetApp().pConfiguration->Read(wxT("/Analysis/FrameStride"), 1L));
+    pAnalysisScheduler->SetKeyframesOnly(
+        ::wxGetApp().pConfiguration->Read(wxT("/Analysis/KeyframesOnly"),
+            false));
+    pAnalysisScheduler->SetSegments(
+        ::wxGetApp().pConfiguration->Read(wxT("/Analysis/Segments"), 0L));
+    for(int nRow = 0; nRow < MediaGrid->GetNumberRows(); ++nRow)
+    {
+        // Generate complete path...
+        wxString const sPath = pExperiment->GetCachePath() + wxT("/media/") +
+                               MediaGrid->GetCellValue(nRow, TITLE);
+
+        // Queue...
+        pAnalysisScheduler->Add(string(sPath.fn_str()));
+    }
+
+    // Switch to analysis...
+    MainNotebook->ChangeSelection(ANALYSIS_PANE);
+
+    // Lock the UI...
+    LockAnalysisUserInterface();
+
+    // Remove all rows, if any and if the user doesn't want to accumulate
+    //  results...
+    if(AnalysisGrid->GetNumberRows() > 0 && !AccumulateCheckBox->IsChecked())
+        AnalysisGrid->DeleteRows(0, AnalysisGrid->GetNumberRows());
+
+    // Start the workers, one per processor, and check for error...
+    unsigned int const unWorkers = pAnalysisScheduler->Start();
+    if(unWorkers == 0)
+    {
+        // Alert...
+        wxLogError(wxT("Unable to start any analysis workers..."));
+
+        // Cleanup and abort...
+        delete pAnalysisScheduler;
+        pAnalysisScheduler = NULL;
+        UnlockAnalysisUserInterface();
+        return;
+    }
+
+    // Alert user...
+    sTemp.Printf(wxT("Analyzing %d media using %d threads..."),
+                 MediaGrid->GetNumberRows(), unWorkers);
+    AnalysisStatusList->Append(sTemp);
+
+    // Initiate the analysis timer to collect results as they come in...
+    AnalysisTimer.Start(100, wxTIMER_CONTINUOUS);
+}
+
 // User right clicked on analysis grid cell...
 void MainFrame::OnAnalysisCellRightClick(wxGridEvent &Event)
 {
@@ -398,6 +644,14 @@ void MainFrame::OnAnalysisFrameReadyTimer(wxTimerEvent &Event)
     // Variables...
     wxString sTemp;
 
+    // Analyzing all media at once, there's no single tracker to show...
+    if(pAnalysisScheduler)
+    {
+        // Just collect whatever has finished...
+        CollectScheduledAnalysisResults();
+        return;
+    }
+
     // Get the thinking image...
     IplImage *pThinkingImage = Tracker.GetThinkingImage();
     
@@ -523,9 +777,6 @@ void MainFrame::OnAnalysisSaveToDisk(wxCommandEvent &Event)
 // Begin analysis button hit...
 void MainFrame::OnBeginAnalysis(wxCommandEvent &Event)
 {
-    // Variables...
-    wxString    sTemp;
-
     // Analysis already running, abort...
     if(AnalysisTimer.IsRunning())
         return;
@@ -555,53 +806,10 @@ void MainFrame::OnBeginAnalysis(wxCommandEvent &Event)
         InletCorrectionSpinner->GetValue());
 
     // Lock the UI...
+    LockAnalysisUserInterface();
 
-        // Begin analysis button...
-        BeginAnalysisButton->Disable();
-
-        // Cancel analysis button...
-        CancelAnalysisButton->Enable();
-
-        // Microscope set...
-        ChosenMicroscopeName->Disable();
-        ChosenMicroscopeTotalZoom->Disable();
-        FieldOfViewDiameter->Disable();
-
-        // Analysis type...
-        ChosenAnalysisType->Disable();
-
-        // Analysis buttons...
-        BeginAnalysisButton->Disable();
-        CancelAnalysisButton->Enable();
-
-        // Analysis gauge...
-        AnalysisGauge->SetRange(100);
-        AnalysisGauge->SetValue(0);
-
-        // Clear the status list...
-        AnalysisStatusList->Clear();
-
-        // Analysis grid...
-        AnalysisGrid->Disable();
-
-        // Artificial intelligence settings...
-        AISettingsScrolledWindow->Disable();
-
-        // Alert user...
-        sTemp = ChosenAnalysisType->GetString(
-                    ChosenAnalysisType->GetCurrentSelection()) + 
-                wxT(" analysis is running...");
-        AnalysisStatusList->Append(sTemp);
-
-        // Show some information about the AI settings we are using...
-        if(InletDetectionCheckBox->IsChecked())
-            AnalysisStatusList->Append(wxT("Inlet detection enabled..."));
-
-        // Refresh the main frame...
-        Refresh();
-        
-        // Show the image analysis window...
-        pImageAnalysisWindow->Show();
+    // Show the image analysis window...
+    pImageAnalysisWindow->Show();
 
     // Create the analysis thread and check for error...
     pAnalysisThread = new AnalysisThread(*this);
@@ -635,8 +843,14 @@ void MainFrame::OnCancelAnalysis(wxCommandEvent &Event)
     if(!AnalysisTimer.IsRunning())
         return;
 
+    // Analyzing all media, stop every worker. The timer will collect whatever
+    //  finished before the cancel and then end the analysis...
+    if(pAnalysisScheduler)
+        pAnalysisScheduler->Cancel();
+
     // Delete the thread...
-    pAnalysisThread->Delete();
+    else
+        pAnalysisThread->Delete();
 }
 
 // An analysis type was chosen...
@@ -1044,47 +1258,13 @@ void MainFrame::OnEndAnalysis(wxCommandEvent &Event)
         cvReleaseImage(&pThinkingImage);
     }
 
-    // Unlock the UI...
-
-        // Begin analysis button...
-        BeginAnalysisButton->Enable();
-
-        // Cancel analysis button...
-        CancelAnalysisButton->Disable();
-
-        // Microscope set...
-        ChosenMicroscopeName->Enable();
-        ChosenMicroscopeTotalZoom->Enable();
-        FieldOfViewDiameter->Enable();
-
-        // Analysis type...
-        ChosenAnalysisType->Enable();
-
-        // Analysis status...
-        AnalysisCurrentFrameStatus->ChangeValue(wxT(""));
-        AnalysisRateStatus->ChangeValue(wxT(""));
-        AnalysisWormsTrackingStatus->ChangeValue(wxT(""));
-
-        // Analysis buttons...
-        BeginAnalysisButton->Enable();
-        CancelAnalysisButton->Disable();
-
-        // Analysis gauge...
-        AnalysisGauge->SetRange(100);
-        AnalysisGauge->SetValue(0);
+    // Show how the decoder and tracker kept up with each other, if known...
+    if(!Event.GetString().IsEmpty())
+        AnalysisStatusList->Append(Event.GetString());
 
-        // Analysis grid...
-        AnalysisGrid->Enable();
-
-        // Artificial intelligence settings...
-        AISettingsScrolledWindow->Enable();
-
-        // Alert user...
-        AnalysisStatusList->Append(wxT("Analysis ended..."));
+    // Unlock the UI...
+    UnlockAnalysisUserInterface();
 
-        // Refresh the main frame...
-        Refresh();
-                    
     // Remove all rows, if any and if the user doesn't want to accumulate
     //  results...
     if(AnalysisGrid->GetNumberRows() > 0 && !AccumulateCheckBox->IsChecked())
@@ -1093,46 +1273,21 @@ void MainFrame::OnEndAnalysis(wxCommandEvent &Event)
     // Body size analysis...
     if(ChosenAnalysisType->GetCurrentSelection() == ANALYSIS_BODY_SIZE)
     {
+        // Convert each worm's metrics into real units...
+        vector<WormMeasurement> Measurements;
+        MediaAnalyzer::CollectMeasurements(Tracker, Measurements);
+
         // Output analysis results for each worm...
-        for(unsigned int unWormIndex = 0; unWormIndex < Tracker.Tracking();
+        for(unsigned int unWormIndex = 0; unWormIndex < Measurements.size();
             unWormIndex++)
         {
+            // Label it by its row, in case we are accumulating...
+            wxString const sLabel = wxString::Format(wxT("Worm %d"), 
+                AnalysisGrid->GetNumberRows() + 1);
+
             // Append a new row for this worm and check if ok...
-            if(!AnalysisGrid->AppendRows())
-            {
-                // Alert user...
-                wxLogError(wxT("Out of memory! Check your field of view"
-                               " diameter."));
-                
-                // Abort...
+            if(!AppendBodySizeResult(sLabel, Measurements.at(unWormIndex)))
                 break;
-            }
-            
-            // Get the index of the new row...
-            int const nNewRow = AnalysisGrid->GetNumberRows() - 1;
-
-            // Get the worm at this index...
-            Worm const &CurrentWorm = Tracker.GetWorm(unWormIndex);
-
-            // Set row label...
-            AnalysisGrid->SetRowLabelValue(nNewRow, 
-                wxString::Format(wxT("Worm %d"), nNewRow + 1));
-                
-            // Length...
-            AnalysisGrid->SetCellValue(nNewRow, ANALYSIS_BODY_SIZE_COLUMN_LENGTH,
-                wxString::Format(wxT("%.3f mm"), 
-                    Tracker.ConvertPixelsToMillimeters(CurrentWorm.Length())));
-
-            // Width...
-            AnalysisGrid->SetCellValue(nNewRow, ANALYSIS_BODY_SIZE_COLUMN_WIDTH,
-                wxString::Format(wxT("%.3f mm"), 
-                    Tracker.ConvertPixelsToMillimeters(CurrentWorm.Width())));
-                    
-            // Area...
-            AnalysisGrid->SetCellValue(nNewRow, ANALYSIS_BODY_SIZE_COLUMN_AREA,
-                wxString::Format(wxT("%.3f mm²"), 
-                    Tracker.ConvertSquarePixelsToSquareMillimeters(
-                        CurrentWorm.Area())));
         }
     }
     
@@ -1989,6 +2144,12 @@ void MainFrame::OnMediaCellRightClick(wxGridEvent &Event)
                                                   wxT("&Analyze"));
         pAnalyzeItem->SetBitmap(analyze_32x32_xpm);
         Menu.Append(pAnalyzeItem);
+
+        // Analyze all...
+        wxMenuItem *pAnalyzeAllItem = new wxMenuItem(&Menu, ID_ANALYZE_ALL, 
+                                                     wxT("Analyze A&ll"));
+        pAnalyzeAllItem->SetBitmap(analyze_32x32_xpm);
+        Menu.Append(pAnalyzeAllItem);
         
         // Play...
         wxMenuItem *pPlayItem = new wxMenuItem(&Menu, ID_PLAY, wxT("&Play"));
@@ -2026,7 +2187,9 @@ void MainFrame::OnQuit(wxCommandEvent &Event)
     // Make sure capture and analysis threads exit cleanly first...
     /*if(CaptureTimer.IsRunning())
         pCaptureThread->Delete();*/
-    if(AnalysisTimer.IsRunning())
+    if(pAnalysisScheduler)
+        pAnalysisScheduler->Cancel();
+    else if(AnalysisTimer.IsRunning())
         pAnalysisThread->Delete();
 
     // Close experiment first...
@@ -2062,7 +2225,14 @@ void MainFrame::OnSystemClose(wxCloseEvent &Event)
     // Make sure capture and analysis threads exit cleanly first...
     /*if(CaptureTimer.IsRunning())
         pCaptureThread->Delete();*/
-    if(AnalysisTimer.IsRunning())
+    if(pAnalysisScheduler)
+    {
+        // Stop collecting and stop every worker...
+        AnalysisTimer.Stop();
+        delete pAnalysisScheduler;
+        pAnalysisScheduler = NULL;
+    }
+    else if(AnalysisTimer.IsRunning())
         pAnalysisThread->Delete();
 
     // An experiment needs to be saved...
@@ -2088,6 +2258,45 @@ void MainFrame::OnSystemClose(wxCloseEvent &Event)
     Destroy();
 }
 
+// Unlock the user interface after an analysis has ended...
+void MainFrame::UnlockAnalysisUserInterface()
+{
+    // Begin analysis button...
+    BeginAnalysisButton->Enable();
+
+    // Cancel analysis button...
+    CancelAnalysisButton->Disable();
+
+    // Microscope set...
+    ChosenMicroscopeName->Enable();
+    ChosenMicroscopeTotalZoom->Enable();
+    FieldOfViewDiameter->Enable();
+
+    // Analysis type...
+    ChosenAnalysisType->Enable();
+
+    // Analysis status...
+    AnalysisCurrentFrameStatus->ChangeValue(wxT(""));
+    AnalysisRateStatus->ChangeValue(wxT(""));
+    AnalysisWormsTrackingStatus->ChangeValue(wxT(""));
+
+    // Analysis gauge...
+    AnalysisGauge->SetRange(100);
+    AnalysisGauge->SetValue(0);
+
+    // Analysis grid...
+    AnalysisGrid->Enable();
+
+    // Artificial intelligence settings...
+    AISettingsScrolledWindow->Enable();
+
+    // Alert user...
+    AnalysisStatusList->Append(wxT("Analysis ended..."));
+
+    // Refresh the main frame...
+    Refresh();
+}
+
 // Show the tip window...
 void MainFrame::ShowTip()
 {
@@ -18,6 +18,9 @@
     
     // Analysis thread...
     #include "AnalysisThread.h"
+
+    // Analysis of many media at once...
+    #include "AnalysisScheduler.h"
     
     // OpenCV...
     //  Updated for OpenCV 4
@@ -193,6 +196,7 @@ class MainFrame : public MainFrame_Base
         void OnChooseFieldOfViewDiameter(wxCommandEvent &Event);
         void OnChooseAnalysisType(wxCommandEvent &Event);
         void OnAnalyze(wxCommandEvent &Event);
+        void OnAnalyzeAll(wxCommandEvent &Event);
         void OnBeginAnalysis(wxCommandEvent &Event);
         void OnAnalysisCellRightClick(wxGridEvent &Event);
         void OnAnalysisCopyClipboard(wxCommandEvent &Event);
@@ -202,6 +206,13 @@ class MainFrame : public MainFrame_Base
         void OnEndAnalysis(wxCommandEvent &Event);
         void OnResetAIToDefaults(wxCommandEvent &Event);
 
+        // Analysis helpers...
+        bool AppendBodySizeResult(wxString const &sLabel,
+                                  WormMeasurement const &Measurement);
+        void CollectScheduledAnalysisResults();
+        void LockAnalysisUserInterface();
+        void UnlockAnalysisUserInterface();
+
         // Image analysis window has been toggled...
         void OnToggleImageAnalysisWindow(wxCommandEvent &Event);
 
@@ -240,6 +251,7 @@ class MainFrame : public MainFrame_Base
         enum
         {
             ID_ANALYZE = wxID_HIGHEST + 1,
+            ID_ANALYZE_ALL,
             ID_CHECK_FOR_UPDATE,
             ID_CHECK_FOR_UPDATE_DONE,
             ID_VIDEO_PLAYER,
@@ -304,6 +316,9 @@ class MainFrame : public MainFrame_Base
         // Analysis thread and timer...
         AnalysisThread         *pAnalysisThread;
         wxTimer                 AnalysisTimer;
+
+        // Scheduler when analyzing all media at once, otherwise NULL...
+        AnalysisScheduler      *pAnalysisScheduler;
         
         // Worm tracker...
         WormTracker             Tracker;
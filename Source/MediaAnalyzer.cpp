@@ -0,0 +1,1133 @@
+/*
+  Name:         MediaAnalyzer.cpp (implementation)
+  Author:       Kip Warner (Kip@TheVertigo.com)
+  Description:  MediaAnalyzer class. Feeds a single video or image through a
+                WormTracker without any user interface...
+*/
+
+// Includes...
+#include "MediaAnalyzer.h"
+#include <opencv2/core/version.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+
+// Find the identity a worm of some segment was reconciled to, flattening the
+//  path to it along the way...
+static unsigned int FindIdentity(
+    vector<unsigned int> &Identities, unsigned int unWorm)
+{
+    // Walk up to the root, pointing each along the way at its grandparent...
+    while(Identities[unWorm] != unWorm)
+    {
+        Identities[unWorm]  = Identities[Identities[unWorm]];
+        unWorm              = Identities[unWorm];
+    }
+
+    // Done...
+    return unWorm;
+}
+
+// Decoder constructor takes the capture to read from, the queue to fill, how
+//  many frames to advance by each time, and where to count the frames it
+//  didn't need to convert...
+FrameDecoder::FrameDecoder(cv::VideoCapture &_Capture, FrameQueue &_Queue,
+                           unsigned int const _unFrameStride,
+                           DecodeSavings &_Savings)
+    : wxThread(wxTHREAD_JOINABLE),
+      Capture(_Capture),
+      Queue(_Queue),
+      unFrameStride(_unFrameStride),
+      Savings(_Savings)
+{
+
+}
+
+// Decoder thread entry point...
+void *FrameDecoder::Entry()
+{
+    // Variables...
+    unsigned int unSkip = 0;
+
+    // Keep filling slots until the video ends or the tracker aborts...
+    while(true)
+    {
+        // Wait for an empty slot. The tracker has aborted...
+        cv::Mat *pGrayImage = Queue.BeginPush();
+        if(!pGrayImage)
+            break;
+
+        // Retrieve the captured image, skipping those between strides after
+        //  the first. There are no more...
+        if(!MediaAnalyzer::ReadFrame(Capture, OriginalImage, unSkip, Savings))
+            break;
+        unSkip = unFrameStride - 1;
+
+        // Convert straight into the slot and hand it over...
+        MediaAnalyzer::ConvertToGray(OriginalImage, *pGrayImage);
+        Queue.EndPush();
+    }
+
+    // Let the tracker know there will be no more...
+    Queue.Close();
+
+    // Done...
+    return NULL;
+}
+
+// Segment constructor takes the video, the tracker to copy the settings of,
+//  the first frame to read, how many frames to track only to overlap the
+//  segment before, how many to track in all or zero for the rest of the
+//  video, how many frames to advance by each time, and the semaphore to post
+//  when done...
+VideoSegment::VideoSegment(
+    string const &_sPath, WormTracker const &SourceTracker,
+    unsigned int const _unFirstFrame, unsigned int const _unOverlapFrames,
+    unsigned int const _unFrames, unsigned int const _unFrameStride,
+    wxSemaphore &_Finished)
+    : wxThread(wxTHREAD_JOINABLE),
+      sPath(_sPath),
+      unFirstFrame(_unFirstFrame),
+      unOverlapFrames(_unOverlapFrames),
+      unFrames(_unFrames),
+      unFrameStride(_unFrameStride),
+      Finished(_Finished),
+      bSucceeded(false),
+      bCancelled(false)
+{
+    // Track just like the source...
+    Tracker.ImportSettings(SourceTracker);
+}
+
+// Stop as soon as possible...
+void VideoSegment::Cancel()
+{
+    // Lock the request...
+    wxMutexLocker Lock(CancelMutex);
+
+    // Ask...
+    bCancelled = true;
+}
+
+// Segment thread entry point...
+void *VideoSegment::Entry()
+{
+    // Variables...
+    cv::VideoCapture    Capture;
+    unsigned int        unTracked   = 0;
+    unsigned int        unSkip      = 0;
+
+    // Open our own capture and seek to our first frame. Let the analyzer
+    //  know if we couldn't...
+    if(!Capture.open(sPath) ||
+       (unFirstFrame > 0 &&
+        !Capture.set(cv::CAP_PROP_POS_FRAMES, unFirstFrame)))
+    {
+        Finished.Post();
+        return NULL;
+    }
+
+    // Reset the tracker for as many frames as it will see...
+    Tracker.Reset(unFrames);
+
+    // Keep tracking until the end of the segment, or the video, or cancel
+    //  requested...
+    while(!IsCancelRequested() && (unFrames == 0 || unTracked < unFrames))
+    {
+        // Retrieve the captured image, skipping those between strides after
+        //  the first. There are no more...
+        if(!MediaAnalyzer::ReadFrame(Capture, OriginalImage, unSkip, Savings))
+            break;
+        unSkip = unFrameStride - 1;
+
+        // Feed into tracker, numbered by where it was in the video...
+        MediaAnalyzer::ConvertToGray(OriginalImage, GrayImage);
+        Tracker.Advance(GrayImage, unFirstFrame + unTracked * unFrameStride);
+
+        // That was the last frame of the overlap, where the segment before
+        //  ends, so remember how every worm was then...
+        if(++unTracked == unOverlapFrames)
+            SnapshotEntry();
+    }
+
+    // Reached the end, unless stopped...
+    bSucceeded = !IsCancelRequested();
+
+    // Let the analyzer know we are done...
+    Finished.Post();
+    return NULL;
+}
+
+// Have we been asked to stop?
+bool VideoSegment::IsCancelRequested() const
+{
+    // Lock the request...
+    wxMutexLocker Lock(CancelMutex);
+
+    // Check...
+    return bCancelled;
+}
+
+// Remember every worm as it is at the end of the overlap...
+void VideoSegment::SnapshotEntry()
+{
+    // Their measurements...
+    MediaAnalyzer::CollectMeasurements(Tracker, EntryMeasurements);
+
+    // Where each was, and whether it was still being tracked...
+    EntryCentres.clear();
+    EntryTracked.clear();
+    for(unsigned int unWormIndex = 0; unWormIndex < Tracker.Tracking();
+      ++unWormIndex)
+    {
+        EntryCentres.push_back(Tracker.GetWorm(unWormIndex).Centre());
+        EntryTracked.push_back(!Tracker.IsRetired(unWormIndex));
+    }
+}
+
+// Constructor needs the tracker to feed and, optionally, the thread we are
+//  running within so that we can honour its requests to stop...
+MediaAnalyzer::MediaAnalyzer(WormTracker &_Tracker, wxThread *_pOwnerThread)
+    : Tracker(_Tracker),
+      pOwnerThread(_pOwnerThread),
+      unFrameQueueDepth(DEFAULT_FRAME_QUEUE_DEPTH),
+      unFrameStride(1),
+      bKeyframesOnly(false),
+      unSegments(0),
+      bSegmented(false),
+      bSegmentedTimeSeriesRead(true)
+{
+
+}
+
+// Analyze the media, whichever kind it is. False on error...
+bool MediaAnalyzer::Analyze(string const &sPath)
+{
+    // It is a movie...
+    if(IsVideo(sPath))
+        return AnalyzeVideo(sPath);
+
+    // It is an image...
+    else
+        return AnalyzeImage(sPath);
+}
+
+// Analyze single image. False on error...
+bool MediaAnalyzer::AnalyzeImage(string const &sPath)
+{
+    // Reset the tracker, if not already...
+    Tracker.Reset(0);
+    bSegmented = false;
+
+    // Load the image...
+    cv::Mat const Image = cv::imread(sPath, cv::IMREAD_GRAYSCALE);
+
+        // Failed to load media...
+        if(Image.empty())
+        {
+            // Remember why...
+            sLastError = "Unable to load image. It may be in an unrecognized"
+                         " format.";
+
+            // Abort...
+            return false;
+        }
+
+    // Pick the threshold and candidate size window from the image itself, 
+    //  if asked to...
+    if(Tracker.IsAutoCalibrating())
+    {
+        Tracker.AddCalibrationFrame(Image);
+        Tracker.ApplyCalibration();
+        Tracker.Reset(0);
+    }
+
+    // Feed into tracker...
+    Tracker.Advance(Image);
+
+    // Done...
+    return true;
+}
+
+// Analyze video. False on error...
+bool MediaAnalyzer::AnalyzeVideo(string const &sPath)
+{
+    // Variables...
+    cv::VideoCapture    Capture;
+
+    // Initialize capture from the movie...
+    if(!Capture.open(sPath))
+    {
+        // Remember why...
+        sLastError = "Your system does not appear to have an suitable codec"
+                     " installed to read this media.";
+
+        // Abort...
+        return false;
+    }
+
+    // Pick the threshold and candidate size window from a sample of the 
+    //  frames first, if asked to...
+    if(Tracker.IsAutoCalibrating() && !CalibrateVideo(sPath, Capture))
+    {
+        // Remember why...
+        sLastError = "Unable to rewind the media after calibrating.";
+
+        // Abort...
+        return false;
+    }
+
+    // Forget the last video's statistics...
+    PipelineStalls  = FrameQueueStalls();
+    Savings         = DecodeSavings();
+    bSegmented      = false;
+
+    // Only the keyframes are wanted...
+    if(bKeyframesOnly)
+        return AnalyzeVideoKeyframes(sPath, Capture);
+
+    // Reset the tracker, if not already, for as many frames as it will see...
+    unsigned int const unTotalFrames =
+        (unsigned int) Capture.get(cv::CAP_PROP_FRAME_COUNT);
+    unsigned int const unTrackedFrames =
+        (unTotalFrames + unFrameStride - 1) / unFrameStride;
+    Tracker.Reset(unTrackedFrames);
+
+    // Split it into segments tracked side by side, if asked to and it is long
+    //  enough to be worth it...
+    unsigned int const unSegmentsUsed =
+        std::min(unSegments, unTrackedFrames / MINIMUM_SEGMENT_FRAMES);
+    if(unSegmentsUsed > 1)
+        return AnalyzeVideoSegmented(sPath, unTrackedFrames, unSegmentsUsed);
+
+    // Overlap decoding with tracking if we can, otherwise take turns...
+    if(unFrameQueueDepth == 0 || !AnalyzeVideoPipelined(Capture))
+        AnalyzeVideoSerially(Capture);
+
+    // Done...
+    return true;
+}
+
+// Decode and track only the video's keyframes, or every so many of them. The
+//  keyframes are found by reading the video's packets without decoding them,
+//  and then each is decoded alone by seeking straight to it. False on error...
+bool MediaAnalyzer::AnalyzeVideoKeyframes(
+    string const &sPath, cv::VideoCapture &Capture)
+{
+    // Variables...
+    cv::Mat                 OriginalImage;
+    vector<unsigned int>    Keyframes;
+    unsigned int            unFrames        = 0;
+    unsigned int            unUndecoded     = 0;
+
+    // Find them all...
+    if(!FindKeyframes(sPath, Keyframes, unFrames))
+        return false;
+
+    // Keep every so many...
+    unsigned int unKept = 0;
+    for(unsigned int unKeyframe = 0; unKeyframe < Keyframes.size();
+        unKeyframe += unFrameStride)
+        Keyframes[unKept++] = Keyframes[unKeyframe];
+    Keyframes.resize(unKept);
+
+    // Reset the tracker, if not already, for as many frames as it will see...
+    Tracker.Reset((unsigned int) Keyframes.size());
+
+    // Seek straight to each keyframe and decode only it...
+    for(vector<unsigned int>::const_iterator Iterator = Keyframes.begin();
+        Iterator != Keyframes.end() && !IsCancelled();
+      ++Iterator)
+    {
+        // Seek. There are no more...
+        if(!Capture.set(cv::CAP_PROP_POS_FRAMES, *Iterator) ||
+           !ReadFrame(Capture, OriginalImage, 0, Savings))
+            break;
+
+        // Every frame since the last one tracked went undecoded...
+        Savings.unFramesUndecoded += *Iterator - unUndecoded;
+        unUndecoded = *Iterator + 1;
+
+        // Feed into tracker, numbered by where it was in the video...
+        ConvertToGray(OriginalImage, GrayImage);
+        Tracker.Advance(GrayImage, *Iterator);
+    }
+
+    // So did every frame after the last...
+    if(unFrames > unUndecoded)
+        Savings.unFramesUndecoded += unFrames - unUndecoded;
+
+    // Done...
+    return true;
+}
+
+// Split the video into segments of time, each tracked on its own thread with
+//  its own capture and tracker, and reconcile them. False on error...
+bool MediaAnalyzer::AnalyzeVideoSegmented(
+    string const &sPath, unsigned int const unTrackedFrames,
+    unsigned int const unSegmentsUsed)
+{
+    // Variables...
+    vector<VideoSegment *>  Segments;
+    wxSemaphore             Finished;
+    unsigned int            unFinished  = 0;
+    bool                    bStarted    = true;
+    bool                    bCancelled  = false;
+
+    // Start a segment for each even stretch of the frames to track. Each
+    //  but the first also tracks the end of the stretch before...
+    for(unsigned int unSegment = 0; unSegment < unSegmentsUsed; ++unSegment)
+    {
+        // Where its stretch begins and ends, in frames tracked...
+        unsigned int const unBegin = (unsigned int)
+            ((unsigned long long) unTrackedFrames * unSegment /
+                unSegmentsUsed);
+        unsigned int const unEnd = (unsigned int)
+            ((unsigned long long) unTrackedFrames * (unSegment + 1) /
+                unSegmentsUsed);
+        unsigned int const unOverlap =
+            (unSegment > 0) ? SEGMENT_OVERLAP_FRAMES : 0;
+
+        // The last segment keeps going to the end, in case the video is
+        //  longer than it said...
+        unsigned int const unFrames = (unSegment + 1 < unSegmentsUsed) ?
+            unEnd - unBegin + unOverlap : 0;
+
+        // Create and run it...
+        VideoSegment *pSegment = new VideoSegment(
+            sPath, Tracker, (unBegin - unOverlap) * unFrameStride, unOverlap,
+            unFrames, unFrameStride, Finished);
+        if(pSegment->Create() != wxTHREAD_NO_ERROR ||
+           pSegment->Run() != wxTHREAD_NO_ERROR)
+        {
+            delete pSegment;
+            bStarted = false;
+            break;
+        }
+        Segments.push_back(pSegment);
+    }
+
+    // Wait for each to finish, stopping them all if we are asked to or one
+    //  couldn't be started...
+    while(unFinished < Segments.size())
+    {
+        // Stop them all...
+        if(!bCancelled && (!bStarted || IsCancelled()))
+        {
+            for(unsigned int unSegment = 0; unSegment < Segments.size();
+              ++unSegment)
+                Segments[unSegment]->Cancel();
+            bCancelled = true;
+        }
+
+        // Another finished...
+        if(Finished.WaitTimeout(SEGMENT_POLL_MILLISECONDS) == wxSEMA_NO_ERROR)
+          ++unFinished;
+    }
+
+    // Reap them, and check every one reached its end...
+    bool bAllSucceeded = true;
+    for(unsigned int unSegment = 0; unSegment < Segments.size(); ++unSegment)
+    {
+        Segments[unSegment]->Wait(wxTHREAD_WAIT_BLOCK);
+        bAllSucceeded = bAllSucceeded && Segments[unSegment]->bSucceeded;
+    }
+
+    // Combine them, unless stopped part way through...
+    if(bAllSucceeded && bStarted)
+    {
+        // Reconcile the worms...
+        ReconcileSegments(Segments);
+        bSegmented = true;
+
+        // Add up how much decoding each avoided...
+        for(unsigned int unSegment = 0; unSegment < Segments.size();
+          ++unSegment)
+        {
+            DecodeSavings const &SegmentSavings = Segments[unSegment]->Savings;
+            Savings.unFramesRetrieved   += SegmentSavings.unFramesRetrieved;
+            Savings.unFramesGrabbed     += SegmentSavings.unFramesGrabbed;
+            Savings.unFramesUndecoded   += SegmentSavings.unFramesUndecoded;
+        }
+    }
+
+    // Cleanup...
+    for(unsigned int unSegment = 0; unSegment < Segments.size(); ++unSegment)
+        delete Segments[unSegment];
+
+    // We were asked to stop, so whatever we have will do...
+    if(bStarted && IsCancelled())
+        return true;
+
+    // A segment couldn't be started, or couldn't open or seek its own
+    //  capture...
+    if(!bStarted || !bAllSucceeded)
+    {
+        // Remember why...
+        sLastError = "Unable to analyze each segment of the media at once.";
+
+        // Abort...
+        return false;
+    }
+
+    // Done...
+    return true;
+}
+
+// Decode on a separate thread while we track on this one. False if the
+//  decoder could not be started...
+bool MediaAnalyzer::AnalyzeVideoPipelined(cv::VideoCapture &Capture)
+{
+    // Frames in flight between the decoder and us, and where the next was in
+    //  the video. The decoder hands over every so many in order...
+    FrameQueue      Queue(unFrameQueueDepth);
+    unsigned int    unSourceFrame = 0;
+
+    // Create and run the decoder...
+    FrameDecoder Decoder(Capture, Queue, unFrameStride, Savings);
+    if(Decoder.Create() != wxTHREAD_NO_ERROR ||
+       Decoder.Run() != wxTHREAD_NO_ERROR)
+        return false;
+
+    // Keep tracking frames until there are none left or cancel requested...
+    while(!IsCancelled())
+    {
+        // Wait for the next decoded frame. There are no more...
+        cv::Mat *pGrayImage = Queue.BeginPop();
+        if(!pGrayImage)
+            break;
+
+        // Feed into tracker...
+        Tracker.Advance(*pGrayImage, unSourceFrame);
+        unSourceFrame += unFrameStride;
+
+        // Give the slot back to the decoder...
+        Queue.EndPop();
+    }
+
+    // Stop the decoder, if it hasn't already, and wait for it...
+    Queue.Abort();
+    Decoder.Wait(wxTHREAD_WAIT_BLOCK);
+
+    // Remember how much each side waited on the other...
+    PipelineStalls = Queue.GetStalls();
+
+    // Done...
+    return true;
+}
+
+// Decode and track each frame in turn on this thread...
+void MediaAnalyzer::AnalyzeVideoSerially(cv::VideoCapture &Capture)
+{
+    // Variables...
+    cv::Mat             OriginalImage;
+    unsigned int        unSkip          = 0;
+    unsigned int        unSourceFrame   = 0;
+
+    // Keep analyzing media until there is nothing left or cancel requested...
+    while(!IsCancelled())
+    {
+        // Retrieve the captured image, skipping those between strides after
+        //  the first. There are no more...
+        if(!ReadFrame(Capture, OriginalImage, unSkip, Savings))
+            break;
+        unSkip = unFrameStride - 1;
+
+        // The tracker prefers grayscale 8-bit unsigned format, prepare...
+        ConvertToGray(OriginalImage, GrayImage);
+
+        // Feed into tracker, numbered by where it was in the video...
+        Tracker.Advance(GrayImage, unSourceFrame);
+        unSourceFrame += unFrameStride;
+    }
+}
+
+// Pick the tracker's threshold and candidate size window from a sample of the
+//  video's frames, stopping as soon as the estimate converges, and then rewind
+//  it. False if it couldn't be rewound...
+bool MediaAnalyzer::CalibrateVideo(
+    string const &sPath, cv::VideoCapture &Capture)
+{
+    // Variables...
+    cv::Mat             OriginalImage;
+    int const           nTotalFrames = 
+        (int) Capture.get(cv::CAP_PROP_FRAME_COUNT);
+
+    // Start sampling afresh...
+    Tracker.Reset(0);
+
+    // Spread the samples evenly through the video. If its length isn't 
+    //  known, take them from the start...
+    int const nStride = 
+        std::max(nTotalFrames / (int) MAXIMUM_CALIBRATION_FRAMES, 1);
+
+    // Sample until the estimate converges or we run out of samples...
+    for(unsigned int unSample = 0; 
+        unSample < MAXIMUM_CALIBRATION_FRAMES && !IsCancelled();
+      ++unSample)
+    {
+        // Seek to the next sample, if they aren't consecutive...
+        if(nStride > 1)
+            Capture.set(cv::CAP_PROP_POS_FRAMES, unSample * nStride);
+
+        // Retrieve it. There are no more...
+        if(!ReadFrame(Capture, OriginalImage, 0, Savings))
+            break;
+
+        // Sample it. The estimate has converged...
+        ConvertToGray(OriginalImage, GrayImage);
+        if(Tracker.AddCalibrationFrame(GrayImage))
+            break;
+    }
+
+    // Use whatever was estimated...
+    Tracker.ApplyCalibration();
+
+    // Not every backend can seek back to the start reliably, so reopen it
+    //  instead...
+    Capture.release();
+    return Capture.open(sPath);
+}
+
+// Collect the body size measurements of every worm the tracker knows about...
+void MediaAnalyzer::CollectMeasurements(
+    WormTracker const &SourceTracker,
+    vector<WormMeasurement> &Measurements)
+{
+    // Start fresh...
+    Measurements.clear();
+    Measurements.reserve(SourceTracker.Tracking());
+
+    // Convert each worm's metrics from pixels into real units...
+    for(unsigned int unWormIndex = 0; unWormIndex < SourceTracker.Tracking();
+      ++unWormIndex)
+    {
+        // Get the worm at this index...
+        Worm const &CurrentWorm = SourceTracker.GetWorm(unWormIndex);
+
+        // Convert...
+        WormMeasurement Measurement;
+        Measurement.dLength             =
+            SourceTracker.ConvertPixelsToMillimeters(CurrentWorm.Length());
+        Measurement.dHalfPerimeter      =
+            SourceTracker.ConvertPixelsToMillimeters(
+                CurrentWorm.HalfPerimeter());
+        Measurement.dWidth              =
+            SourceTracker.ConvertPixelsToMillimeters(CurrentWorm.Width());
+        Measurement.dArea               =
+            SourceTracker.ConvertSquarePixelsToSquareMillimeters(
+                CurrentWorm.Area());
+        Measurement.unRefreshes         = CurrentWorm.Refreshes();
+        Measurement.unLengthRefreshes   = CurrentWorm.LengthRefreshes();
+
+        // Store...
+        Measurements.push_back(Measurement);
+    }
+}
+
+// Collect the measurements from every frame of every worm the tracker knows
+//  about, if it was recording them. False if those spilled to disk couldn't be
+//  read back...
+bool MediaAnalyzer::CollectTimeSeries(
+    WormTracker const &SourceTracker,
+    vector<vector<WormSample> > &TimeSeries)
+{
+    // Start fresh, with a series for each worm, empty unless recorded...
+    TimeSeries.clear();
+    TimeSeries.resize(SourceTracker.Tracking());
+
+    // Read each back...
+    for(unsigned int unWormIndex = 0; unWormIndex < SourceTracker.Tracking();
+      ++unWormIndex)
+    {
+        if(!SourceTracker.GetTimeSeries(unWormIndex, TimeSeries[unWormIndex]))
+            return false;
+    }
+
+    // Done...
+    return true;
+}
+
+// Convert a decoded frame into the 8-bit grayscale the tracker prefers...
+void MediaAnalyzer::ConvertToGray(
+    cv::Mat const &OriginalImage, cv::Mat &GrayImage)
+{
+    // Pick the conversion based on how many channels the codec handed us...
+    switch(OriginalImage.channels())
+    {
+        // Already grayscale, just copy into our buffer...
+        case 1: OriginalImage.copyTo(GrayImage); break;
+
+        // Blue, green, red, and alpha...
+        case 4: cv::cvtColor(OriginalImage, GrayImage, cv::COLOR_BGRA2GRAY);
+                break;
+
+        // Blue, green, and red...
+        default:
+            cv::cvtColor(OriginalImage, GrayImage, cv::COLOR_BGR2GRAY);
+            break;
+    }
+}
+
+// Find a video's keyframes without decoding anything, as the indices of the 
+//  frames they are shown as, in order, and count its frames. Needs OpenCV's
+//  FFmpeg backend. False on error...
+bool MediaAnalyzer::FindKeyframes(
+    string const &sPath, vector<unsigned int> &Keyframes,
+    unsigned int &unFrames)
+{
+    // Start fresh...
+    Keyframes.clear();
+    unFrames = 0;
+
+    // OpenCV can only say which packets are keyframes since 4.7...
+    #if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 7)
+
+        // Variables...
+        cv::VideoCapture    Packets;
+        cv::Mat             Packet;
+
+        // Open the video again to read its packets undecoded...
+        vector<int> const Parameters = { cv::CAP_PROP_FORMAT, -1 };
+        if(!Packets.open(sPath, cv::CAP_FFMPEG, Parameters))
+        {
+            // Remember why...
+            sLastError = "Keyframe only analysis needs OpenCV's FFmpeg"
+                         " backend.";
+
+            // Abort...
+            return false;
+        }
+
+        // Note each keyframe. Packets are in decoding order, which differs
+        //  from the order frames are shown in wherever a frame is predicted
+        //  from one shown after it, so a keyframe's place among the packets
+        //  isn't the frame it is shown as. Its presentation time is, at the
+        //  video's frame rate, which is also how seeking counts frames...
+        double const dFramesPerMillisecond = Packets.get(cv::CAP_PROP_FPS) /
+                                             1000.0;
+        while(!IsCancelled() && Packets.read(Packet))
+        {
+            // A keyframe...
+            if(Packets.get(cv::CAP_PROP_LRF_HAS_KEY_FRAME) != 0.0)
+                Keyframes.push_back((unsigned int) std::max(0L, lround(
+                    Packets.get(cv::CAP_PROP_POS_MSEC) *
+                        dFramesPerMillisecond)));
+
+            // Next...
+          ++unFrames;
+        }
+        Packets.release();
+
+        // Put them in the order they are shown in, once each...
+        std::sort(Keyframes.begin(), Keyframes.end());
+        Keyframes.erase(std::unique(Keyframes.begin(), Keyframes.end()),
+                        Keyframes.end());
+
+        // Done...
+        return true;
+
+    // Otherwise we can't tell where they are without decoding everything...
+    #else
+
+        // Unused...
+        (void) sPath;
+
+        // Remember why...
+        sLastError = "Keyframe only analysis needs OpenCV 4.7 or later.";
+
+        // Abort...
+        return false;
+
+    #endif
+}
+
+// Number of decoded frames that may wait for the tracker, or zero if the
+//  decoder and tracker take turns...
+unsigned int MediaAnalyzer::GetFrameQueueDepth() const
+{
+    // Return it...
+    return unFrameQueueDepth;
+}
+
+// How much of the last video's decoding was avoided...
+DecodeSavings const &MediaAnalyzer::GetDecodeSavings() const
+{
+    // Return it...
+    return Savings;
+}
+
+// Number of frames to advance by each time, where one tracks every frame...
+unsigned int MediaAnalyzer::GetFrameStride() const
+{
+    // Return it...
+    return unFrameStride;
+}
+
+// Get a description of the last error encountered, if any...
+string const &MediaAnalyzer::GetLastError() const
+{
+    // Return it...
+    return sLastError;
+}
+
+// Collect the body size measurements of every worm found in the media last
+//  analyzed, reconciled across segments if it was split into them...
+void MediaAnalyzer::GetMeasurements(
+    vector<WormMeasurement> &Measurements) const
+{
+    // Segmented, so already reconciled...
+    if(bSegmented)
+        Measurements = SegmentedMeasurements;
+
+    // Otherwise straight from the tracker...
+    else
+        CollectMeasurements(Tracker, Measurements);
+}
+
+// How much the decoder and tracker waited on each other during the last video
+//  analyzed...
+FrameQueueStalls const &MediaAnalyzer::GetPipelineStalls() const
+{
+    // Return it...
+    return PipelineStalls;
+}
+
+// Collect the measurements from every frame of every worm found in the media
+//  last analyzed, in the same order as GetMeasurements(), if the tracker was
+//  recording them. False if they couldn't all be read back...
+bool MediaAnalyzer::GetTimeSeries(
+    vector<vector<WormSample> > &TimeSeries) const
+{
+    // Segmented, so already pieced together...
+    if(bSegmented)
+    {
+        TimeSeries = SegmentedTimeSeries;
+        return bSegmentedTimeSeriesRead;
+    }
+
+    // Otherwise straight from the tracker...
+    return CollectTimeSeries(Tracker, TimeSeries);
+}
+
+// Has our owner asked us to stop?
+bool MediaAnalyzer::IsCancelled() const
+{
+    // Only a thread can ask us to stop...
+    return pOwnerThread ? pOwnerThread->TestDestroy() : false;
+}
+
+// Are only a video's keyframes decoded and tracked?
+bool MediaAnalyzer::IsKeyframesOnly() const
+{
+    // Return it...
+    return bKeyframesOnly;
+}
+
+// Is the media at the given path a movie, judging by its extension?
+bool MediaAnalyzer::IsVideo(string const &sPath)
+{
+    // Find the extension...
+    string::size_type const Dot = sPath.find_last_of('.');
+
+        // None...
+        if(Dot == string::npos)
+            return false;
+
+    // Lower case it...
+    string sExtension = sPath.substr(Dot + 1);
+    transform(sExtension.begin(), sExtension.end(), sExtension.begin(),
+              (int (*)(int)) tolower);
+
+    // Check against the movie formats we know about...
+    return (sExtension == "mov"   ||
+            sExtension == "avi"   ||
+            sExtension == "mpg"   ||
+            sExtension == "mpeg");
+}
+
+// Read the next frame, after grabbing without converting the given number of
+//  frames before it. False if there are no more...
+bool MediaAnalyzer::ReadFrame(
+    cv::VideoCapture &Capture, cv::Mat &OriginalImage,
+    unsigned int const unSkip, DecodeSavings &Savings)
+{
+    // Grab the frames to skip, but never retrieve them. There are no more...
+    for(unsigned int unSkipped = 0; unSkipped < unSkip; ++unSkipped)
+    {
+        if(!Capture.grab())
+            return false;
+      ++Savings.unFramesGrabbed;
+    }
+
+    // Retrieve the captured image. There are no more...
+    if(!Capture.read(OriginalImage) || OriginalImage.empty())
+        return false;
+
+    // The Quicktime backend appears to be buggy in that it keeps cycling
+    //  through the video even after we have all frames. A temporary hack
+    //  is to just break the analysis loop when we have both current frame,
+    //  total frame, and they are equal...
+    #ifdef __APPLE__
+
+        // Get current position...
+        int const nCurrentFrame = (int)
+            Capture.get(cv::CAP_PROP_POS_FRAMES);
+
+        // Get total number of frames...
+        int const nTotalFrames = (int)
+            Capture.get(cv::CAP_PROP_FRAME_COUNT);
+
+        // Reached the end...
+        if(nCurrentFrame + 1 == nTotalFrames)
+            return false;
+
+    #endif
+
+    // Got one...
+  ++Savings.unFramesRetrieved;
+    return true;
+}
+
+// Match each segment's worms at the end of its overlap with those the segment
+//  before was still tracking at the same frame, and combine the measurements
+//  and any time series of each worm so matched, leaving out the overlapping
+//  frames counted twice. Matching is θ(nm) in the worms either side of each
+//  boundary...
+void MediaAnalyzer::ReconcileSegments(vector<VideoSegment *> const &Segments)
+{
+    // Variables...
+    vector<vector<WormMeasurement> >    FinalMeasurements(Segments.size());
+    vector<unsigned int>                Offsets(Segments.size(), 0);
+    vector<unsigned int>                Identities;
+    vector<SegmentPairing>              Pairings;
+    vector<bool>                        BeforePaired;
+    vector<bool>                        AfterPaired;
+    vector<vector<WormSample> >         SegmentTimeSeries;
+
+    // Every worm of every segment starts out an identity of its own,
+    //  numbered in segment order...
+    for(unsigned int unSegment = 0; unSegment < Segments.size(); ++unSegment)
+    {
+        CollectMeasurements(
+            Segments[unSegment]->Tracker, FinalMeasurements[unSegment]);
+        Offsets[unSegment] = Identities.size();
+        for(unsigned int unWormIndex = 0;
+            unWormIndex < FinalMeasurements[unSegment].size();
+          ++unWormIndex)
+            Identities.push_back(Identities.size());
+    }
+
+    // Match up the worms at each boundary...
+    for(unsigned int unSegment = 1; unSegment < Segments.size(); ++unSegment)
+    {
+        // The segment before ended on the same frame the overlap did...
+        VideoSegment const &Before  = *Segments[unSegment - 1];
+        VideoSegment const &After   = *Segments[unSegment];
+
+        // Pair every worm still tracked at the end of the overlap with every
+        //  worm still tracked at the end of the segment before whose centre
+        //  is within a body's width of its own...
+        Pairings.clear();
+        for(unsigned int unAfter = 0; unAfter < After.EntryCentres.size();
+          ++unAfter)
+        {
+            // Not tracked any more...
+            if(!After.EntryTracked[unAfter])
+                continue;
+
+            // Check every worm before...
+            for(unsigned int unBefore = 0;
+                unBefore < Before.Tracker.Tracking();
+              ++unBefore)
+            {
+                // Not tracked any more...
+                if(Before.Tracker.IsRetired(unBefore))
+                    continue;
+
+                // Too far apart to be the same worm...
+                Worm const &BeforeWorm = Before.Tracker.GetWorm(unBefore);
+                SegmentPairing Pairing;
+                Pairing.dDistance = std::hypot(
+                    BeforeWorm.Centre().x - After.EntryCentres[unAfter].x,
+                    BeforeWorm.Centre().y - After.EntryCentres[unAfter].y);
+                if(Pairing.dDistance > BeforeWorm.Width())
+                    continue;
+
+                // Could be...
+                Pairing.unBefore    = unBefore;
+                Pairing.unAfter     = unAfter;
+                Pairings.push_back(Pairing);
+            }
+        }
+
+        // Join the closest pairs first, each worm with at most one...
+        std::sort(Pairings.begin(), Pairings.end());
+        BeforePaired.assign(Before.Tracker.Tracking(), false);
+        AfterPaired.assign(After.EntryCentres.size(), false);
+        for(unsigned int unPairing = 0; unPairing < Pairings.size();
+          ++unPairing)
+        {
+            // Either is already paired...
+            SegmentPairing const &Pairing = Pairings[unPairing];
+            if(BeforePaired[Pairing.unBefore] || AfterPaired[Pairing.unAfter])
+                continue;
+            BeforePaired[Pairing.unBefore]  = true;
+            AfterPaired[Pairing.unAfter]    = true;
+
+            // Same worm, so the same identity, keeping the earliest...
+            unsigned int const unBeforeIdentity = FindIdentity(
+                Identities, Offsets[unSegment - 1] + Pairing.unBefore);
+            unsigned int const unAfterIdentity = FindIdentity(
+                Identities, Offsets[unSegment] + Pairing.unAfter);
+            Identities[unAfterIdentity] =
+                std::min(unBeforeIdentity, unAfterIdentity);
+            Identities[unBeforeIdentity] =
+                std::min(unBeforeIdentity, unAfterIdentity);
+        }
+    }
+
+    // Combine each identity's measurements over every frame it was seen in.
+    //  The length along the midline is an average over the refreshes it was
+    //  traced in and half the perimeter over every refresh, so weighting each
+    //  by its own count gives its total, and what a worm had at the end of
+    //  its segment's overlap is what the segment before already counted. The
+    //  width and area are the greatest ever seen, so are just the greatest of
+    //  any segment's, overlap and all...
+    vector<WormMeasurement> Totals(Identities.size());
+    for(unsigned int unIdentity = 0; unIdentity < Totals.size(); ++unIdentity)
+    {
+        Totals[unIdentity].dLength              = 0.0;
+        Totals[unIdentity].dHalfPerimeter       = 0.0;
+        Totals[unIdentity].dWidth               = 0.0;
+        Totals[unIdentity].dArea                = 0.0;
+        Totals[unIdentity].unRefreshes          = 0;
+        Totals[unIdentity].unLengthRefreshes    = 0;
+    }
+    for(unsigned int unSegment = 0; unSegment < Segments.size(); ++unSegment)
+    {
+        vector<WormMeasurement> const &Entry =
+            Segments[unSegment]->EntryMeasurements;
+        for(unsigned int unWormIndex = 0;
+            unWormIndex < FinalMeasurements[unSegment].size();
+          ++unWormIndex)
+        {
+            // Whole segment...
+            WormMeasurement const &Final =
+                FinalMeasurements[unSegment][unWormIndex];
+            WormMeasurement &Total = Totals[FindIdentity(
+                Identities, Offsets[unSegment] + unWormIndex)];
+            Total.dLength           +=
+                Final.dLength * Final.unLengthRefreshes;
+            Total.dHalfPerimeter    += Final.dHalfPerimeter * Final.unRefreshes;
+            Total.dWidth             = std::max(Total.dWidth, Final.dWidth);
+            Total.dArea              = std::max(Total.dArea, Final.dArea);
+            Total.unRefreshes       += Final.unRefreshes;
+            Total.unLengthRefreshes += Final.unLengthRefreshes;
+
+            // Less the overlap...
+            if(unWormIndex < Entry.size())
+            {
+                WormMeasurement const &Overlap = Entry[unWormIndex];
+                Total.dLength           -=
+                    Overlap.dLength * Overlap.unLengthRefreshes;
+                Total.dHalfPerimeter    -=
+                    Overlap.dHalfPerimeter * Overlap.unRefreshes;
+                Total.unRefreshes       -= Overlap.unRefreshes;
+                Total.unLengthRefreshes -= Overlap.unLengthRefreshes;
+            }
+        }
+    }
+
+    // Piece together each identity's time series, if recorded, from the
+    //  frames of each segment after its overlap. Each was already numbered by
+    //  where it was in the video...
+    vector<vector<WormSample> > TimeSeries(Identities.size());
+    bSegmentedTimeSeriesRead = true;
+    for(unsigned int unSegment = 0; unSegment < Segments.size(); ++unSegment)
+    {
+        // Read back its worms' series...
+        VideoSegment const &Segment = *Segments[unSegment];
+        if(!CollectTimeSeries(Segment.Tracker, SegmentTimeSeries))
+            bSegmentedTimeSeriesRead = false;
+
+        // Add every sample after the overlap to its identity's...
+        unsigned int const unOverlapEnd = Segment.unFirstFrame +
+            Segment.unOverlapFrames * Segment.unFrameStride;
+        for(unsigned int unWormIndex = 0;
+            unWormIndex < SegmentTimeSeries.size();
+          ++unWormIndex)
+        {
+            vector<WormSample> &Series = TimeSeries[FindIdentity(
+                Identities, Offsets[unSegment] + unWormIndex)];
+            for(vector<WormSample>::const_iterator Iterator =
+                    SegmentTimeSeries[unWormIndex].begin();
+                Iterator != SegmentTimeSeries[unWormIndex].end();
+              ++Iterator)
+            {
+                // Counted by the segment before...
+                if(Iterator->unFrame < unOverlapEnd)
+                    continue;
+
+                // Add...
+                Series.push_back(*Iterator);
+            }
+        }
+    }
+
+    // Average the length of each identity seen outside of an overlap, in
+    //  order of when it was first seen, keeping its time series alongside...
+    SegmentedMeasurements.clear();
+    SegmentedTimeSeries.clear();
+    for(unsigned int unIdentity = 0; unIdentity < Totals.size(); ++unIdentity)
+    {
+        // Not an identity of its own, or only ever seen in an overlap...
+        WormMeasurement Measurement = Totals[unIdentity];
+        if(Identities[unIdentity] != unIdentity ||
+           Measurement.unRefreshes == 0)
+            continue;
+
+        // Average the length along the midline, or half the perimeter if it
+        //  was never traced outside of an overlap...
+        Measurement.dHalfPerimeter /= Measurement.unRefreshes;
+        if(Measurement.unLengthRefreshes > 0)
+            Measurement.dLength /= Measurement.unLengthRefreshes;
+        else
+            Measurement.dLength = Measurement.dHalfPerimeter;
+        SegmentedMeasurements.push_back(Measurement);
+        SegmentedTimeSeries.push_back(vector<WormSample>());
+        SegmentedTimeSeries.back().swap(TimeSeries[unIdentity]);
+    }
+}
+
+// Set the number of decoded frames that may wait for the tracker, or zero to
+//  have the decoder and tracker take turns...
+void MediaAnalyzer::SetFrameQueueDepth(unsigned int const unDepth)
+{
+    // Store it...
+    unFrameQueueDepth = unDepth;
+}
+
+// Set the number of frames to advance by each time. Zero or one tracks every
+//  frame...
+void MediaAnalyzer::SetFrameStride(unsigned int const unStride)
+{
+    // Store it...
+    unFrameStride = std::max(unStride, 1u);
+}
+
+// Decode and track only a video's keyframes...
+void MediaAnalyzer::SetKeyframesOnly(bool const bEnable)
+{
+    // Store it...
+    bKeyframesOnly = bEnable;
+}
+
+// Split each long video into this many segments of time, each analyzed on its
+//  own processor, and match the worms up across their boundaries afterwards.
+//  Zero or one doesn't...
+void MediaAnalyzer::SetSegments(unsigned int const _unSegments)
+{
+    // Store it...
+    unSegments = _unSegments;
+}
@@ -0,0 +1,452 @@
+/*
+  Name:         MediaAnalyzer.h (definition)
+  Author:       Kip Warner (Kip@TheVertigo.com)
+  Description:  MediaAnalyzer class. Feeds a single video or image through a
+                WormTracker without any user interface...
+*/
+
+// Multiple include protection...
+#ifndef _MEDIAANALYZER_H_
+#define _MEDIAANALYZER_H_
+
+// Includes...
+
+    // Worm tracker...
+    #include "WormTracker.h"
+
+    // Frames in flight between the decoder and the tracker...
+    #include "FrameQueue.h"
+
+    // OpenCV...
+    #include <opencv2/opencv.hpp>
+    #include <opencv2/videoio.hpp>
+
+    // wxWidgets threading, so the owning thread can ask us to stop...
+    #include <wx/thread.h>
+
+    // Standard libraries and STL...
+    #include <string>
+    #include <vector>
+
+    // Using the standard namespace...
+    using namespace std;
+
+// Body size measurements of a single worm, already converted to real units...
+typedef struct WormMeasurement
+{
+    // Length in millimeters...
+    double          dLength;
+
+    // Half the perimeter in millimeters, averaged over every frame, which is
+    //  the length if it was never measured along the midline...
+    double          dHalfPerimeter;
+
+    // Width in millimeters...
+    double          dWidth;
+
+    // Area in millimeters²...
+    double          dArea;
+
+    // Number of frames the worm was seen in, and of those that its length
+    //  was measured along the midline in...
+    unsigned int    unRefreshes;
+    unsigned int    unLengthRefreshes;
+
+}WormMeasurement;
+
+// How much of a video's decoding was avoided by not tracking every frame...
+typedef struct DecodeSavings
+{
+    // Inline constructor initializer...
+    DecodeSavings()
+        : unFramesRetrieved(0),
+          unFramesGrabbed(0),
+          unFramesUndecoded(0)
+    {
+    }
+
+    // Frames decoded and converted for the tracker...
+    unsigned int    unFramesRetrieved;
+
+    // Frames skipped between strides. Most backends must still decode these
+    //  to keep their place, but never convert them...
+    unsigned int    unFramesGrabbed;
+
+    // Frames between keyframes, which were never decoded at all...
+    unsigned int    unFramesUndecoded;
+
+}DecodeSavings;
+
+// Forward declarations...
+class MediaAnalyzer;
+
+// Helper classes...
+
+    // A decoder thread reads and converts frames ahead of the tracker...
+    class FrameDecoder : public wxThread
+    {
+        // Public methods...
+        public:
+
+            // Constructor takes the capture to read from, the queue to fill,
+            //  how many frames to advance by each time, and where to count
+            //  the frames it didn't need to convert...
+            FrameDecoder(cv::VideoCapture &_Capture, FrameQueue &_Queue,
+                         unsigned int const _unFrameStride,
+                         DecodeSavings &_Savings);
+
+            // Thread entry point...
+            virtual void *Entry();
+
+        // Protected attributes...
+        protected:
+
+            // The capture we read from...
+            cv::VideoCapture   &Capture;
+
+            // The queue we fill...
+            FrameQueue         &Queue;
+
+            // Frames to advance by each time, and the frames we didn't need
+            //  to convert...
+            unsigned int const  unFrameStride;
+            DecodeSavings      &Savings;
+
+            // Frame as the codec handed it to us, reused between frames...
+            cv::Mat             OriginalImage;
+    };
+
+    // A segment thread analyzes one stretch of a long video with its own
+    //  capture and tracker. It starts a little before the stretch, so that
+    //  its worms can be matched with those of the segment before...
+    class VideoSegment : public wxThread
+    {
+        // Friends...
+        friend class MediaAnalyzer;
+
+        // Public methods...
+        public:
+
+            // Constructor takes the video, the tracker to copy the settings
+            //  of, the first frame to read, how many frames to track only to
+            //  overlap the segment before, how many to track in all or zero
+            //  for the rest of the video, how many frames to advance by each
+            //  time, and the semaphore to post when done...
+            VideoSegment(string const &_sPath,
+                         WormTracker const &SourceTracker,
+                         unsigned int const _unFirstFrame,
+                         unsigned int const _unOverlapFrames,
+                         unsigned int const _unFrames,
+                         unsigned int const _unFrameStride,
+                         wxSemaphore &_Finished);
+
+            // Stop as soon as possible...
+            void                Cancel();
+
+            // Thread entry point...
+            virtual void *Entry();
+
+        // Protected methods...
+        protected:
+
+            // Have we been asked to stop?
+            bool                IsCancelRequested() const;
+
+            // Remember every worm as it is at the end of the overlap...
+            void                SnapshotEntry();
+
+        // Protected attributes...
+        protected:
+
+            // The video, the first frame to read, the frames to track only
+            //  to overlap the segment before, the frames to track in all or
+            //  zero for the rest, and the frames to advance by each time...
+            string const        sPath;
+            unsigned int const  unFirstFrame;
+            unsigned int const  unOverlapFrames;
+            unsigned int const  unFrames;
+            unsigned int const  unFrameStride;
+
+            // Our very own tracker...
+            WormTracker         Tracker;
+
+            // Posted when we are done, and whether we reached the end of the
+            //  segment...
+            wxSemaphore        &Finished;
+            bool                bSucceeded;
+
+            // How much of our decoding was avoided...
+            DecodeSavings       Savings;
+
+            // Every worm's measurements at the end of the overlap, and where
+            //  its centre was and whether it was still tracked then...
+            vector<WormMeasurement> EntryMeasurements;
+            vector<CvPoint>         EntryCentres;
+            vector<bool>            EntryTracked;
+
+            // Frame as the codec handed it to us and in grayscale, reused
+            //  between frames...
+            cv::Mat             OriginalImage;
+            cv::Mat             GrayImage;
+
+            // Cancel request and its mutex...
+            mutable wxMutex     CancelMutex;
+            bool                bCancelled;
+    };
+
+// MediaAnalyzer class...
+class MediaAnalyzer
+{
+    // Friends...
+    friend class FrameDecoder;
+    friend class VideoSegment;
+
+    // Public methods...
+    public:
+
+        // Default number of decoded frames that may wait for the tracker...
+        enum { DEFAULT_FRAME_QUEUE_DEPTH = 8 };
+
+        // Constructor needs the tracker to feed and, optionally, the thread we
+        //  are running within so that we can honour its requests to stop...
+        MediaAnalyzer(WormTracker &_Tracker, wxThread *_pOwnerThread = NULL);
+
+        // Accessors...
+
+            // Collect the body size measurements of every worm the tracker
+            //  knows about...
+            static void CollectMeasurements(
+                WormTracker const &SourceTracker,
+                vector<WormMeasurement> &Measurements);
+
+            // Collect the measurements from every frame of every worm the
+            //  tracker knows about, if it was recording them. False if those
+            //  spilled to disk couldn't be read back...
+            static bool CollectTimeSeries(
+                WormTracker const &SourceTracker,
+                vector<vector<WormSample> > &TimeSeries);
+
+            // Number of decoded frames that may wait for the tracker, or
+            //  zero if the decoder and tracker take turns...
+            unsigned int        GetFrameQueueDepth() const;
+
+            // How much of the last video's decoding was avoided...
+            DecodeSavings const &GetDecodeSavings() const;
+
+            // Number of frames to advance by each time, where one tracks
+            //  every frame...
+            unsigned int        GetFrameStride() const;
+
+            // Get a description of the last error encountered, if any...
+            string const       &GetLastError() const;
+
+            // Collect the body size measurements of every worm found in the
+            //  media last analyzed, reconciled across segments if it was
+            //  split into them...
+            void                GetMeasurements(
+                                    vector<WormMeasurement> &Measurements)
+                                    const;
+
+            // How much the decoder and tracker waited on each other during
+            //  the last video analyzed...
+            FrameQueueStalls const &GetPipelineStalls() const;
+
+            // Collect the measurements from every frame of every worm found
+            //  in the media last analyzed, in the same order as 
+            //  GetMeasurements(), if the tracker was recording them. Frames
+            //  are numbered by where they were in the video, and pieced 
+            //  together across segments if it was split into them. False if
+            //  they couldn't all be read back...
+            bool                GetTimeSeries(
+                                    vector<vector<WormSample> > &TimeSeries)
+                                    const;
+
+            // Are only a video's keyframes decoded and tracked?
+            bool                IsKeyframesOnly() const;
+
+            // Is the media at the given path a movie, judging by its
+            //  extension?
+            static bool         IsVideo(string const &sPath);
+
+        // Mutators...
+
+            // Analyze the media, whichever kind it is. False on error...
+            bool                Analyze(string const &sPath);
+
+            // Analyze single image. False on error...
+            bool                AnalyzeImage(string const &sPath);
+
+            // Analyze video. False on error...
+            bool                AnalyzeVideo(string const &sPath);
+
+            // Find a video's keyframes without decoding anything, as the 
+            //  indices of the frames they are shown as, in order, and count
+            //  its frames. Needs OpenCV's FFmpeg backend. False on error...
+            bool                FindKeyframes(
+                                    string const &sPath,
+                                    vector<unsigned int> &Keyframes,
+                                    unsigned int &unFrames);
+
+            // Set the number of decoded frames that may wait for the tracker,
+            //  or zero to have the decoder and tracker take turns...
+            void                SetFrameQueueDepth(unsigned int const unDepth);
+
+            // Set the number of frames to advance by each time. Frames in
+            //  between are grabbed, but never converted. Zero or one tracks
+            //  every frame...
+            void                SetFrameStride(unsigned int const unStride);
+
+            // Decode and track only a video's keyframes, finding them without
+            //  decoding anything. Needs OpenCV's FFmpeg backend...
+            void                SetKeyframesOnly(bool const bEnable);
+
+            // Split each long video into this many segments of time, each
+            //  analyzed on its own processor, and match the worms up across
+            //  their boundaries afterwards. Zero or one doesn't, which is the
+            //  default...
+            void                SetSegments(unsigned int const _unSegments);
+
+    // Protected constants...
+    protected:
+
+        // Most frames to sample when calibrating a video, spread evenly
+        //  through it...
+        enum { MAXIMUM_CALIBRATION_FRAMES = 32 };
+
+        // Frames each segment tracks before its stretch, twice as many as a
+        //  worm may go missing for so that both trackers know every worm at
+        //  the boundary. Then the fewest frames worth a segment of their
+        //  own, and how often to check for a cancel while waiting on them...
+        enum
+        {
+            SEGMENT_OVERLAP_FRAMES      = 30,
+            MINIMUM_SEGMENT_FRAMES      = 4 * SEGMENT_OVERLAP_FRAMES,
+            SEGMENT_POLL_MILLISECONDS   = 100
+        };
+
+    // Protected types...
+    protected:
+
+        // A worm at the end of one segment that could be a worm at the end of
+        //  the next's overlap, and how far apart their centres are...
+        typedef struct SegmentPairing
+        {
+            // Distance between their centres, in pixels...
+            double          dDistance;
+
+            // Indices into the segment before's tracking table and the
+            //  segment after's overlap snapshot...
+            unsigned int    unBefore;
+            unsigned int    unAfter;
+
+            // Order by distance, closest first...
+            bool operator<(SegmentPairing const &Other) const
+            {
+                return dDistance < Other.dDistance;
+            }
+
+        }SegmentPairing;
+
+    // Protected methods...
+    protected:
+
+        // Accessors...
+
+            // Has our owner asked us to stop?
+            bool                IsCancelled() const;
+
+        // Mutators...
+
+            // Decode and track only the video's keyframes, or every so many
+            //  of them. False on error...
+            bool                AnalyzeVideoKeyframes(
+                                    string const &sPath,
+                                    cv::VideoCapture &Capture);
+
+            // Split the video into segments of time, each tracked on its
+            //  own thread with its own capture and tracker, and reconcile
+            //  them. False on error...
+            bool                AnalyzeVideoSegmented(
+                                    string const &sPath,
+                                    unsigned int const unTrackedFrames,
+                                    unsigned int const unSegmentsUsed);
+
+            // Decode on a separate thread while we track on this one. False
+            //  if the decoder could not be started...
+            bool                AnalyzeVideoPipelined(
+                                    cv::VideoCapture &Capture);
+
+            // Pick the tracker's threshold and candidate size window from a 
+            //  sample of the video's frames, stopping as soon as the estimate
+            //  converges, and then rewind it. False if it couldn't be 
+            //  rewound...
+            bool                CalibrateVideo(
+                                    string const &sPath,
+                                    cv::VideoCapture &Capture);
+
+            // Decode and track each frame in turn on this thread...
+            void                AnalyzeVideoSerially(
+                                    cv::VideoCapture &Capture);
+
+            // Match each segment's worms at the end of its overlap with those
+            //  the segment before was still tracking at the same frame, and
+            //  combine the measurements and any time series of each worm so
+            //  matched, leaving out the overlapping frames counted twice...
+            void                ReconcileSegments(
+                                    vector<VideoSegment *> const &Segments);
+
+            // Convert a decoded frame into the 8-bit grayscale the tracker
+            //  prefers...
+            static void         ConvertToGray(
+                                    cv::Mat const &OriginalImage,
+                                    cv::Mat &GrayImage);
+
+            // Read the next frame, after grabbing without converting the
+            //  given number of frames before it. False if there are no
+            //  more...
+            static bool         ReadFrame(
+                                    cv::VideoCapture &Capture,
+                                    cv::Mat &OriginalImage,
+                                    unsigned int const unSkip,
+                                    DecodeSavings &Savings);
+
+    // Protected attributes...
+    protected:
+
+        // The tracker we are feeding...
+        WormTracker        &Tracker;
+
+        // The thread we are running within, if any...
+        wxThread           *pOwnerThread;
+
+        // Grayscale frame buffer, reused between frames...
+        cv::Mat             GrayImage;
+
+        // Number of decoded frames that may wait for the tracker...
+        unsigned int        unFrameQueueDepth;
+
+        // How much the decoder and tracker waited on each other...
+        FrameQueueStalls    PipelineStalls;
+
+        // Frames to advance by each time, whether only keyframes are
+        //  decoded, and how much decoding that avoided...
+        unsigned int        unFrameStride;
+        bool                bKeyframesOnly;
+        DecodeSavings       Savings;
+
+        // Number of segments to split each long video into, or zero or one
+        //  for none, whether the media last analyzed was, and if so the
+        //  measurements and time series reconciled across them, and whether
+        //  the latter could all be read back...
+        unsigned int                    unSegments;
+        bool                            bSegmented;
+        vector<WormMeasurement>         SegmentedMeasurements;
+        vector<vector<WormSample> >     SegmentedTimeSeries;
+        bool                            bSegmentedTimeSeriesRead;
+
+        // Description of the last error encountered...
+        string              sLastError;
+};
+
+#endif
+
@@ -0,0 +1,364 @@
+/*
+  Name:         MorphologyFilter.cpp (implementation)
+  Author:       Kip Warner (Kip@TheVertigo.com)
+  Description:  MorphologyFilter class. Opens a grayscale image with a square
+                kernel and thresholds it in one go, at a cost per pixel that
+                doesn't grow with the kernel...
+*/
+
+// Includes...
+#include "MorphologyFilter.h"
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+#include <cstring>
+
+// The two halves of an opening, a pixel or a vector of pixels at a time. Each
+//  has an identity that never wins, which stands in for pixels off the image
+//  as OpenCV's default border does...
+
+    // Erosion takes the darkest pixel under the kernel...
+    typedef struct Minimum
+    {
+        enum { Identity = 0xff };
+        static unsigned char Apply(unsigned char const ucFirst,
+                                   unsigned char const ucSecond)
+        {
+            return ucFirst < ucSecond ? ucFirst : ucSecond;
+        }
+        #if CV_SIMD
+        static cv::v_uint8 Apply(cv::v_uint8 const &First,
+                                 cv::v_uint8 const &Second)
+        {
+            return cv::v_min(First, Second);
+        }
+        #endif
+    }Minimum;
+
+    // Dilation takes the brightest...
+    typedef struct Maximum
+    {
+        enum { Identity = 0x00 };
+        static unsigned char Apply(unsigned char const ucFirst,
+                                   unsigned char const ucSecond)
+        {
+            return ucFirst > ucSecond ? ucFirst : ucSecond;
+        }
+        #if CV_SIMD
+        static cv::v_uint8 Apply(cv::v_uint8 const &First,
+                                 cv::v_uint8 const &Second)
+        {
+            return cv::v_max(First, Second);
+        }
+        #endif
+    }Maximum;
+
+// Combine two rows element by element. Nothing depends on its neighbour, so
+//  this goes a whole vector at a time with OpenCV's universal intrinsics, on
+//  whatever instruction set it was built for...
+template <typename Operation>
+static inline void CombineRows(
+    unsigned char const *pFirst, unsigned char const *pSecond,
+    unsigned char *pOutput, int const nWidth)
+{
+    // Variables...
+    int nColumn = 0;
+
+    // A vector at a time, while there are enough left...
+    #if CV_SIMD
+    for(; nColumn + CV_SIMD_WIDTH <= nWidth; nColumn += CV_SIMD_WIDTH)
+        cv::v_store(pOutput + nColumn,
+                    Operation::Apply(cv::vx_load(pFirst + nColumn),
+                                     cv::vx_load(pSecond + nColumn)));
+    #endif
+
+    // ...then the rest one at a time...
+    for(; nColumn < nWidth; ++nColumn)
+        pOutput[nColumn] = Operation::Apply(pFirst[nColumn], pSecond[nColumn]);
+}
+
+// Combine two rows element by element as above, and threshold the result
+//  straight into the output...
+template <typename Operation>
+static inline void CombineAndThresholdRows(
+    unsigned char const *pFirst, unsigned char const *pSecond,
+    unsigned char *pOutput, int const nWidth,
+    unsigned char const ucThreshold, unsigned char const ucMaximumValue)
+{
+    // Variables...
+    int nColumn = 0;
+
+    // A vector at a time, while there are enough left...
+    #if CV_SIMD
+    cv::v_uint8 const Threshold     = cv::vx_setall_u8(ucThreshold);
+    cv::v_uint8 const MaximumValue  = cv::vx_setall_u8(ucMaximumValue);
+    for(; nColumn + CV_SIMD_WIDTH <= nWidth; nColumn += CV_SIMD_WIDTH)
+        cv::v_store(pOutput + nColumn,
+                    (Operation::Apply(cv::vx_load(pFirst + nColumn),
+                                      cv::vx_load(pSecond + nColumn)) >
+                     Threshold) & MaximumValue);
+    #endif
+
+    // ...then the rest one at a time...
+    for(; nColumn < nWidth; ++nColumn)
+        pOutput[nColumn] =
+            Operation::Apply(pFirst[nColumn], pSecond[nColumn]) > ucThreshold ?
+                ucMaximumValue : 0;
+}
+
+// Default constructor...
+MorphologyFilter::MorphologyFilter()
+{
+
+}
+
+// Open a region of an 8-bit grayscale image with a square kernel and threshold
+//  it into the same region of an 8-bit binary image of the same size...
+void MorphologyFilter::OpenAndThreshold(
+    cv::Mat const &GrayImage,
+    cv::Rect const &Region,
+    unsigned int const unKernelSize,
+    unsigned int const unThreshold,
+    unsigned int const unMaximumValue,
+    cv::Mat &BinaryImage)
+{
+    // Variables...
+    cv::Rect const  Frame(0, 0, GrayImage.cols, GrayImage.rows);
+    int const       nKernel = std::max((int) unKernelSize, 1);
+    int const       nBefore = nKernel / 2;
+
+    // Both images must be 8-bit, single channel, and the same size...
+    CV_Assert(GrayImage.type() == CV_8UC1 && BinaryImage.type() == CV_8UC1);
+    CV_Assert(GrayImage.size() == BinaryImage.size());
+
+        // Nothing to do...
+        if(Region.area() <= 0)
+            return;
+
+    // The kernel's anchor is its centre, so each pixel's window reaches
+    //  nBefore pixels back and the rest of the kernel forward. Dilating the
+    //  region needs the eroded pixels that far around it, and eroding those
+    //  needs the gray pixels that far around them again, all on the image...
+    cv::Rect const ErodedArea =
+        cv::Rect(Region.x - nBefore, Region.y - nBefore,
+                 Region.width + nKernel - 1, Region.height + nKernel - 1) &
+        Frame;
+    cv::Rect const GrayArea =
+        cv::Rect(ErodedArea.x - nBefore, ErodedArea.y - nBefore,
+                 ErodedArea.width + nKernel - 1,
+                 ErodedArea.height + nKernel - 1) &
+        Frame;
+
+    // Make room. These only ever grow...
+    size_t const nAcrossRows = (size_t) GrayArea.height * ErodedArea.width;
+    if(AcrossRows.size() < nAcrossRows)
+        AcrossRows.resize(nAcrossRows);
+    if(Eroded.size() < (size_t) ErodedArea.area())
+        Eroded.resize(ErodedArea.area());
+
+    // Erode across the rows of the gray pixels...
+    SlideAlongRows<Minimum>(
+        GrayImage.ptr<unsigned char>(GrayArea.y) + GrayArea.x, GrayImage.step,
+        GrayArea.x, GrayArea.br().x,
+        ErodedArea.x, ErodedArea.br().x,
+        GrayArea.height, nBefore, nKernel,
+        &AcrossRows[0], ErodedArea.width);
+
+    // ...then down their columns...
+    SlideDownColumns<Minimum>(
+        &AcrossRows[0], ErodedArea.width,
+        GrayArea.y, GrayArea.br().y,
+        ErodedArea.y, ErodedArea.br().y,
+        ErodedArea.width, nBefore, nKernel,
+        &Eroded[0], ErodedArea.width,
+        false, 0, 0);
+
+    // Dilate across the rows of the eroded pixels...
+    SlideAlongRows<Maximum>(
+        &Eroded[0], ErodedArea.width,
+        ErodedArea.x, ErodedArea.br().x,
+        Region.x, Region.br().x,
+        ErodedArea.height, nBefore, nKernel,
+        &AcrossRows[0], Region.width);
+
+    // ...then down their columns, thresholding straight into the region. A
+    //  threshold or maximum value beyond eight bits saturates, as OpenCV's
+    //  does...
+    SlideDownColumns<Maximum>(
+        &AcrossRows[0], Region.width,
+        ErodedArea.y, ErodedArea.br().y,
+        Region.y, Region.br().y,
+        Region.width, nBefore, nKernel,
+        BinaryImage.ptr<unsigned char>(Region.y) + Region.x, BinaryImage.step,
+        true,
+        (unsigned char) std::min(unThreshold, 255U),
+        (unsigned char) std::min(unMaximumValue, 255U));
+}
+
+// Slide a window of the given size along the rows of a buffer, taking the
+//  minimum or maximum under it as van Herk and Gil-Werman do. The input covers
+//  columns nInputStart up to nInputEnd and the output nOutputStart up to
+//  nOutputEnd, both in image coordinates. Windows are split at multiples of
+//  the kernel size into a running result from the end of one block and one
+//  from the start of the next, so each output costs three operations... θ(n)
+template <typename Operation>
+void MorphologyFilter::SlideAlongRows(
+    unsigned char const *pInput,
+    int const nInputStride,
+    int const nInputStart,
+    int const nInputEnd,
+    int const nOutputStart,
+    int const nOutputEnd,
+    int const nRows,
+    int const nBefore,
+    int const nKernel,
+    unsigned char *pOutput,
+    int const nOutputStride)
+{
+    // Variables...
+    int const   nOutputs    = nOutputEnd - nOutputStart;
+    int const   nPadded     = nOutputs + nKernel - 1;
+    int const   nFirst      = nOutputStart - nBefore;
+
+    // The windows cover the padded row, and whatever part of that is off the
+    //  input is the identity. That part is the same for every row...
+    int const   nCopyStart  = std::max(nFirst, nInputStart);
+    int const   nCopyEnd    = std::min(nFirst + nPadded, nInputEnd);
+    if((int) RowScratch.size() < 3 * nPadded)
+        RowScratch.resize(3 * nPadded);
+    unsigned char *pPadded      = &RowScratch[0];
+    unsigned char *pFromStart   = pPadded + nPadded;
+    unsigned char *pFromEnd     = pFromStart + nPadded;
+    std::fill(pPadded, pPadded + nPadded, (unsigned char) Operation::Identity);
+
+    // Each row...
+    for(int nRow = 0; nRow < nRows; ++nRow)
+    {
+        // Copy in the part that is on the input...
+        if(nCopyEnd > nCopyStart)
+            memcpy(pPadded + nCopyStart - nFirst,
+                   pInput + nRow * nInputStride + nCopyStart - nInputStart,
+                   nCopyEnd - nCopyStart);
+
+        // Running results from either end of each block...
+        for(int nBlock = 0; nBlock < nPadded; nBlock += nKernel)
+        {
+            // Where the block ends...
+            int const nBlockEnd = std::min(nBlock + nKernel, nPadded);
+
+            // From its start...
+            pFromStart[nBlock] = pPadded[nBlock];
+            for(int nIndex = nBlock + 1; nIndex < nBlockEnd; ++nIndex)
+                pFromStart[nIndex] =
+                    Operation::Apply(pFromStart[nIndex - 1], pPadded[nIndex]);
+
+            // From its end...
+            pFromEnd[nBlockEnd - 1] = pPadded[nBlockEnd - 1];
+            for(int nIndex = nBlockEnd - 2; nIndex >= nBlock; --nIndex)
+                pFromEnd[nIndex] =
+                    Operation::Apply(pFromEnd[nIndex + 1], pPadded[nIndex]);
+        }
+
+        // Each window is whatever is left of its first block and whatever it
+        //  takes of the next...
+        CombineRows<Operation>(pFromEnd, pFromStart + nKernel - 1,
+                               pOutput + nRow * nOutputStride, nOutputs);
+    }
+}
+
+// Slide a window of the given size down the columns of a buffer. The input
+//  covers rows nInputStart up to nInputEnd and the output nOutputStart up to
+//  nOutputEnd, both in image coordinates. This is the same as along the rows,
+//  but with whole rows as the elements, and only one block of running results
+//  from either end kept at a time... θ(n)
+template <typename Operation>
+void MorphologyFilter::SlideDownColumns(
+    unsigned char const *pInput,
+    int const nInputStride,
+    int const nInputStart,
+    int const nInputEnd,
+    int const nOutputStart,
+    int const nOutputEnd,
+    int const nWidth,
+    int const nBefore,
+    int const nKernel,
+    unsigned char *pOutput,
+    int const nOutputStride,
+    bool const bThreshold,
+    unsigned char const ucThreshold,
+    unsigned char const ucMaximumValue)
+{
+    // Variables...
+    int const   nOutputs    = nOutputEnd - nOutputStart;
+    int const   nPadded     = nOutputs + nKernel - 1;
+    int const   nFirst      = nOutputStart - nBefore;
+
+    // Point each padded row at its input row, or at the identity if it is off
+    //  the input...
+    IdentityRow.assign(nWidth, (unsigned char) Operation::Identity);
+    PaddedRows.resize(nPadded);
+    for(int nIndex = 0; nIndex < nPadded; ++nIndex)
+    {
+        int const nRow = nFirst + nIndex;
+        PaddedRows[nIndex] = (nRow >= nInputStart && nRow < nInputEnd) ?
+            pInput + (nRow - nInputStart) * nInputStride : &IdentityRow[0];
+    }
+
+    // A block of running results from the end of the current block, and from
+    //  the start of the next...
+    if((int) BlockScratch.size() < 2 * nKernel * nWidth)
+        BlockScratch.resize(2 * nKernel * nWidth);
+    unsigned char *pFromEnd     = &BlockScratch[0];
+    unsigned char *pFromStart   = pFromEnd + nKernel * nWidth;
+
+    // Each block of windows...
+    for(int nBlock = 0; nBlock < nOutputs; nBlock += nKernel)
+    {
+        // Windows starting in this block, and the last row they reach...
+        int const nWindowsEnd   = std::min(nBlock + nKernel, nOutputs);
+        int const nReach        = nWindowsEnd - 1 + nKernel - 1;
+
+        // Running results from the end of this block, which is always whole
+        //  since every window starting in it fits...
+        memcpy(pFromEnd + (nKernel - 1) * nWidth,
+               PaddedRows[nBlock + nKernel - 1], nWidth);
+        for(int nIndex = nKernel - 2; nIndex >= 0; --nIndex)
+            CombineRows<Operation>(pFromEnd + (nIndex + 1) * nWidth,
+                                   PaddedRows[nBlock + nIndex],
+                                   pFromEnd + nIndex * nWidth, nWidth);
+
+        // Running results from the start of the next block, as far as this
+        //  block's windows reach...
+        for(int nRow = nBlock + nKernel; nRow <= nReach; ++nRow)
+        {
+            unsigned char *pRow =
+                pFromStart + (nRow - nBlock - nKernel) * nWidth;
+            if(nRow == nBlock + nKernel)
+                memcpy(pRow, PaddedRows[nRow], nWidth);
+            else
+                CombineRows<Operation>(pRow - nWidth, PaddedRows[nRow], pRow,
+                                       nWidth);
+        }
+
+        // Each window in this block. The first is exactly the block...
+        for(int nWindow = nBlock; nWindow < nWindowsEnd; ++nWindow)
+        {
+            // Whatever is left of this block and whatever it takes of the
+            //  next...
+            unsigned char const *pLeft  =
+                pFromEnd + (nWindow - nBlock) * nWidth;
+            unsigned char const *pRight = (nWindow == nBlock) ? pLeft :
+                pFromStart + (nWindow - nBlock - 1) * nWidth;
+            unsigned char *pRow = pOutput + nWindow * nOutputStride;
+
+            // Threshold straight into the output...
+            if(bThreshold)
+                CombineAndThresholdRows<Operation>(
+                    pLeft, pRight, pRow, nWidth, ucThreshold, ucMaximumValue);
+
+            // Or just store...
+            else
+                CombineRows<Operation>(pLeft, pRight, pRow, nWidth);
+        }
+    }
+}
+
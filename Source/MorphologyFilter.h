@@ -0,0 +1,111 @@
+/*
+  Name:         MorphologyFilter.h (definition)
+  Author:       Kip Warner (Kip@TheVertigo.com)
+  Description:  MorphologyFilter class. Opens a grayscale image with a square
+                kernel and thresholds it in one go, at a cost per pixel that
+                doesn't grow with the kernel...
+*/
+
+// Multiple include protection...
+#ifndef _MORPHOLOGYFILTER_H_
+#define _MORPHOLOGYFILTER_H_
+
+// Includes...
+
+    // OpenCV...
+    #include <opencv2/core/core.hpp>
+
+    // Standard libraries and STL...
+    #include <vector>
+
+    // Using the standard namespace...
+    using namespace std;
+
+// MorphologyFilter class...
+class MorphologyFilter
+{
+    // Public methods...
+    public:
+
+        // Default constructor...
+        MorphologyFilter();
+
+        // Mutators...
+
+            // Open a region of an 8-bit grayscale image with a square kernel
+            //  and threshold it into the same region of an 8-bit binary image
+            //  of the same size. The result is identical to cv::erode(), then
+            //  cv::dilate(), then cv::threshold() with THRESH_BINARY, using a
+            //  rectangular kernel and the default anchor and border. Pixels
+            //  outside the region but on the image are read as needed, so a
+            //  region gives the same pixels as the whole image would. θ(n)
+            //  in pixels, whatever the kernel size...
+            void                OpenAndThreshold(
+                                    cv::Mat const &GrayImage,
+                                    cv::Rect const &Region,
+                                    unsigned int const unKernelSize,
+                                    unsigned int const unThreshold,
+                                    unsigned int const unMaximumValue,
+                                    cv::Mat &BinaryImage);
+
+    // Protected methods...
+    protected:
+
+        // Slide a window of the given size along the rows of a buffer, taking
+        //  the minimum or maximum under it as van Herk and Gil-Werman do...
+        template <typename Operation>
+        void                    SlideAlongRows(
+                                    unsigned char const *pInput,
+                                    int const nInputStride,
+                                    int const nInputStart,
+                                    int const nInputEnd,
+                                    int const nOutputStart,
+                                    int const nOutputEnd,
+                                    int const nRows,
+                                    int const nBefore,
+                                    int const nKernel,
+                                    unsigned char *pOutput,
+                                    int const nOutputStride);
+
+        // Slide a window of the given size down the columns of a buffer. The
+        //  rows are whole vectors, so each step works across a whole row at
+        //  once. Optionally threshold on the way out...
+        template <typename Operation>
+        void                    SlideDownColumns(
+                                    unsigned char const *pInput,
+                                    int const nInputStride,
+                                    int const nInputStart,
+                                    int const nInputEnd,
+                                    int const nOutputStart,
+                                    int const nOutputEnd,
+                                    int const nWidth,
+                                    int const nBefore,
+                                    int const nKernel,
+                                    unsigned char *pOutput,
+                                    int const nOutputStride,
+                                    bool const bThreshold,
+                                    unsigned char const ucThreshold,
+                                    unsigned char const ucMaximumValue);
+
+    // Protected attributes...
+    protected:
+
+        // The image after each half of the opening has been applied across
+        //  its rows, and after the erosion has been applied down its columns.
+        //  Each is only as big as the region plus the kernel's reach...
+        vector<unsigned char>           AcrossRows;
+        vector<unsigned char>           Eroded;
+
+        // One padded row with its running minima or maxima from either end of
+        //  each block, a block's worth of rows of each of those going down the
+        //  columns, and the input rows those are taken from. A row of the
+        //  operation's identity stands in for rows off the image. All of these
+        //  only ever grow, so filtering every frame doesn't allocate...
+        vector<unsigned char>           RowScratch;
+        vector<unsigned char>           BlockScratch;
+        vector<unsigned char const *>   PaddedRows;
+        vector<unsigned char>           IdentityRow;
+};
+
+#endif
+
@@ -0,0 +1,116 @@
+/*
+  Name:         Outline.cpp (implementation)
+  Author:       Kip Warner (Kip@TheVertigo.com)
+  Description:  Outline class. A closed contour stored as a flat array of
+                vertices, with its bounding rectangle and moments cached
+                alongside...
+*/
+
+// Includes...
+#include "Outline.h"
+#include <cassert>
+#include <cmath>
+
+// Default constructor...
+Outline::Outline()
+    : Bounds(0, 0, 0, 0)
+{
+
+}
+
+// Area enclosed, in pixels². θ(1)
+double Outline::Area() const
+{
+    // The zeroth moment is the area...
+    return fabs(SpatialMoments.m00);
+}
+
+// Take the given vertices by swapping them in, and hand back our old ones so
+//  the caller can reuse their storage...
+void Outline::Assign(vector<cv::Point> &NewPoints)
+{
+    // Swap...
+    Points.swap(NewPoints);
+
+    // Update the bounding rectangle and moments...
+    if(!Points.empty())
+    {
+        Bounds          = cv::boundingRect(Points);
+        SpatialMoments  = cv::moments(Points);
+    }
+
+    // Nothing to bound...
+    else
+    {
+        Bounds          = cv::Rect(0, 0, 0, 0);
+        SpatialMoments  = cv::Moments();
+    }
+}
+
+// Bounding rectangle. θ(1)
+cv::Rect const &Outline::BoundingRectangle() const
+{
+    // Return it...
+    return Bounds;
+}
+
+// Centre of gravity, or the centre of the bounding rectangle if the outline
+//  encloses no area. θ(1)
+CvPoint Outline::Centre() const
+{
+    // Degenerate outline, such as a line...
+    if(SpatialMoments.m00 == 0.0)
+        return cvPoint(Bounds.x + Bounds.width / 2,
+                       Bounds.y + Bounds.height / 2);
+
+    // Extract the centre of gravity...
+    return cvPoint(int(SpatialMoments.m10 / SpatialMoments.m00),
+                   int(SpatialMoments.m01 / SpatialMoments.m00));
+}
+
+// Is the given point inside (> 0), on (0), or outside (< 0)? θ(n)
+double Outline::Contains(CvPoint2D32f const &Point) const
+{
+    // Test...
+    return cv::pointPolygonTest(Points, cv::Point2f(Point.x, Point.y), false);
+}
+
+// Spatial moments. θ(1)
+cv::Moments const &Outline::Moments() const
+{
+    // Return them...
+    return SpatialMoments;
+}
+
+// Length all the way around. θ(n)
+double Outline::Perimeter() const
+{
+    // Measure as closed...
+    return cv::arcLength(Points, true);
+}
+
+// Number of vertices. θ(1)
+unsigned int Outline::Size() const
+{
+    // Return it...
+    return Points.size();
+}
+
+// Get the vertex at the given index. θ(1)
+CvPoint Outline::Vertex(unsigned int const unIndex) const
+{
+    // This should never happen, so we make sure...
+    assert(unIndex < Points.size());
+
+    // Find the actual vertex and return it...
+    cv::Point const &Point = Points[unIndex];
+    return cvPoint(Point.x, Point.y);
+}
+
+// All of the vertices, contiguous...
+vector<cv::Point> const &Outline::Vertices() const
+{
+    // Return them...
+    return Points;
+}
+
@@ -0,0 +1,86 @@
+/*
+  Name:         Outline.h (definition)
+  Author:       Kip Warner (Kip@TheVertigo.com)
+  Description:  Outline class. A closed contour stored as a flat array of
+                vertices, with its bounding rectangle and moments cached
+                alongside...
+*/
+
+// Multiple include protection...
+#ifndef _OUTLINE_H_
+#define _OUTLINE_H_
+
+// Includes...
+
+    // OpenCV...
+    #include <opencv2/core/core.hpp>
+    #include <opencv2/core/types_c.h>
+    #include <opencv2/imgproc.hpp>
+
+    // Standard libraries and STL...
+    #include <vector>
+
+    // Using the standard namespace...
+    using namespace std;
+
+// Outline class...
+class Outline
+{
+    // Public methods...
+    public:
+
+        // Default constructor...
+        Outline();
+
+        // Accessors...
+
+            // Area enclosed, in pixels². θ(1)
+            double                      Area() const;
+
+            // Bounding rectangle. θ(1)
+            cv::Rect const             &BoundingRectangle() const;
+
+            // Centre of gravity, or the centre of the bounding rectangle if
+            //  the outline encloses no area. θ(1)
+            CvPoint                     Centre() const;
+
+            // Is the given point inside (> 0), on (0), or outside (< 0)? θ(n)
+            double                      Contains(
+                                            CvPoint2D32f const &Point) const;
+
+            // Spatial moments. θ(1)
+            cv::Moments const          &Moments() const;
+
+            // Length all the way around. θ(n)
+            double                      Perimeter() const;
+
+            // Number of vertices. θ(1)
+            unsigned int                Size() const;
+
+            // Get the vertex at the given index. θ(1)
+            CvPoint                     Vertex(
+                                            unsigned int const unIndex) const;
+
+            // All of the vertices, contiguous...
+            vector<cv::Point> const    &Vertices() const;
+
+        // Mutators...
+
+            // Take the given vertices by swapping them in, and hand back our
+            //  old ones so the caller can reuse their storage. θ(n) to update
+            //  the bounding rectangle and moments...
+            void                        Assign(vector<cv::Point> &NewPoints);
+
+    // Protected attributes...
+    protected:
+
+        // Vertices, in order around the outline...
+        vector<cv::Point>   Points;
+
+        // Cached bounding rectangle and moments...
+        cv::Rect            Bounds;
+        cv::Moments         SpatialMoments;
+};
+
+#endif
+
@@ -0,0 +1,713 @@
+/*
+  Name:         SlitherBatch.cpp (implementation)
+  Author:       Kip Warner (Kip@TheVertigo.com)
+  Description:  Headless batch analysis of many videos or images from the
+                command line, without any user interface...
+*/
+
+// Includes...
+
+    // Headless media analysis across many threads...
+    #include "AnalysisScheduler.h"
+
+    // Which instruction set the batched geometry routines run on...
+    #include "SlitherMath.h"
+
+    // Application version...
+    #include "Version.h"
+
+    // wxWidgets initialization without an application object...
+    #include <wx/init.h>
+
+    // Standard C++ / POSIX headers...
+    #include <cctype>
+    #include <cerrno>
+    #include <climits>
+    #include <cstdlib>
+    #include <fstream>
+    #include <getopt.h>
+    #include <iomanip>
+    #include <iostream>
+    #include <string>
+    #include <vector>
+
+// Use the standard name space...
+using namespace std;
+
+// Artificial intelligence magic numbers and flags, defaulting to the same
+//  values as the user interface...
+typedef struct BatchSettings
+{
+    // Inline constructor initializer...
+    BatchSettings()
+        : unThreshold(150),
+          unMaxThresholdValue(255),
+          unMinimumCandidateSize(50),
+          unMaximumCandidateSize(120),
+          bInletDetection(true),
+          unMorphologySize(5),
+          bAutoCalibration(false),
+          CalibrationMethod(ThresholdCalibrator::TRIANGLE),
+          unBackgroundScale(0),
+          unBackgroundLearning(6),
+          unRescanInterval(0),
+          unTileRows(0),
+          unCoarseScale(0),
+          fFieldOfViewDiameter(5.0f),
+          unJobs(0),
+          unFrameStride(1),
+          bKeyframesOnly(false),
+          unSegments(0),
+          unFrameQueueDepth(MediaAnalyzer::DEFAULT_FRAME_QUEUE_DEPTH),
+          bReportStalls(false),
+          bReferenceMode(false)
+    {
+    }
+
+    // Threshold and maximum threshold value...
+    unsigned int    unThreshold;
+    unsigned int    unMaxThresholdValue;
+
+    // Candidate size window, in thousandths of a millimeter²...
+    unsigned int    unMinimumCandidateSize;
+    unsigned int    unMaximumCandidateSize;
+
+    // Inlet detection and its morphology kernel size...
+    bool            bInletDetection;
+    unsigned int    unMorphologySize;
+
+    // Whether to pick the threshold and candidate size window for each media
+    //  automatically, and how...
+    bool                        bAutoCalibration;
+    ThresholdCalibrator::Method CalibrationMethod;
+
+    // Reduction of the background model on each side, or zero for none, and
+    //  how quickly it learns as a power of two...
+    unsigned int    unBackgroundScale;
+    unsigned int    unBackgroundLearning;
+
+    // Frames between rescans of the whole frame, or zero for every frame...
+    unsigned int    unRescanInterval;
+
+    // Rows in each tile segmented in parallel, or zero for none...
+    unsigned int    unTileRows;
+
+    // Reduction to find where to look on full frame scans, or zero for 
+    //  none...
+    unsigned int    unCoarseScale;
+
+    // Microscope field of view diameter in millimeters...
+    float           fFieldOfViewDiameter;
+
+    // Number of media to analyze at once, or zero for one per processor...
+    unsigned int    unJobs;
+
+    // Frames to advance by through each video, and whether to decode only
+    //  its keyframes...
+    unsigned int    unFrameStride;
+    bool            bKeyframesOnly;
+
+    // Segments of time to split each long video into, analyzed side by side,
+    //  or zero for none...
+    unsigned int    unSegments;
+
+    // Decoded frames that may wait for the tracker, and whether to report how
+    //  much the decoder and tracker waited on each other...
+    unsigned int    unFrameQueueDepth;
+    bool            bReportStalls;
+
+    // Use the slower reference algorithms, to validate the faster ones...
+    bool            bReferenceMode;
+
+}BatchSettings;
+
+// Display usage...
+static void ShowUsage(char const *pszProgram)
+{
+    cout << "Usage: " << pszProgram << " [OPTIONS] [MEDIA]..." << endl
+         << endl
+         << "Analyze each video or image for worm body size without a user"
+            " interface." << endl
+         << endl
+         << "  -f, --field-of-view=MM         field of view diameter"
+            " (default 5)" << endl
+         << "  -t, --threshold=N              image threshold (default 150)"
+         << endl
+         << "  -m, --max-threshold-value=N    maximum threshold value"
+            " (default 255)" << endl
+         << "  -n, --minimum-size=N           minimum candidate size"
+            " (default 50)" << endl
+         << "  -x, --maximum-size=N           maximum candidate size"
+            " (default 120)" << endl
+         << "  -s, --morphology-size=N        inlet correction kernel size"
+            " (default 5)" << endl
+         << "  -d, --no-inlet-detection       disable inlet detection" << endl
+         << "  -a, --auto-calibrate=METHOD    pick the threshold and candidate"
+            " sizes for each" << endl
+         << "                                 media by otsu or triangle"
+            " method" << endl
+         << "  -b, --background-scale=N       flatten uneven illumination"
+            " against a" << endl
+         << "                                 background learnt at 1/N"
+            " resolution (default 0, off)" << endl
+         << "  -B, --background-learning=N    learn 1/2^N of each frame into"
+            " the background" << endl
+         << "                                 (default 6)" << endl
+         << "  -i, --rescan-interval=N        search only around known worms,"
+            " rescanning" << endl
+         << "                                 the whole frame every N frames"
+            " (default 0, always)" << endl
+         << "  -T, --tile-rows=N              segment each frame in tiles of N"
+            " rows, in" << endl
+         << "                                 parallel (default 0, untiled)"
+         << endl
+         << "  -c, --coarse-scale=N           find where to look on full frame"
+            " scans at 1/N" << endl
+         << "                                 resolution first (default 0,"
+            " off)" << endl
+         << "  -j, --jobs=N                   analyze N media at once"
+            " (default one per processor)" << endl
+         << "  -S, --frame-stride=N           track every Nth frame of each"
+            " video, grabbing" << endl
+         << "                                 the rest without converting"
+            " them (default 1)" << endl
+         << "  -K, --keyframes-only           decode and track only each"
+            " video's keyframes," << endl
+         << "                                 or every Nth of them with"
+            " --frame-stride" << endl
+         << "  -k, --segments=N               split each long video into N"
+            " segments analyzed" << endl
+         << "                                 side by side (default 0, none)"
+         << endl
+         << "  -q, --queue-depth=N            decoded frames that may wait for"
+            " the tracker," << endl
+         << "                                 or 0 to decode and track in turn"
+            " (default 8)" << endl
+         << "  -r, --report-stalls            report decoder and tracker"
+            " stalls, time in each" << endl
+         << "                                 tracker stage, and frames"
+            " skipped, for each media" << endl
+         << "  -R, --reference                use the slower reference"
+            " algorithms, for validation" << endl
+         << "  -l, --list=FILE                read media paths from FILE, one"
+            " per line" << endl
+         << "  -o, --output=FILE              write results to FILE instead"
+            " of standard output" << endl
+         << "  -e, --time-series=FILE         also write every worm's"
+            " measurements from every" << endl
+         << "                                 frame it was seen in to FILE,"
+            " in pixels" << endl
+         << "  -P, --posture=FILE             also write every worm's posture"
+            " from every frame" << endl
+         << "                                 its midline was traced in to"
+            " FILE" << endl
+         << "  -p, --posture-basis=FILE       project each posture onto the"
+            " modes in FILE, each" << endl
+         << "                                 of " << Worm::POSTURE_ANGLES
+         << " tangent angles, up to " << Worm::MAXIMUM_POSTURE_MODES
+         << " modes" << endl
+         << "  -h, --help                     display this help" << endl
+         << "  -v, --version                  print version" << endl;
+}
+
+// Parse an unsigned integral option argument, or die trying...
+static unsigned int ParseUnsigned(char const *pszOption, char const *pszValue)
+{
+    // Variables...
+    char       *pszEnd      = NULL;
+    char const *pszDigits   = pszValue;
+
+    // strtoul(3) would wrap a negative value around, so find its sign...
+    while(isspace((unsigned char) *pszDigits))
+      ++pszDigits;
+
+    // Convert...
+    errno = 0;
+    unsigned long const ulValue = strtoul(pszValue, &pszEnd, 10);
+
+        // Garbage, negative, or too big...
+        if(!*pszValue || *pszEnd || *pszDigits == '-' || errno == ERANGE ||
+           ulValue > UINT_MAX)
+        {
+            // Alert and abort...
+            cerr << "slither-batch: invalid value for " << pszOption << ": "
+                 << pszValue << endl;
+            exit(EXIT_FAILURE);
+        }
+
+    // Done...
+    return (unsigned int) ulValue;
+}
+
+// Entry point...
+int main(int nArguments, char *ppszArguments[])
+{
+    // Variables...
+    BatchSettings       Settings;
+    vector<string>      MediaPaths;
+    string              sOutputPath;
+    string              sTimeSeriesPath;
+    string              sPosturePath;
+    vector<float>       PostureBasis;
+    int                 nOption         = 0;
+    bool                bAllSucceeded   = true;
+
+    // Long options...
+    static struct option const LongOptions[] =
+    {
+        {"field-of-view",       required_argument,  NULL, 'f'},
+        {"threshold",           required_argument,  NULL, 't'},
+        {"max-threshold-value", required_argument,  NULL, 'm'},
+        {"minimum-size",        required_argument,  NULL, 'n'},
+        {"maximum-size",        required_argument,  NULL, 'x'},
+        {"morphology-size",     required_argument,  NULL, 's'},
+        {"no-inlet-detection",  no_argument,        NULL, 'd'},
+        {"auto-calibrate",      required_argument,  NULL, 'a'},
+        {"background-scale",    required_argument,  NULL, 'b'},
+        {"background-learning", required_argument,  NULL, 'B'},
+        {"rescan-interval",     required_argument,  NULL, 'i'},
+        {"tile-rows",           required_argument,  NULL, 'T'},
+        {"coarse-scale",        required_argument,  NULL, 'c'},
+        {"jobs",                required_argument,  NULL, 'j'},
+        {"frame-stride",        required_argument,  NULL, 'S'},
+        {"keyframes-only",      no_argument,        NULL, 'K'},
+        {"segments",            required_argument,  NULL, 'k'},
+        {"queue-depth",         required_argument,  NULL, 'q'},
+        {"report-stalls",       no_argument,        NULL, 'r'},
+        {"reference",           no_argument,        NULL, 'R'},
+        {"list",                required_argument,  NULL, 'l'},
+        {"output",              required_argument,  NULL, 'o'},
+        {"time-series",         required_argument,  NULL, 'e'},
+        {"posture",             required_argument,  NULL, 'P'},
+        {"posture-basis",       required_argument,  NULL, 'p'},
+        {"help",                no_argument,        NULL, 'h'},
+        {"version",             no_argument,        NULL, 'v'},
+        {NULL,                  0,                  NULL,  0 }
+    };
+
+    // Parse command line options...
+    while((nOption = getopt_long(nArguments, ppszArguments,
+                                 "f:t:m:n:x:s:da:b:B:i:T:c:j:S:Kk:q:rRl:o:"
+                                 "e:P:p:hv",
+                                 LongOptions, NULL))
+          != -1)
+    {
+        // Which option?
+        switch(nOption)
+        {
+            // Field of view diameter...
+            case 'f':
+            {
+                // Convert and bounds check...
+                Settings.fFieldOfViewDiameter = atof(optarg);
+                if(Settings.fFieldOfViewDiameter <= 0.0f)
+                {
+                    cerr << "slither-batch: field of view must be positive..."
+                         << endl;
+                    return EXIT_FAILURE;
+                }
+                break;
+            }
+
+            // Artificial intelligence magic...
+            case 't': Settings.unThreshold =
+                        ParseUnsigned("--threshold", optarg); break;
+            case 'm': Settings.unMaxThresholdValue =
+                        ParseUnsigned("--max-threshold-value", optarg); break;
+            case 'n': Settings.unMinimumCandidateSize =
+                        ParseUnsigned("--minimum-size", optarg); break;
+            case 'x': Settings.unMaximumCandidateSize =
+                        ParseUnsigned("--maximum-size", optarg); break;
+            case 's': Settings.unMorphologySize =
+                        ParseUnsigned("--morphology-size", optarg); break;
+            case 'd': Settings.bInletDetection = false; break;
+
+            // Automatic calibration...
+            case 'a':
+            {
+                // Which method...
+                if(string(optarg) == "otsu")
+                    Settings.CalibrationMethod = ThresholdCalibrator::OTSU;
+                else if(string(optarg) == "triangle")
+                    Settings.CalibrationMethod = ThresholdCalibrator::TRIANGLE;
+                else
+                {
+                    cerr << "slither-batch: invalid value for"
+                            " --auto-calibrate: " << optarg << endl;
+                    return EXIT_FAILURE;
+                }
+                Settings.bAutoCalibration = true;
+                break;
+            }
+
+            // Background model...
+            case 'b': Settings.unBackgroundScale =
+                        ParseUnsigned("--background-scale", optarg); break;
+            case 'B': Settings.unBackgroundLearning =
+                        ParseUnsigned("--background-learning", optarg); break;
+
+            // Search only around known worms between rescans...
+            case 'i': Settings.unRescanInterval =
+                        ParseUnsigned("--rescan-interval", optarg); break;
+
+            // Segment in parallel tiles...
+            case 'T': Settings.unTileRows =
+                        ParseUnsigned("--tile-rows", optarg); break;
+
+            // Coarse to fine full frame scans...
+            case 'c': Settings.unCoarseScale =
+                        ParseUnsigned("--coarse-scale", optarg); break;
+
+            // Number of media to analyze at once...
+            case 'j': Settings.unJobs = ParseUnsigned("--jobs", optarg); break;
+
+            // Which frames to decode...
+            case 'S': Settings.unFrameStride =
+                        ParseUnsigned("--frame-stride", optarg); break;
+            case 'K': Settings.bKeyframesOnly = true; break;
+
+            // Segments of a long video analyzed side by side...
+            case 'k': Settings.unSegments =
+                        ParseUnsigned("--segments", optarg); break;
+
+            // Decoder and tracker pipeline...
+            case 'q': Settings.unFrameQueueDepth =
+                        ParseUnsigned("--queue-depth", optarg); break;
+            case 'r': Settings.bReportStalls = true; break;
+
+            // Reference algorithms...
+            case 'R': Settings.bReferenceMode = true; break;
+
+            // List of media in a file...
+            case 'l':
+            {
+                // Open it...
+                ifstream ListFile(optarg);
+                if(!ListFile.is_open())
+                {
+                    cerr << "slither-batch: unable to open " << optarg << endl;
+                    return EXIT_FAILURE;
+                }
+
+                // Add every non-empty line...
+                string sLine;
+                while(getline(ListFile, sLine))
+                {
+                    if(!sLine.empty())
+                        MediaPaths.push_back(sLine);
+                }
+                break;
+            }
+
+            // Output file...
+            case 'o': sOutputPath = optarg; break;
+
+            // Time series file...
+            case 'e': sTimeSeriesPath = optarg; break;
+
+            // Posture file...
+            case 'P': sPosturePath = optarg; break;
+
+            // Posture basis...
+            case 'p':
+            {
+                // Open it...
+                ifstream BasisFile(optarg);
+                if(!BasisFile.is_open())
+                {
+                    cerr << "slither-batch: unable to open " << optarg << endl;
+                    return EXIT_FAILURE;
+                }
+
+                // Read every number, mode after mode...
+                float fValue = 0.0f;
+                PostureBasis.clear();
+                while(BasisFile >> fValue)
+                    PostureBasis.push_back(fValue);
+
+                // Something other than a number, or not whole modes...
+                if(!BasisFile.eof() || !Worm::SetPostureBasis(PostureBasis))
+                {
+                    cerr << "slither-batch: " << optarg << " is not up to "
+                         << Worm::MAXIMUM_POSTURE_MODES << " modes of "
+                         << Worm::POSTURE_ANGLES << " numbers each" << endl;
+                    return EXIT_FAILURE;
+                }
+                break;
+            }
+
+            // Help...
+            case 'h': ShowUsage(ppszArguments[0]); return EXIT_SUCCESS;
+
+            // Version...
+            case 'v': cout << SLITHER_VERSION << endl; return EXIT_SUCCESS;
+
+            // Unknown option. getopt_long(3) already complained...
+            default: ShowUsage(ppszArguments[0]); return EXIT_FAILURE;
+        }
+    }
+
+    // Inlet correction needs a kernel to open with...
+    if(Settings.bInletDetection && Settings.unMorphologySize == 0)
+    {
+        cerr << "slither-batch: --morphology-size must be at least 1 with"
+                " inlet detection" << endl;
+        return EXIT_FAILURE;
+    }
+
+    // Remaining arguments are media...
+    for(int nIndex = optind; nIndex < nArguments; ++nIndex)
+        MediaPaths.push_back(ppszArguments[nIndex]);
+
+        // Nothing to do...
+        if(MediaPaths.empty())
+        {
+            ShowUsage(ppszArguments[0]);
+            return EXIT_FAILURE;
+        }
+
+    // Initialize wxWidgets' base library without any user interface...
+    wxInitializer Initializer;
+    if(!Initializer.IsOk())
+    {
+        cerr << "slither-batch: unable to initialize wxWidgets..." << endl;
+        return EXIT_FAILURE;
+    }
+
+    // Prepare the output stream...
+    ofstream OutputFile;
+    if(!sOutputPath.empty())
+    {
+        // Open...
+        OutputFile.open(sOutputPath.c_str(), ios::out | ios::trunc);
+
+        // Failed...
+        if(!OutputFile.is_open())
+        {
+            cerr << "slither-batch: unable to write to " << sOutputPath
+                 << endl;
+            return EXIT_FAILURE;
+        }
+    }
+    ostream &Output = sOutputPath.empty() ? cout : OutputFile;
+
+    // Prepare the time series stream, if requested...
+    ofstream TimeSeriesFile;
+    if(!sTimeSeriesPath.empty())
+    {
+        // Open...
+        TimeSeriesFile.open(sTimeSeriesPath.c_str(), ios::out | ios::trunc);
+
+        // Failed...
+        if(!TimeSeriesFile.is_open())
+        {
+            cerr << "slither-batch: unable to write to " << sTimeSeriesPath
+                 << endl;
+            return EXIT_FAILURE;
+        }
+
+        // Tab delimited header...
+        TimeSeriesFile << "Media\tWorm #\tFrame\tCentre X\tCentre Y\tHead X"
+                          "\tHead Y\tTail X\tTail Y\tLength (px)"
+                          "\tWidth (px)\tArea (px²)" << endl
+                       << fixed << setprecision(3);
+    }
+
+    // Prepare the posture stream, if requested...
+    ofstream PostureFile;
+    if(!sPosturePath.empty())
+    {
+        // Open...
+        PostureFile.open(sPosturePath.c_str(), ios::out | ios::trunc);
+
+        // Failed...
+        if(!PostureFile.is_open())
+        {
+            cerr << "slither-batch: unable to write to " << sPosturePath
+                 << endl;
+            return EXIT_FAILURE;
+        }
+
+        // Tab delimited header, with each tangent angle and then each
+        //  mode...
+        PostureFile << "Media\tWorm #\tFrame";
+        for(unsigned int unAngle = 0; unAngle < Worm::POSTURE_ANGLES;
+          ++unAngle)
+            PostureFile << "\tAngle " << unAngle + 1 << " (rad)";
+        for(unsigned int unMode = 0;
+            unMode < PostureBasis.size() / Worm::POSTURE_ANGLES;
+          ++unMode)
+            PostureFile << "\tMode " << unMode + 1;
+        PostureFile << endl << fixed << setprecision(4);
+    }
+
+    // Prepare the tracker...
+    WormTracker::SetReferenceMode(Settings.bReferenceMode);
+    WormTracker Tracker;
+    Tracker.SetFieldOfViewDiameter(Settings.fFieldOfViewDiameter);
+    Tracker.SetArtificialIntelligenceMagic(
+        Settings.unThreshold,
+        Settings.unMaxThresholdValue,
+        Settings.unMinimumCandidateSize,
+        Settings.unMaximumCandidateSize,
+        Settings.bInletDetection,
+        Settings.unMorphologySize);
+    Tracker.SetAutoCalibration(Settings.bAutoCalibration,
+                               Settings.CalibrationMethod);
+    Tracker.SetBackgroundModel(Settings.unBackgroundScale,
+                               Settings.unBackgroundLearning);
+    Tracker.SetRescanInterval(Settings.unRescanInterval);
+    Tracker.SetTiledSegmentation(Settings.unTileRows);
+    Tracker.SetCoarseDetection(Settings.unCoarseScale);
+    Tracker.SetTimeSeriesRecording(
+        !sTimeSeriesPath.empty() || !sPosturePath.empty());
+
+    // Tab delimited header...
+    Output << "Media\tWorm #\tLength (mm)\tWidth (mm)\tArea (mm²)\tRefreshes"
+           << endl << fixed << setprecision(3);
+
+    // Queue every media and start analyzing them all at once...
+    AnalysisScheduler Scheduler(Tracker);
+    Scheduler.SetFrameQueueDepth(Settings.unFrameQueueDepth);
+    Scheduler.SetFrameStride(Settings.unFrameStride);
+    Scheduler.SetKeyframesOnly(Settings.bKeyframesOnly);
+    Scheduler.SetSegments(Settings.unSegments);
+    for(vector<string>::const_iterator Iterator = MediaPaths.begin();
+        Iterator != MediaPaths.end();
+      ++Iterator)
+        Scheduler.Add(*Iterator);
+
+        // Failed to start a single worker...
+        if(Scheduler.Start(Settings.unJobs) == 0)
+        {
+            cerr << "slither-batch: unable to start any analysis threads..."
+                 << endl;
+            return EXIT_FAILURE;
+        }
+
+    // Report which instruction set the batched geometry runs on, if
+    //  requested...
+    if(Settings.bReportStalls)
+        cerr << "slither-batch: batched geometry using "
+             << SlitherMath::GetBatchedInstructionSet() << endl;
+
+    // Write out each media's results as soon as it is done...
+    MediaAnalysisResult Result;
+    while(Scheduler.WaitForNextResult(Result))
+    {
+        // Failed, alert and move on to the next...
+        if(!Result.bSucceeded)
+        {
+            cerr << "slither-batch: " << Result.sPath << ": " << Result.sError
+                 << endl;
+            bAllSucceeded = false;
+            continue;
+        }
+
+        // Report how much the decoder and tracker waited on each other, if
+        //  requested and they ran side by side...
+        if(Settings.bReportStalls && Result.PipelineStalls.unFrames > 0)
+        {
+            // Whichever waited the least is the bottleneck...
+            FrameQueueStalls const &Stalls = Result.PipelineStalls;
+            cerr << "slither-batch: " << Result.sPath << ": "
+                 << Stalls.unFrames << " frames, decoder waited "
+                 << Stalls.unProducerStalls << " times ("
+                 << Stalls.dProducerStallSeconds << " s), tracker waited "
+                 << Stalls.unConsumerStalls << " times ("
+                 << Stalls.dConsumerStallSeconds << " s)" << endl;
+        }
+
+        // Report the time spent in each tracker stage, if requested...
+        if(Settings.bReportStalls && Result.Timings.unFrames > 0)
+        {
+            StageTimings const &Timings = Result.Timings;
+            cerr << "slither-batch: " << Result.sPath << ": "
+                 << Timings.unFrames << " frames, "
+                 << Timings.unCoarseScans << " coarse scans ("
+                 << Timings.dCoarseSeconds << " s), segmentation "
+                 << Timings.dSegmentationSeconds << " s, tracking "
+                 << Timings.dTrackingSeconds << " s" << endl;
+        }
+
+        // Report how many frames were skipped, if requested and any were...
+        if(Settings.bReportStalls && (Result.Savings.unFramesGrabbed > 0 ||
+                                      Result.Savings.unFramesUndecoded > 0))
+        {
+            DecodeSavings const &Savings = Result.Savings;
+            cerr << "slither-batch: " << Result.sPath << ": "
+                 << Savings.unFramesRetrieved << " frames tracked, "
+                 << Savings.unFramesGrabbed << " skipped without converting, "
+                 << Savings.unFramesUndecoded << " without decoding" << endl;
+        }
+
+        // Write a row for each worm...
+        for(unsigned int unWormIndex = 0;
+            unWormIndex < Result.Measurements.size();
+          ++unWormIndex)
+        {
+            // Get the worm's measurements...
+            WormMeasurement const &Measurement =
+                Result.Measurements.at(unWormIndex);
+
+            // Write...
+            Output << Result.sPath              << "\t"
+                   << unWormIndex + 1           << "\t"
+                   << Measurement.dLength       << "\t"
+                   << Measurement.dWidth        << "\t"
+                   << Measurement.dArea         << "\t"
+                   << Measurement.unRefreshes   << endl;
+        }
+
+        // Write a row for each frame each worm was seen in, if requested, and
+        //  for each of those its midline was traced in...
+        for(unsigned int unWormIndex = 0;
+            unWormIndex < Result.TimeSeries.size();
+          ++unWormIndex)
+        {
+            for(vector<WormSample>::const_iterator Iterator =
+                    Result.TimeSeries[unWormIndex].begin();
+                Iterator != Result.TimeSeries[unWormIndex].end();
+              ++Iterator)
+            {
+                // Its posture, if requested and its midline was traced...
+                if(!sPosturePath.empty() && Iterator->bPostureValid)
+                {
+                    PostureFile << Result.sPath << "\t" << unWormIndex + 1
+                                << "\t" << Iterator->unFrame;
+                    for(unsigned int unAngle = 0;
+                        unAngle < Worm::POSTURE_ANGLES;
+                      ++unAngle)
+                        PostureFile << "\t" << (double) 
+                            Iterator->TangentAngles[unAngle] / 
+                                Worm::POSTURE_ANGLE_STEPS;
+                    for(unsigned int unMode = 0;
+                        unMode < Iterator->unPostureModes;
+                      ++unMode)
+                        PostureFile << "\t" << Iterator->Projections[unMode];
+                    PostureFile << endl;
+                }
+
+                // Its measurements, if requested...
+                if(sTimeSeriesPath.empty())
+                    continue;
+                TimeSeriesFile << Result.sPath          << "\t"
+                               << unWormIndex + 1       << "\t"
+                               << Iterator->unFrame     << "\t"
+                               << Iterator->CentreX     << "\t"
+                               << Iterator->CentreY     << "\t"
+                               << Iterator->HeadX       << "\t"
+                               << Iterator->HeadY       << "\t"
+                               << Iterator->TailX       << "\t"
+                               << Iterator->TailY       << "\t"
+                               << Iterator->fLength     << "\t"
+                               << Iterator->fWidth      << "\t"
+                               << Iterator->fArea       << endl;
+            }
+        }
+    }
+
+    // Done...
+    return bAllSucceeded ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
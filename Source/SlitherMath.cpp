@@ -18,6 +18,30 @@
     // Standard math routines...
     #include <cmath>
 
+    // OpenCV's universal intrinsics, for the batched routines...
+    #include <opencv2/core/hal/intrin.hpp>
+
+// The instruction set the universal intrinsics were built for, which the CPU
+//  must also have before the batched routines will use them...
+#if CV_SIMD
+    #if CV_AVX512_SKX
+        #define BATCHED_CPU_FEATURE         CV_CPU_AVX_512SKX
+        #define BATCHED_INSTRUCTION_SET     "AVX-512"
+    #elif CV_AVX2
+        #define BATCHED_CPU_FEATURE         CV_CPU_AVX2
+        #define BATCHED_INSTRUCTION_SET     "AVX2"
+    #elif CV_SSE2
+        #define BATCHED_CPU_FEATURE         CV_CPU_SSE2
+        #define BATCHED_INSTRUCTION_SET     "SSE2"
+    #elif CV_NEON
+        #define BATCHED_CPU_FEATURE         CV_CPU_NEON
+        #define BATCHED_INSTRUCTION_SET     "NEON"
+    #else
+        #define BATCHED_CPU_FEATURE         CV_CPU_NONE
+        #define BATCHED_INSTRUCTION_SET     "SIMD"
+    #endif
+#endif
+
 // Within the SlitherMath namespace...
 namespace SlitherMath
 {
@@ -256,5 +280,447 @@ namespace SlitherMath
         NewPoint = TempPoint;
         return NewPoint;
     }
+
+    // Solve the rectangular linear assignment problem, pairing rows with 
+    //  columns for the least total cost. This is the Hungarian method with 
+    //  potentials, run from the smaller side... O(n²m)
+    void SolveAssignment(
+        std::vector<double> const &Costs, unsigned int const unRows, 
+        unsigned int const unColumns, std::vector<int> &Assignments)
+    {
+        // Variables...
+        bool const          bTransposed = (unRows > unColumns);
+        unsigned int const  unSmaller   = bTransposed ? unColumns : unRows;
+        unsigned int const  unLarger    = bTransposed ? unRows : unColumns;
+        double              dForbidden  = 1.0;
+
+        // Nothing paired yet...
+        Assignments.assign(unRows, -1);
+
+            // Nothing to pair...
+            if(unSmaller == 0)
+                return;
+
+        // Every one of the smaller side gets paired, so forbidden pairs must 
+        //  cost more than every allowed pair put together. That way they are 
+        //  only made when nothing else is left, and are undone afterwards...
+        for(std::vector<double>::const_iterator Iterator = Costs.begin();
+            Iterator != Costs.end();
+          ++Iterator)
+        {
+            if(*Iterator < Infinity)
+                dForbidden += fabs(*Iterator);
+        }
+
+        // Potentials for either side, the smaller side paired with each of the
+        //  larger, the previous column on each column's augmenting path, its 
+        //  slack, and whether it's on the current path. All one based, with 
+        //  column zero standing in for the row being added...
+        std::vector<double>         RowPotentials(unSmaller + 1, 0.0);
+        std::vector<double>         ColumnPotentials(unLarger + 1, 0.0);
+        std::vector<unsigned int>   ColumnPairs(unLarger + 1, 0);
+        std::vector<unsigned int>   PreviousColumns(unLarger + 1, 0);
+        std::vector<double>         Slacks(unLarger + 1);
+        std::vector<bool>           Visited(unLarger + 1);
+
+        // Add each row in turn, augmenting along the cheapest path...
+        for(unsigned int unRow = 1; unRow <= unSmaller; ++unRow)
+        {
+            // Variables...
+            unsigned int    unColumn    = 0;
+
+            // Start a new path from the row being added...
+            ColumnPairs[0] = unRow;
+            std::fill(Slacks.begin(), Slacks.end(), Infinity);
+            std::fill(Visited.begin(), Visited.end(), false);
+
+            // Grow the path until it reaches an unpaired column...
+            do
+            {
+                // Variables...
+                unsigned int const  unPathRow   = ColumnPairs[unColumn];
+                unsigned int        unNext      = 0;
+                double              dDelta      = Infinity;
+
+                // This column is now on the path...
+                Visited[unColumn] = true;
+
+                // Find the column with the least slack from here...
+                for(unsigned int unCandidate = 1; unCandidate <= unLarger; 
+                  ++unCandidate)
+                {
+                    // Already on the path...
+                    if(Visited[unCandidate])
+                        continue;
+
+                    // Cost of this pairing, whichever way around we are...
+                    double dCost = bTransposed ?
+                        Costs[(unCandidate - 1) * unColumns + unPathRow - 1] :
+                        Costs[(unPathRow - 1) * unColumns + unCandidate - 1];
+                    if(dCost >= Infinity)
+                        dCost = dForbidden;
+
+                    // Reduced cost...
+                    double const dSlack = dCost - RowPotentials[unPathRow] - 
+                                          ColumnPotentials[unCandidate];
+
+                    // Best way to reach this column so far...
+                    if(dSlack < Slacks[unCandidate])
+                    {
+                        Slacks[unCandidate]             = dSlack;
+                        PreviousColumns[unCandidate]    = unColumn;
+                    }
+
+                    // Least slack of any column...
+                    if(Slacks[unCandidate] < dDelta)
+                    {
+                        dDelta  = Slacks[unCandidate];
+                        unNext  = unCandidate;
+                    }
+                }
+
+                // Adjust potentials so that column's pairing becomes tight...
+                for(unsigned int unCandidate = 0; unCandidate <= unLarger; 
+                  ++unCandidate)
+                {
+                    if(Visited[unCandidate])
+                    {
+                        RowPotentials[ColumnPairs[unCandidate]] += dDelta;
+                        ColumnPotentials[unCandidate]           -= dDelta;
+                    }
+                    else
+                        Slacks[unCandidate] -= dDelta;
+                }
+
+                // Follow it...
+                unColumn = unNext;
+            }
+            while(ColumnPairs[unColumn] != 0);
+
+            // Flip the pairings back along the path...
+            do
+            {
+                unsigned int const unPrevious = PreviousColumns[unColumn];
+                ColumnPairs[unColumn] = ColumnPairs[unPrevious];
+                unColumn = unPrevious;
+            }
+            while(unColumn != 0);
+        }
+
+        // Report each allowed pairing from the row's point of view...
+        for(unsigned int unColumn = 1; unColumn <= unLarger; ++unColumn)
+        {
+            // Variables...
+            unsigned int const unRow = ColumnPairs[unColumn];
+
+            // Unpaired...
+            if(unRow == 0)
+                continue;
+
+            // Back to zero based, whichever way around we are...
+            unsigned int const unOriginalRow    = 
+                bTransposed ? unColumn - 1 : unRow - 1;
+            unsigned int const unOriginalColumn = 
+                bTransposed ? unRow - 1 : unColumn - 1;
+
+            // Forbidden pairs are undone...
+            if(Costs[unOriginalRow * unColumns + unOriginalColumn] >= Infinity)
+                continue;
+
+            // Store...
+            Assignments[unOriginalRow] = unOriginalColumn;
+        }
+    }
+
+    // The batched routines each come one at a time, and a vector at a time
+    //  with OpenCV's universal intrinsics on whatever instruction set it was
+    //  built for. The vector kinds do the same arithmetic in the same order
+    //  and precision as the scalar routines, and finish off with them...
+
+        // Kinds of batched routine...
+        typedef void (*DistancesRoutine)(
+            float const *, float const *, float const *, float const *,
+            unsigned int const, float *);
+        typedef void (*IntersectsRoutine)(
+            LineSegment const &, float const *, float const *, float const *,
+            float const *, unsigned int const, int *);
+
+        // The kinds chosen, and the instruction set they run on...
+        typedef struct BatchedRoutines
+        {
+            char const         *pszInstructionSet;
+            DistancesRoutine    Distances;
+            IntersectsRoutine   Intersects;
+        }BatchedRoutines;
+
+        // Calculate the distance between each pair of points, one at a
+        //  time...
+        static void DistancesBetweenPointsScalar(
+            float const *pFirstX, float const *pFirstY,
+            float const *pSecondX, float const *pSecondY,
+            unsigned int const unCount, float *pDistances)
+        {
+            for(unsigned int unIndex = 0; unIndex < unCount; ++unIndex)
+                pDistances[unIndex] = (float) DistanceBetweenTwoPoints(
+                    cvPoint2D32f(pFirstX[unIndex], pFirstY[unIndex]),
+                    cvPoint2D32f(pSecondX[unIndex], pSecondY[unIndex]));
+        }
+
+        // Check which edges the probe intersects, one at a time...
+        static void IsLineSegmentIntersectingEdgesScalar(
+            LineSegment const &Probe,
+            float const *pStartX, float const *pStartY,
+            float const *pEndX, float const *pEndY,
+            unsigned int const unCount, int *pIntersects)
+        {
+            for(unsigned int unIndex = 0; unIndex < unCount; ++unIndex)
+                pIntersects[unIndex] = IsLineSegmentsIntersect(Probe,
+                    LineSegment(
+                        cvPoint2D32f(pStartX[unIndex], pStartY[unIndex]),
+                        cvPoint2D32f(pEndX[unIndex], pEndY[unIndex])))
+                    ? 1 : 0;
+        }
+
+        #if CV_SIMD_64F
+        // Calculate the distance between each pair of points, a vector at a
+        //  time. The differences are taken in single precision and the rest
+        //  in double, just as DistanceBetweenTwoPoints() does...
+        static void DistancesBetweenPointsVector(
+            float const *pFirstX, float const *pFirstY,
+            float const *pSecondX, float const *pSecondY,
+            unsigned int const unCount, float *pDistances)
+        {
+            // Variables...
+            unsigned int unIndex = 0;
+
+            // A vector at a time, while there are enough left...
+            for(; unIndex + CV_SIMD_WIDTH / 4 <= unCount;
+                unIndex += CV_SIMD_WIDTH / 4)
+            {
+                cv::v_float32 const DeltaX =
+                    cv::vx_load(pSecondX + unIndex) -
+                    cv::vx_load(pFirstX + unIndex);
+                cv::v_float32 const DeltaY =
+                    cv::vx_load(pSecondY + unIndex) -
+                    cv::vx_load(pFirstY + unIndex);
+                cv::v_float64 const LowX    = cv::v_cvt_f64(DeltaX);
+                cv::v_float64 const LowY    = cv::v_cvt_f64(DeltaY);
+                cv::v_float64 const HighX   = cv::v_cvt_f64_high(DeltaX);
+                cv::v_float64 const HighY   = cv::v_cvt_f64_high(DeltaY);
+                cv::v_store(pDistances + unIndex, cv::v_cvt_f32(
+                    cv::v_sqrt(LowX * LowX + LowY * LowY),
+                    cv::v_sqrt(HighX * HighX + HighY * HighY)));
+            }
+
+            // ...then the rest one at a time...
+            DistancesBetweenPointsScalar(
+                pFirstX + unIndex, pFirstY + unIndex, pSecondX + unIndex,
+                pSecondY + unIndex, unCount - unIndex, pDistances + unIndex);
+        }
+        #endif
+
+        #if CV_SIMD
+        // Is each point within the bounding box of each segment? Every bit
+        //  of a lane is set where it is...
+        static inline cv::v_int32 IsWithinBounds(
+            cv::v_float32 const &X, cv::v_float32 const &Y,
+            cv::v_float32 const &FirstX, cv::v_float32 const &FirstY,
+            cv::v_float32 const &SecondX, cv::v_float32 const &SecondY)
+        {
+            return cv::v_reinterpret_as_s32(
+                (cv::v_min(FirstX, SecondX) <= X) &
+                (X <= cv::v_max(FirstX, SecondX)) &
+                (cv::v_min(FirstY, SecondY) <= Y) &
+                (Y <= cv::v_max(FirstY, SecondY)));
+        }
+
+        // Check which edges the probe intersects, a vector at a time. Each
+        //  cross product is taken in single precision and truncated, just as
+        //  Direction() does...
+        static void IsLineSegmentIntersectingEdgesVector(
+            LineSegment const &Probe,
+            float const *pStartX, float const *pStartY,
+            float const *pEndX, float const *pEndY,
+            unsigned int const unCount, int *pIntersects)
+        {
+            // Variables...
+            unsigned int        unIndex     = 0;
+            cv::v_float32 const ProbeStartX = cv::vx_setall_f32(Probe.first.x);
+            cv::v_float32 const ProbeStartY = cv::vx_setall_f32(Probe.first.y);
+            cv::v_float32 const ProbeEndX   = cv::vx_setall_f32(Probe.second.x);
+            cv::v_float32 const ProbeEndY   = cv::vx_setall_f32(Probe.second.y);
+            cv::v_int32 const   Zero        = cv::vx_setzero_s32();
+
+            // A vector at a time, while there are enough left...
+            for(; unIndex + CV_SIMD_WIDTH / 4 <= unCount;
+                unIndex += CV_SIMD_WIDTH / 4)
+            {
+                // Load the edges...
+                cv::v_float32 const StartX  = cv::vx_load(pStartX + unIndex);
+                cv::v_float32 const StartY  = cv::vx_load(pStartY + unIndex);
+                cv::v_float32 const EndX    = cv::vx_load(pEndX + unIndex);
+                cv::v_float32 const EndY    = cv::vx_load(pEndY + unIndex);
+
+                // Relative orientation of each endpoint with respect to the
+                //  other segment...
+                cv::v_int32 const Direction1 = cv::v_trunc(
+                    (EndX - StartX) * (ProbeStartY - StartY) -
+                    (ProbeStartX - StartX) * (EndY - StartY));
+                cv::v_int32 const Direction2 = cv::v_trunc(
+                    (EndX - StartX) * (ProbeEndY - StartY) -
+                    (ProbeEndX - StartX) * (EndY - StartY));
+                cv::v_int32 const Direction3 = cv::v_trunc(
+                    (ProbeEndX - ProbeStartX) * (StartY - ProbeStartY) -
+                    (StartX - ProbeStartX) * (ProbeEndY - ProbeStartY));
+                cv::v_int32 const Direction4 = cv::v_trunc(
+                    (ProbeEndX - ProbeStartX) * (EndY - ProbeStartY) -
+                    (EndX - ProbeStartX) * (ProbeEndY - ProbeStartY));
+
+                // Each straddles the other...
+                cv::v_int32 Intersects =
+                    (((Direction1 > Zero) & (Direction2 < Zero)) |
+                     ((Direction1 < Zero) & (Direction2 > Zero))) &
+                    (((Direction3 > Zero) & (Direction4 < Zero)) |
+                     ((Direction3 < Zero) & (Direction4 > Zero)));
+
+                // ...or an endpoint of one is collinear with, and on, the
+                //  other...
+                Intersects = Intersects |
+                    ((Direction1 == Zero) & IsWithinBounds(
+                        ProbeStartX, ProbeStartY, StartX, StartY, EndX, EndY));
+                Intersects = Intersects |
+                    ((Direction2 == Zero) & IsWithinBounds(
+                        ProbeEndX, ProbeEndY, StartX, StartY, EndX, EndY));
+                Intersects = Intersects |
+                    ((Direction3 == Zero) & IsWithinBounds(
+                        StartX, StartY, ProbeStartX, ProbeStartY,
+                        ProbeEndX, ProbeEndY));
+                Intersects = Intersects |
+                    ((Direction4 == Zero) & IsWithinBounds(
+                        EndX, EndY, ProbeStartX, ProbeStartY,
+                        ProbeEndX, ProbeEndY));
+
+                // Store...
+                cv::v_store(pIntersects + unIndex, Intersects);
+            }
+
+            // ...then the rest one at a time...
+            IsLineSegmentIntersectingEdgesScalar(
+                Probe, pStartX + unIndex, pStartY + unIndex, pEndX + unIndex,
+                pEndY + unIndex, unCount - unIndex, pIntersects + unIndex);
+        }
+        #endif
+
+        // Pick the batched routines for this CPU. Vectors only when it has
+        //  the instruction set they were built for, and OpenCV hasn't been
+        //  told to avoid its own optimizations...
+        static BatchedRoutines PickBatchedRoutines()
+        {
+            // Scalar unless we find otherwise...
+            BatchedRoutines Routines =
+            {
+                "scalar",
+                DistancesBetweenPointsScalar,
+                IsLineSegmentIntersectingEdgesScalar
+            };
+
+            // The CPU can run the vectors...
+            #if CV_SIMD
+            if(cv::useOptimized() &&
+               (BATCHED_CPU_FEATURE == CV_CPU_NONE ||
+                cv::checkHardwareSupport(BATCHED_CPU_FEATURE)))
+            {
+                Routines.pszInstructionSet  = BATCHED_INSTRUCTION_SET;
+                Routines.Intersects = IsLineSegmentIntersectingEdgesVector;
+                #if CV_SIMD_64F
+                Routines.Distances  = DistancesBetweenPointsVector;
+                #endif
+            }
+            #endif
+
+            // Done...
+            return Routines;
+        }
+
+        // Get the batched routines for this CPU, picked once at startup...
+        static BatchedRoutines const &GetBatchedRoutines()
+        {
+            // Static local initialization is thread safe...
+            static BatchedRoutines const Routines = PickBatchedRoutines();
+            return Routines;
+        }
+
+        // Pick them at startup, rather than during the first frame...
+        static BatchedRoutines const &StartupBatchedRoutines =
+            GetBatchedRoutines();
+
+    // Calculate the distance between each pair of points... θ(n)
+    void DistancesBetweenPoints(
+        float const *pFirstX, float const *pFirstY, float const *pSecondX,
+        float const *pSecondY, unsigned int const unCount, float *pDistances)
+    {
+        // Hand off to whichever kind was picked...
+        GetBatchedRoutines().Distances(
+            pFirstX, pFirstY, pSecondX, pSecondY, unCount, pDistances);
+    }
+
+    // Calculate the length of each edge of a closed contour... θ(n)
+    void EdgeLengths(PointArrays const &Contour, std::vector<float> &Lengths)
+    {
+        // One fewer edge than points, since the first is repeated at the
+        //  end...
+        unsigned int const unEdges =
+            Contour.X.empty() ? 0 : (unsigned int) Contour.X.size() - 1;
+        Lengths.resize(unEdges);
+
+            // No edges...
+            if(unEdges == 0)
+                return;
+
+        // Each edge runs from one point to the next...
+        DistancesBetweenPoints(&Contour.X[0], &Contour.Y[0], &Contour.X[1],
+                               &Contour.Y[1], unEdges, &Lengths[0]);
+    }
+
+    // Get the name of the instruction set the batched routines were chosen to
+    //  run on at startup...
+    char const *GetBatchedInstructionSet()
+    {
+        // Return it...
+        return GetBatchedRoutines().pszInstructionSet;
+    }
+
+    // Check which of the edges the probe intersects... θ(n)
+    void IsLineSegmentIntersectingEdges(
+        LineSegment const &Probe, float const *pStartX, float const *pStartY,
+        float const *pEndX, float const *pEndY, unsigned int const unCount,
+        int *pIntersects)
+    {
+        // Hand off to whichever kind was picked...
+        GetBatchedRoutines().Intersects(
+            Probe, pStartX, pStartY, pEndX, pEndY, unCount, pIntersects);
+    }
+
+    // Load a closed contour's vertices, with the first repeated at the end...
+    //  θ(n)
+    void LoadClosedContour(
+        std::vector<cv::Point> const &Vertices, PointArrays &Contour)
+    {
+        // Variables...
+        unsigned int const unVertices = (unsigned int) Vertices.size();
+
+        // Only ever grows, so this doesn't allocate after the first few
+        //  contours...
+        Contour.X.resize(unVertices == 0 ? 0 : unVertices + 1);
+        Contour.Y.resize(Contour.X.size());
+
+        // Copy each across, then the first again...
+        for(unsigned int unIndex = 0; unIndex < Contour.X.size(); ++unIndex)
+        {
+            cv::Point const &Vertex = Vertices[unIndex % unVertices];
+            Contour.X[unIndex] = (float) Vertex.x;
+            Contour.Y[unIndex] = (float) Vertex.y;
+        }
+    }
 }
 
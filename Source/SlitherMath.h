@@ -23,8 +23,9 @@
     //#include <opencv2/imgcodecs/imgcodecs_c.h>  2020/06/10 - deprecated
     #include <opencv2/imgcodecs/legacy/constants_c.h>
     
-    // STL pair...
+    // STL pair and vector...
     #include <utility>
+    #include <vector>
 
 // Slither math routines...
 namespace SlitherMath
@@ -42,6 +43,14 @@ namespace SlitherMath
         // Line segment...
         typedef std::pair<CvPoint2D32f, CvPoint2D32f> LineSegment;
 
+        // Points stored as one array of x and another of y, so the batched
+        //  routines below can load a vector of either at once...
+        typedef struct PointArrays
+        {
+            std::vector<float> X;
+            std::vector<float> Y;
+        }PointArrays;
+
     // Functions. Mostly computational geometry related...
 
         // Adjust the distance of the second vertex by the given distance along
@@ -101,6 +110,59 @@ namespace SlitherMath
             CvPoint2D32f const &Origin,
             double const &dRadians,
             CvPoint2D32f &NewPoint);
+
+        // Solve the rectangular linear assignment problem, pairing rows with
+        //  columns for the least total cost. Costs are row major, and pairs 
+        //  costing Infinity are never made. Each row's column is stored in 
+        //  Assignments, or -1 if it has none... O(n²m)
+        void SolveAssignment(
+            std::vector<double> const &Costs, 
+            unsigned int const unRows, 
+            unsigned int const unColumns, 
+            std::vector<int> &Assignments);
+
+    // Batched functions. Each repeats one of the above over whole arrays, a
+    //  vector at a time when the CPU allows, and gives exactly the same
+    //  result for every element as the one at a time routine would...
+
+        // Calculate the distance between each pair of points, the first of
+        //  each pair from the first arrays and the second from the second.
+        //  Same as DistanceBetweenTwoPoints()... θ(n)
+        void DistancesBetweenPoints(
+            float const *pFirstX,
+            float const *pFirstY,
+            float const *pSecondX,
+            float const *pSecondY,
+            unsigned int const unCount,
+            float *pDistances);
+
+        // Calculate the length of each edge of a closed contour loaded with
+        //  LoadClosedContour()... θ(n)
+        void EdgeLengths(
+            PointArrays const &Contour,
+            std::vector<float> &Lengths);
+
+        // Get the name of the instruction set the batched routines were
+        //  chosen to run on at startup, or "scalar"...
+        char const *GetBatchedInstructionSet();
+
+        // Check which of the edges, each from a start to an end point, the
+        //  probe intersects. Non-zero where it does. Same as
+        //  IsLineSegmentsIntersect() with the probe first... θ(n)
+        void IsLineSegmentIntersectingEdges(
+            LineSegment const &Probe,
+            float const *pStartX,
+            float const *pStartY,
+            float const *pEndX,
+            float const *pEndY,
+            unsigned int const unCount,
+            int *pIntersects);
+
+        // Load a closed contour's vertices, with the first repeated at the
+        //  end so that each edge runs from one point to the next... θ(n)
+        void LoadClosedContour(
+            std::vector<cv::Point> const &Vertices,
+            PointArrays &Contour);
 };
 
 #endif
@@ -0,0 +1,308 @@
+/*
+  Name:         ThresholdCalibrator.cpp (implementation)
+  Author:       Kip Warner (Kip@TheVertigo.com)
+  Description:  ThresholdCalibrator class. Picks a threshold and a candidate
+                size window from a sample of frames, building an intensity
+                histogram up a frame at a time until the estimate settles...
+*/
+
+// Includes...
+#include "ThresholdCalibrator.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+
+// Default constructor...
+ThresholdCalibrator::ThresholdCalibrator()
+    : CurrentMethod(TRIANGLE),
+      Histogram(256, 0.0),
+      unThreshold(0),
+      dMedianArea(0.0),
+      unStableFrames(0),
+      unFramesSampled(0)
+{
+
+}
+
+// Add an 8-bit grayscale frame, already prepared the way the tracker
+//  thresholds it, to the sample. True once the estimate has converged...
+bool ThresholdCalibrator::AddFrame(cv::Mat const &GrayImage)
+{
+    // Frame must be 8-bit, single channel...
+    CV_Assert(GrayImage.type() == CV_8UC1);
+
+    // Add every few pixels to the histogram. The frames are sampled far
+    //  apart, so this is plenty...
+    for(int nRow = 0; nRow < GrayImage.rows; nRow += HISTOGRAM_STRIDE)
+    {
+        unsigned char const *pRow = GrayImage.ptr<unsigned char>(nRow);
+        for(int nColumn = 0; nColumn < GrayImage.cols;
+            nColumn += HISTOGRAM_STRIDE)
+            Histogram[pRow[nColumn]] += 1.0;
+    }
+  ++unFramesSampled;
+
+    // Estimate the threshold again. If it has moved, the blobs measured so
+    //  far were measured at the wrong one...
+    unsigned int const unEstimate =
+        (CurrentMethod == OTSU) ? EstimateOtsu() : EstimateTriangle();
+    bool const bThresholdStill = (unFramesSampled > 1) &&
+        (std::abs((int) unEstimate - (int) unThreshold) <= 1);
+    if(!bThresholdStill)
+        BlobAreas.clear();
+    unThreshold = unEstimate;
+
+    // Measure this frame's blobs at it, and see whether their typical area
+    //  has moved by more than a tenth...
+    MeasureBlobs(GrayImage);
+    double const dMedian = FindMedianArea();
+    bool const bAreaStill = (unFramesSampled > 1) &&
+        (std::fabs(dMedian - dMedianArea) <= 0.1 * dMedianArea);
+    dMedianArea = dMedian;
+
+    // Count how many frames in a row neither has moved...
+    unStableFrames = (bThresholdStill && bAreaStill) ? unStableFrames + 1 : 0;
+
+    // Done for now...
+    return IsConverged();
+}
+
+// Pick the threshold that best separates the histogram's two classes, by
+//  Otsu's method... θ(n) in bins
+unsigned int ThresholdCalibrator::EstimateOtsu() const
+{
+    // Variables...
+    double          dTotal          = 0.0;
+    double          dTotalSum       = 0.0;
+    double          dDarkTotal      = 0.0;
+    double          dDarkSum        = 0.0;
+    double          dBestVariance   = -1.0;
+    unsigned int    unBest          = 0;
+
+    // Totals for the whole histogram...
+    for(unsigned int unBin = 0; unBin < Histogram.size(); ++unBin)
+    {
+        dTotal      += Histogram[unBin];
+        dTotalSum   += unBin * Histogram[unBin];
+    }
+
+    // Try splitting after each intensity, keeping the split with the most
+    //  variance between the two classes...
+    for(unsigned int unBin = 0; unBin < Histogram.size(); ++unBin)
+    {
+        // Move this intensity into the dark class...
+        dDarkTotal  += Histogram[unBin];
+        dDarkSum    += unBin * Histogram[unBin];
+
+        // Either class is still empty...
+        double const dBrightTotal = dTotal - dDarkTotal;
+        if(dDarkTotal == 0.0)
+            continue;
+        if(dBrightTotal == 0.0)
+            break;
+
+        // Variance between the classes...
+        double const dDarkMean      = dDarkSum / dDarkTotal;
+        double const dBrightMean    = (dTotalSum - dDarkSum) / dBrightTotal;
+        double const dVariance      = dDarkTotal * dBrightTotal *
+            (dDarkMean - dBrightMean) * (dDarkMean - dBrightMean);
+
+        // Best so far...
+        if(dVariance > dBestVariance)
+        {
+            dBestVariance   = dVariance;
+            unBest          = unBin;
+        }
+    }
+
+    // Done...
+    return unBest;
+}
+
+// Pick the threshold furthest below the line from the histogram's peak to the
+//  end of its longer tail... θ(n) in bins
+unsigned int ThresholdCalibrator::EstimateTriangle() const
+{
+    // Variables...
+    int const   nBins       = (int) Histogram.size();
+    int         nLowest     = 0;
+    int         nHighest    = nBins - 1;
+    int         nPeak       = 0;
+
+    // Find the lowest and highest intensities present, and the most common...
+    while(nLowest < nBins - 1 && Histogram[nLowest] == 0.0)
+      ++nLowest;
+    while(nHighest > nLowest && Histogram[nHighest] == 0.0)
+      --nHighest;
+    for(int nBin = nLowest; nBin <= nHighest; ++nBin)
+    {
+        if(Histogram[nBin] > Histogram[nPeak])
+            nPeak = nBin;
+    }
+
+    // Draw the line to whichever end is further from the peak. The worms are
+    //  the tail...
+    int const nEnd = (nPeak - nLowest > nHighest - nPeak) ? nLowest : nHighest;
+
+        // Nothing but the peak...
+        if(nEnd == nPeak)
+            return nPeak;
+
+    // Find the intensity between them furthest below the line. Each
+    //  distance is only scaled by the line's length, which is the same for
+    //  all, so there is no need to divide by it...
+    int const       nStep           = (nEnd < nPeak) ? 1 : -1;
+    double const    dRise           = Histogram[nPeak] - Histogram[nEnd];
+    double const    dRun            = std::abs(nPeak - nEnd);
+    double          dBestDistance   = -1.0;
+    int             nBest           = nEnd;
+    for(int nBin = nEnd; nBin != nPeak; nBin += nStep)
+    {
+        // Distance below the line...
+        double const dDistance = dRise * std::abs(nBin - nEnd) -
+                                 dRun * (Histogram[nBin] - Histogram[nEnd]);
+
+        // Furthest so far...
+        if(dDistance > dBestDistance)
+        {
+            dBestDistance   = dDistance;
+            nBest           = nBin;
+        }
+    }
+
+    // Done...
+    return (unsigned int) nBest;
+}
+
+// Find the area half of all the dark blob area is in blobs no larger than.
+//  Weighting by area keeps the many specks from outvoting the worms...
+double ThresholdCalibrator::FindMedianArea() const
+{
+    // Nothing measured...
+    if(BlobAreas.empty())
+        return 0.0;
+
+    // Smallest first...
+    vector<double> SortedAreas(BlobAreas);
+    std::sort(SortedAreas.begin(), SortedAreas.end());
+
+    // Total area...
+    double dTotal = 0.0;
+    for(unsigned int unIndex = 0; unIndex < SortedAreas.size(); ++unIndex)
+        dTotal += SortedAreas[unIndex];
+
+    // Find the blob that takes the running total past half of it...
+    double dRunning = 0.0;
+    for(unsigned int unIndex = 0; unIndex < SortedAreas.size(); ++unIndex)
+    {
+        dRunning += SortedAreas[unIndex];
+        if(2.0 * dRunning >= dTotal)
+            return SortedAreas[unIndex];
+    }
+
+    // Unreachable, but keep the compiler happy...
+    return SortedAreas.back();
+}
+
+// Get the blob area window, in pixels², around the area most of the dark blob
+//  area is in at the threshold. False if no blobs have been seen...
+bool ThresholdCalibrator::GetAreaWindow(
+    double &dMinimum, double &dMaximum) const
+{
+    // Nothing measured...
+    if(BlobAreas.empty())
+        return false;
+
+    // Half to twice the median, which allows for worms of every age and
+    //  posture on the same plate...
+    dMinimum = dMedianArea / 2.0;
+    dMaximum = dMedianArea * 2.0;
+
+    // Done...
+    return true;
+}
+
+// Get the number of frames sampled since the last reset...
+unsigned int ThresholdCalibrator::GetFramesSampled() const
+{
+    // Return it...
+    return unFramesSampled;
+}
+
+// Get the threshold estimated so far...
+unsigned int ThresholdCalibrator::GetThreshold() const
+{
+    // Return it...
+    return unThreshold;
+}
+
+// Has the estimate stopped changing?
+bool ThresholdCalibrator::IsConverged() const
+{
+    // Held still for long enough...
+    return (unStableFrames >= STABLE_FRAMES);
+}
+
+// Threshold the frame and add the area of each blob of the rarer class not cut
+//  off by its edge to those already measured...
+void ThresholdCalibrator::MeasureBlobs(cv::Mat const &GrayImage)
+{
+    // Variables...
+    double dDark    = 0.0;
+    double dTotal   = 0.0;
+
+    // Worms are the rarer class, usually dark on a bright plate...
+    for(unsigned int unBin = 0; unBin < Histogram.size(); ++unBin)
+    {
+        dTotal += Histogram[unBin];
+        if(unBin <= unThreshold)
+            dDark += Histogram[unBin];
+    }
+    bool const bDarkWorms = (2.0 * dDark <= dTotal);
+
+    // Make them the foreground, and find the outline of each...
+    cv::threshold(GrayImage, BinaryImage, unThreshold, 0xff,
+                  bDarkWorms ? cv::THRESH_BINARY_INV : cv::THRESH_BINARY);
+    cv::findContours(BinaryImage, Contours, cv::RETR_EXTERNAL,
+                     cv::CHAIN_APPROX_SIMPLE);
+
+    // Measure each...
+    for(unsigned int unContour = 0; unContour < Contours.size(); ++unContour)
+    {
+        // Cut off by the edge of the frame, which the tracker ignores...
+        cv::Rect const Bounds = cv::boundingRect(Contours[unContour]);
+        if(Bounds.x == 0 || Bounds.y == 0 ||
+           Bounds.br().x == GrayImage.cols ||
+           Bounds.br().y == GrayImage.rows)
+            continue;
+
+        // Too small to be anything but noise...
+        double const dArea = cv::contourArea(Contours[unContour]);
+        if(dArea < MINIMUM_BLOB_AREA)
+            continue;
+
+        // Remember it...
+        BlobAreas.push_back(dArea);
+    }
+}
+
+// Forget every frame sampled so far...
+void ThresholdCalibrator::Reset()
+{
+    // Clear everything...
+    std::fill(Histogram.begin(), Histogram.end(), 0.0);
+    unThreshold     = 0;
+    dMedianArea     = 0.0;
+    BlobAreas.clear();
+    unStableFrames  = 0;
+    unFramesSampled = 0;
+}
+
+// Set how to pick the threshold from the histogram...
+void ThresholdCalibrator::SetMethod(Method const _CurrentMethod)
+{
+    // Store, and start sampling again...
+    CurrentMethod = _CurrentMethod;
+    Reset();
+}
+
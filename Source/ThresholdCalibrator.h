@@ -0,0 +1,139 @@
+/*
+  Name:         ThresholdCalibrator.h (definition)
+  Author:       Kip Warner (Kip@TheVertigo.com)
+  Description:  ThresholdCalibrator class. Picks a threshold and a candidate
+                size window from a sample of frames, building an intensity
+                histogram up a frame at a time until the estimate settles...
+*/
+
+// Multiple include protection...
+#ifndef _THRESHOLDCALIBRATOR_H_
+#define _THRESHOLDCALIBRATOR_H_
+
+// Includes...
+
+    // OpenCV...
+    #include <opencv2/core/core.hpp>
+
+    // Standard libraries and STL...
+    #include <vector>
+
+    // Using the standard namespace...
+    using namespace std;
+
+// ThresholdCalibrator class...
+class ThresholdCalibrator
+{
+    // Public types...
+    public:
+
+        // How to pick the threshold from the histogram. Otsu's suits plates
+        //  where the worms take up much of the frame, and the triangle
+        //  method the usual sparse plate, where they are a thin tail on the
+        //  side of the background's peak...
+        typedef enum Method
+        {
+            OTSU,
+            TRIANGLE
+        }Method;
+
+    // Public methods...
+    public:
+
+        // Default constructor...
+        ThresholdCalibrator();
+
+        // Accessors...
+
+            // Get the blob area window, in pixels², around the area most of
+            //  the dark blob area is in at the threshold. False if no blobs
+            //  have been seen...
+            bool                GetAreaWindow(double &dMinimum,
+                                              double &dMaximum) const;
+
+            // Get the number of frames sampled since the last reset...
+            unsigned int        GetFramesSampled() const;
+
+            // Get the threshold estimated so far...
+            unsigned int        GetThreshold() const;
+
+            // Has the estimate stopped changing?
+            bool                IsConverged() const;
+
+        // Mutators...
+
+            // Add an 8-bit grayscale frame, already prepared the way the
+            //  tracker thresholds it, to the sample. True once the estimate
+            //  has converged...
+            bool                AddFrame(cv::Mat const &GrayImage);
+
+            // Forget every frame sampled so far...
+            void                Reset();
+
+            // Set how to pick the threshold from the histogram. Forgets
+            //  every frame sampled so far...
+            void                SetMethod(Method const _CurrentMethod);
+
+    // Protected constants...
+    protected:
+
+        // Sample every so many pixels across and down, how many frames in a
+        //  row the estimate must hold still for, and the smallest blob worth
+        //  measuring in pixels²...
+        enum
+        {
+            HISTOGRAM_STRIDE    = 2,
+            STABLE_FRAMES       = 3,
+            MINIMUM_BLOB_AREA   = 16
+        };
+
+    // Protected methods...
+    protected:
+
+        // Accessors...
+
+            // Pick the threshold that best separates the histogram's two
+            //  classes, by Otsu's method... θ(n) in bins
+            unsigned int        EstimateOtsu() const;
+
+            // Pick the threshold furthest below the line from the
+            //  histogram's peak to the end of its longer tail... θ(n) in bins
+            unsigned int        EstimateTriangle() const;
+
+            // Find the area half of all the dark blob area is in blobs no
+            //  larger than...
+            double              FindMedianArea() const;
+
+        // Mutators...
+
+            // Threshold the frame and add the area of each blob of the rarer
+            //  class not cut off by its edge to those already measured...
+            void                MeasureBlobs(cv::Mat const &GrayImage);
+
+    // Protected attributes...
+    protected:
+
+        // How to pick the threshold...
+        Method                          CurrentMethod;
+
+        // Pixels sampled at each intensity, over every frame so far...
+        vector<double>                  Histogram;
+
+        // The threshold and median blob area estimated after the last frame,
+        //  the areas of the blobs measured at about that threshold, and how
+        //  many frames in a row neither has moved...
+        unsigned int                    unThreshold;
+        double                          dMedianArea;
+        vector<double>                  BlobAreas;
+        unsigned int                    unStableFrames;
+
+        // Frames sampled...
+        unsigned int                    unFramesSampled;
+
+        // Blob measurement scratch, reused between frames...
+        cv::Mat                         BinaryImage;
+        vector<vector<cv::Point> >      Contours;
+};
+
+#endif
+
@@ -0,0 +1,239 @@
+/*
+  Name:         TimeSeriesPool.cpp (implementation)
+  Author:       Kip Warner (Kip@TheVertigo.com)
+  Description:  TimeSeriesPool class. Keeps every worm's measurements from
+                every frame it was seen in, in fixed size chunks drawn from a
+                shared pool, spilling the oldest to disk on long recordings...
+*/
+
+// Includes...
+#include "TimeSeriesPool.h"
+#include <algorithm>
+#include <cstring>
+
+// Default constructor...
+TimeSeriesPool::TimeSeriesPool()
+    : unResidentChunks(0),
+      unResidentLimit(DEFAULT_RESIDENT_LIMIT),
+      pSpillFile(NULL),
+      lSpillEnd(0),
+      unSpilledChunks(0)
+{
+
+}
+
+// Add a sample to the end of a series, making it and any before it if there
+//  weren't that many yet... θ(1) amortized
+void TimeSeriesPool::Append(
+    unsigned int const unSeries, WormSample const &Sample)
+{
+    // A new series...
+    if(unSeries >= SeriesTable.size())
+        SeriesTable.resize(unSeries + 1);
+
+    // Where in its last chunk this sample goes...
+    Series &Current = SeriesTable[unSeries];
+    unsigned int const unOffset = Current.unSamples % CHUNK_SAMPLES;
+
+        // That one is full, or there isn't one yet, so start another, which
+        //  may put more in memory than allowed...
+        if(unOffset == 0)
+        {
+            ChunkLocation const Location = { TakeChunk(), -1 };
+            Current.Chunks.push_back(Location);
+          ++unResidentChunks;
+            SpillOldest();
+        }
+
+    // Store...
+    Current.Chunks.back().pChunk->Samples[unOffset] = Sample;
+  ++Current.unSamples;
+
+    // Filled it, so it can be spilled now, as can any older...
+    if(unOffset + 1 == CHUNK_SAMPLES)
+    {
+        FullChunks.push_back(make_pair(
+            unSeries, (unsigned int) Current.Chunks.size() - 1));
+        SpillOldest();
+    }
+}
+
+// Forget every series, keeping the chunks for reuse...
+void TimeSeriesPool::Clear()
+{
+    // Return every chunk still in memory to the pool...
+    for(vector<Series>::const_iterator Iterator = SeriesTable.begin();
+        Iterator != SeriesTable.end();
+      ++Iterator)
+    {
+        for(unsigned int unChunk = 0; unChunk < Iterator->Chunks.size();
+          ++unChunk)
+        {
+            if(Iterator->Chunks[unChunk].pChunk)
+                FreeChunks.push_back(Iterator->Chunks[unChunk].pChunk);
+        }
+    }
+
+    // Forget the series, and write over the spill file from the start...
+    SeriesTable.clear();
+    FullChunks.clear();
+    unResidentChunks    = 0;
+    lSpillEnd           = 0;
+    unSpilledChunks     = 0;
+}
+
+// Get how many chunks can be in memory before the oldest full ones are
+//  spilled, or zero for no limit...
+unsigned int TimeSeriesPool::GetResidentLimit() const
+{
+    // Return it...
+    return unResidentLimit;
+}
+
+// Get the number of samples in a series...
+unsigned int TimeSeriesPool::GetSampleCount(unsigned int const unSeries) const
+{
+    // Series we never heard of are empty...
+    if(unSeries >= SeriesTable.size())
+        return 0;
+
+    // Return it...
+    return SeriesTable[unSeries].unSamples;
+}
+
+// Get every sample in a series, oldest first, reading back any that were
+//  spilled... θ(n)
+bool TimeSeriesPool::GetSamples(
+    unsigned int const unSeries, vector<WormSample> &Samples) const
+{
+    // Series we never heard of are empty...
+    Samples.clear();
+    if(unSeries >= SeriesTable.size())
+        return true;
+
+    // Make room for all of them...
+    Series const &Requested = SeriesTable[unSeries];
+    Samples.resize(Requested.unSamples);
+
+    // Copy each chunk's samples out...
+    for(unsigned int unChunk = 0; unChunk < Requested.Chunks.size(); ++unChunk)
+    {
+        // Variables...
+        ChunkLocation const    &Location    = Requested.Chunks[unChunk];
+        unsigned int const      unFirst     = unChunk * CHUNK_SAMPLES;
+        unsigned int const      unCount     = std::min<unsigned int>(
+            CHUNK_SAMPLES, Requested.unSamples - unFirst);
+
+        // Still in memory...
+        if(Location.pChunk)
+        {
+            memcpy(&Samples[unFirst], Location.pChunk->Samples,
+                   unCount * sizeof(WormSample));
+            continue;
+        }
+
+        // Otherwise read it back from where it was spilled...
+        if(fseek(pSpillFile, Location.lOffset, SEEK_SET) != 0 ||
+           fread(&Samples[unFirst], sizeof(WormSample), unCount, pSpillFile)
+                != unCount)
+        {
+            Samples.clear();
+            return false;
+        }
+    }
+
+    // Done...
+    return true;
+}
+
+// Get the number of series, including any still empty...
+unsigned int TimeSeriesPool::GetSeriesCount() const
+{
+    // Return it...
+    return (unsigned int) SeriesTable.size();
+}
+
+// Get the number of chunks spilled to disk since the last clear...
+unsigned int TimeSeriesPool::GetSpilledChunks() const
+{
+    // Return it...
+    return unSpilledChunks;
+}
+
+// Spill the oldest full chunks to a temporary file once more than so many are
+//  in memory, or zero never to...
+void TimeSeriesPool::SetResidentLimit(unsigned int const _unResidentLimit)
+{
+    // Store, and spill whatever is now over it...
+    unResidentLimit = _unResidentLimit;
+    SpillOldest();
+}
+
+// Spill the oldest full chunks in memory until no more than the limit are.
+//  Any that can't be spilled stay in memory...
+void TimeSeriesPool::SpillOldest()
+{
+    // No limit...
+    if(unResidentLimit == 0)
+        return;
+
+    // Spill until under it, or there are no full chunks left to...
+    while(unResidentChunks > unResidentLimit && !FullChunks.empty())
+    {
+        // Open the spill file the first time it's needed. It is removed when
+        //  it is closed, however we exit...
+        if(!pSpillFile)
+        {
+            pSpillFile = tmpfile();
+            if(!pSpillFile)
+                return;
+        }
+
+        // Write out the oldest at the end of it...
+        ChunkLocation &Oldest = SeriesTable[FullChunks.front().first].
+            Chunks[FullChunks.front().second];
+        if(fseek(pSpillFile, lSpillEnd, SEEK_SET) != 0 ||
+           fwrite(Oldest.pChunk, sizeof(Chunk), 1, pSpillFile) != 1)
+            return;
+
+        // Note where it went, and return its memory to the pool...
+        FreeChunks.push_back(Oldest.pChunk);
+        Oldest.pChunk   = NULL;
+        Oldest.lOffset  = lSpillEnd;
+        lSpillEnd      += sizeof(Chunk);
+      --unResidentChunks;
+      ++unSpilledChunks;
+        FullChunks.pop_front();
+    }
+}
+
+// Take a chunk from the pool, allocating it only if there are none to reuse...
+TimeSeriesPool::Chunk *TimeSeriesPool::TakeChunk()
+{
+    // Reuse one...
+    if(!FreeChunks.empty())
+    {
+        Chunk *pChunk = FreeChunks.back();
+        FreeChunks.pop_back();
+        return pChunk;
+    }
+
+    // Otherwise allocate another, and remember it to free later...
+    AllChunks.push_back(new Chunk);
+    return AllChunks.back();
+}
+
+// Deconstructor...
+TimeSeriesPool::~TimeSeriesPool()
+{
+    // Free every chunk...
+    for(vector<Chunk *>::const_iterator Iterator = AllChunks.begin();
+        Iterator != AllChunks.end();
+      ++Iterator)
+        delete *Iterator;
+
+    // Close the spill file, which removes it...
+    if(pSpillFile)
+        fclose(pSpillFile);
+}
+
@@ -0,0 +1,200 @@
+/*
+  Name:         TimeSeriesPool.h (definition)
+  Author:       Kip Warner (Kip@TheVertigo.com)
+  Description:  TimeSeriesPool class. Keeps every worm's measurements from
+                every frame it was seen in, in fixed size chunks drawn from a
+                shared pool, spilling the oldest to disk on long recordings...
+*/
+
+// Multiple include protection...
+#ifndef _TIMESERIESPOOL_H_
+#define _TIMESERIESPOOL_H_
+
+// Includes...
+
+    // Standard libraries and STL...
+    #include <cstdio>
+    #include <deque>
+    #include <utility>
+    #include <vector>
+
+    // Using the standard namespace...
+    using namespace std;
+
+// A worm as it was in one frame. Positions are in pixels, the length and width
+//  in pixels, and the area in pixels². Then its posture, just as the worm 
+//  described it, in about a hundred bytes more...
+typedef struct WormSample
+{
+    // Tangent angles along the midline, and the most posture modes, the same
+    //  as the worm's...
+    enum
+    {
+        POSTURE_ANGLES          = 32,
+        MAXIMUM_POSTURE_MODES   = 8
+    };
+
+    // Frame it was seen in, by where it was in its video...
+    unsigned int    unFrame;
+
+    // Where its centre, head, and tail were...
+    short           CentreX;
+    short           CentreY;
+    short           HeadX;
+    short           HeadY;
+    short           TailX;
+    short           TailY;
+
+    // Its length, width, and area in that frame alone...
+    float           fLength;
+    float           fWidth;
+    float           fArea;
+
+    // Its posture, if its midline could be traced. The tangent angle of each
+    //  midline segment from head to tail less their mean, in steps of a 
+    //  Worm::POSTURE_ANGLE_STEPS th of a radian, and how far they go along
+    //  each mode of the posture basis, if there was one...
+    short           TangentAngles[POSTURE_ANGLES];
+    float           Projections[MAXIMUM_POSTURE_MODES];
+    unsigned char   unPostureModes;
+    bool            bPostureValid;
+
+}WormSample;
+
+// TimeSeriesPool class...
+class TimeSeriesPool
+{
+    // Public methods...
+    public:
+
+        // Default constructor...
+        TimeSeriesPool();
+
+        // Accessors...
+
+            // Get how many chunks can be in memory before the oldest full
+            //  ones are spilled, or zero for no limit...
+            unsigned int        GetResidentLimit() const;
+
+            // Get the number of samples in a series...
+            unsigned int        GetSampleCount(
+                                    unsigned int const unSeries) const;
+
+            // Get every sample in a series, oldest first, reading back any
+            //  that were spilled. False if they couldn't be read... θ(n)
+            bool                GetSamples(unsigned int const unSeries,
+                                           vector<WormSample> &Samples) const;
+
+            // Get the number of series, including any still empty...
+            unsigned int        GetSeriesCount() const;
+
+            // Get the number of chunks spilled to disk since the last clear...
+            unsigned int        GetSpilledChunks() const;
+
+        // Mutators...
+
+            // Add a sample to the end of a series, making it and any before it
+            //  if there weren't that many yet. No allocation but for a new
+            //  chunk every CHUNK_SAMPLES samples, and none once chunks are
+            //  being reused... θ(1) amortized
+            void                Append(unsigned int const unSeries,
+                                       WormSample const &Sample);
+
+            // Forget every series, keeping the chunks for reuse...
+            void                Clear();
+
+            // Spill the oldest full chunks to a temporary file once more than
+            //  so many are in memory, or zero never to...
+            void                SetResidentLimit(
+                                    unsigned int const _unResidentLimit);
+
+        // Deconstructor...
+       ~TimeSeriesPool();
+
+    // Protected constants...
+    protected:
+
+        // Samples in each chunk, and how many chunks can be in memory before
+        //  spilling by default, which is about sixty megabytes...
+        enum
+        {
+            CHUNK_SAMPLES           = 1024,
+            DEFAULT_RESIDENT_LIMIT  = 512
+        };
+
+    // Protected types...
+    protected:
+
+        // A chunk of samples...
+        typedef struct Chunk
+        {
+            WormSample          Samples[CHUNK_SAMPLES];
+        }Chunk;
+
+        // Where one of a series' chunks is. In memory, or else at an offset
+        //  into the spill file...
+        typedef struct ChunkLocation
+        {
+            Chunk              *pChunk;
+            long                lOffset;
+        }ChunkLocation;
+
+        // A series of samples, in chunks...
+        typedef struct Series
+        {
+            // Inline constructor initializer...
+            Series()
+                : unSamples(0)
+            {
+            }
+
+            // Its chunks, oldest first, and how many samples are in them...
+            vector<ChunkLocation>   Chunks;
+            unsigned int            unSamples;
+
+        }Series;
+
+    // Protected methods...
+    protected:
+
+        // Not copyable, since it owns its chunks and spill file...
+        TimeSeriesPool(TimeSeriesPool const &);
+        TimeSeriesPool &operator=(TimeSeriesPool const &);
+
+        // Mutators...
+
+            // Spill the oldest full chunks in memory until no more than the
+            //  limit are. Any that can't be spilled stay in memory...
+            void                SpillOldest();
+
+            // Take a chunk from the pool, allocating it only if there are
+            //  none to reuse...
+            Chunk              *TakeChunk();
+
+    // Protected attributes...
+    protected:
+
+        // Every series...
+        vector<Series>          SeriesTable;
+
+        // Every chunk ever allocated, and those not in use...
+        vector<Chunk *>         AllChunks;
+        vector<Chunk *>         FreeChunks;
+
+        // Full chunks still in memory, oldest first, by series and chunk...
+        deque<pair<unsigned int, unsigned int> >    FullChunks;
+
+        // Chunks in use and in memory, and how many are allowed before the
+        //  oldest full ones are spilled, or zero for no limit...
+        unsigned int            unResidentChunks;
+        unsigned int            unResidentLimit;
+
+        // Temporary spill file, opened on first use and removed on close,
+        //  where it ends, and how many chunks have been spilled to it...
+        FILE                   *pSpillFile;
+        long                    lSpillEnd;
+        unsigned int            unSpilledChunks;
+};
+
+#endif
+
@@ -18,47 +18,57 @@
     // For assistance with debugging...
     #include <cassert>
 
+    // Binary search...
+    #include <algorithm>
+
+    // Vectorized arctangent...
+    #include <opencv2/core/hal/hal.hpp>
+
 // Within the SlitherMath namespace...
 using namespace SlitherMath;
 
 // Statics...
 
-    // Dummy default argument parameters...
-    unsigned int Worm::unDummy = 0;
+    // Use the reference algorithms...
+    bool Worm::bReferenceMode = false;
+
+    // No posture basis until one is set...
+    std::vector<float>  Worm::PostureBasis;
+    unsigned int        Worm::unPostureModes = 0;
 
 // Default constructor...
 Worm::Worm()
-    : pStorage(cvCreateMemStorage(0)),
-      pContour(NULL),
+    : CurrentPosture(),
       unRefreshes(0),
+      unLengthRefreshes(0),
       dArea(0.0f),
       GravitationalCentre(cvPoint(0, 0)),
       dLength(0.0f), 
+      dHalfPerimeter(0.0),
       dWidth(0.0f),
+      dFrameLength(0.0),
+      dFrameWidth(0.0),
       TerminalA(cvPoint(0, 0), 0),
       TerminalB(cvPoint(0, 0), 0)
 {
-    // Allocatation of base storage for contour and anything else we need failed...
-    if(!pStorage)
-        throw std::bad_alloc();
+
 }
 
 // Worm construction requires to just know it's contour and a bit of information about the image it rests on...
-Worm::Worm(CvContour const &Contour, IplImage const &GrayImage)
-    : pStorage(cvCreateMemStorage(0)),
-      pContour(NULL),
+Worm::Worm(Outline const &Contour, cv::Mat const &GrayImage)
+    : CurrentPosture(),
       unRefreshes(0),
+      unLengthRefreshes(0),
       dArea(0.0f),
       GravitationalCentre(cvPoint(0, 0)),
       dLength(0.0f), 
+      dHalfPerimeter(0.0),
       dWidth(0.0f),
+      dFrameLength(0.0),
+      dFrameWidth(0.0),
       TerminalA(cvPoint(0, 0), 0),
       TerminalB(cvPoint(0, 0), 0)
 {    
-    // Allocatation of base storage for contour and anything else we need failed...
-    if(!pStorage)
-        throw std::bad_alloc();
-
     // Refresh the worm's metrics based on the contour...
     Refresh(Contour, GrayImage);
 }
@@ -85,23 +95,283 @@ CvPoint const &Worm::Centre() const
 }
 
 // Get the worm's contour...
-CvContour const &Worm::Contour() const
+Outline const &Worm::Contour() const
+{
+    // Return it...
+    return CurrentContour;
+}
+
+// Signed curvature along the midline in this frame, in radians per pixel, at 
+//  each of its points but the two ends...
+std::vector<float> const &Worm::Curvature() const
 {
     // Return it...
-    return *pContour;
+    return MidlineCurvature;
+}
+
+// Find the closest edge on the other side of the worm that the orthogonal 
+//  pierces, by testing only the edges that the edge grid places near the 
+//  orthogonal. Ties go to whichever edge the reference would have seen first, 
+//  so both always agree...
+inline unsigned int Worm::FindOppositeVertexIndex(
+    unsigned int const &unStartVertexIndex,
+    LineSegment const &StartingLineSegment,
+    LineSegment const &OrthogonalLineSegment)
+{
+    // Variables...
+    unsigned int const  unVertices                  = CurrentContour.Size();
+    unsigned int        unClosestVertexIndexFound   = 0;
+    unsigned int        unClosestStepsFound         = unVertices;
+    double              dClosestDistanceFound       = Infinity;
+
+    // Gather only those edges near the orthogonal...
+    ContourEdges.Query(OrthogonalLineSegment, CandidateEdges);
+
+    // Keep those the reference would consider, laying their ends out side by
+    //  side for testing all at once...
+    CandidateStarts.X.resize(CandidateEdges.size());
+    CandidateStarts.Y.resize(CandidateEdges.size());
+    CandidateEnds.X.resize(CandidateEdges.size());
+    CandidateEnds.Y.resize(CandidateEdges.size());
+    unsigned int unCandidates = 0;
+    for(vector<unsigned int>::const_iterator Iterator = CandidateEdges.begin();
+        Iterator != CandidateEdges.end();
+      ++Iterator)
+    {
+        // How many steps around from the starting vertex is this edge?
+        unsigned int const unCandidateVertexIndex = *Iterator;
+        unsigned int const unSteps = 
+            (unCandidateVertexIndex + unVertices - unStartVertexIndex) % 
+                unVertices;
+
+        // The reference never considers the two edges either side of the 
+        //  starting vertex...
+        if(unSteps == 0 || unSteps == unVertices - 1)
+            continue;
+
+        // Keep it. The closed contour repeats the first vertex at the end, so
+        //  the next one along is always just after...
+        CandidateEdges[unCandidates]    = unCandidateVertexIndex;
+        CandidateStarts.X[unCandidates] = 
+            ContourPoints.X[unCandidateVertexIndex];
+        CandidateStarts.Y[unCandidates] = 
+            ContourPoints.Y[unCandidateVertexIndex];
+        CandidateEnds.X[unCandidates]   = 
+            ContourPoints.X[unCandidateVertexIndex + 1];
+        CandidateEnds.Y[unCandidates]   = 
+            ContourPoints.Y[unCandidateVertexIndex + 1];
+      ++unCandidates;
+    }
+
+    // Check all of them at once for those that the orthogonal pierces...
+    CandidateIntersects.resize(unCandidates);
+    if(unCandidates > 0)
+        IsLineSegmentIntersectingEdges(
+            OrthogonalLineSegment, &CandidateStarts.X[0], 
+            &CandidateStarts.Y[0], &CandidateEnds.X[0], &CandidateEnds.Y[0],
+            unCandidates, &CandidateIntersects[0]);
+
+    // Find the closest of those it does...
+    for(unsigned int unCandidate = 0; unCandidate < unCandidates; 
+      ++unCandidate)
+    {
+        // Doesn't intersect the orthogonal...
+        if(!CandidateIntersects[unCandidate])
+            continue;
+
+        // How many steps around from the starting vertex is this edge?
+        unsigned int const unCandidateVertexIndex = CandidateEdges[unCandidate];
+        unsigned int const unSteps = 
+            (unCandidateVertexIndex + unVertices - unStartVertexIndex) % 
+                unVertices;
+
+        // The line segment it was...
+        LineSegment CandidateLineSegment(
+            cvPoint2D32f(CandidateStarts.X[unCandidate], 
+                         CandidateStarts.Y[unCandidate]), 
+            cvPoint2D32f(CandidateEnds.X[unCandidate], 
+                         CandidateEnds.Y[unCandidate]));
+
+        // How far away were they?
+        double const dDistanceBetweenMiddleOfLineSegments = 
+            DistanceBetweenLineSegments(StartingLineSegment, 
+                                        CandidateLineSegment);
+
+        // Was distance closer than anything encountered thus far, or as close
+        //  but sooner around the contour?
+        if(dDistanceBetweenMiddleOfLineSegments < dClosestDistanceFound ||
+           (dDistanceBetweenMiddleOfLineSegments == dClosestDistanceFound && 
+            unSteps < unClosestStepsFound))
+        {
+            // Make a note of where it was and how far away it was...
+            unClosestVertexIndexFound   = unCandidateVertexIndex;
+            unClosestStepsFound         = unSteps;
+            dClosestDistanceFound       = dDistanceBetweenMiddleOfLineSegments;
+        }
+    }
+
+    // Return the index...
+    return unClosestVertexIndexFound;
+}
+
+// Find the closest edge on the other side of the worm that the orthogonal 
+//  pierces, by testing every edge. This is the reference for 
+//  FindOppositeVertexIndex()... θ(n)
+inline unsigned int Worm::FindOppositeVertexIndexLinearly(
+    unsigned int const &unStartVertexIndex,
+    LineSegment const &StartingLineSegment,
+    LineSegment const &OrthogonalLineSegment) const
+{
+    // Variables...
+    unsigned int        unCurrentOppositeVertexIndex        = 0;
+    unsigned int        unClosestOppositeVertexIndexFound   = 0;
+    double              dClosestOppositeVertexDistanceFound = Infinity;
+
+    // Start searching beginning with the next neighbour of our starting 
+    //  segment...
+    unCurrentOppositeVertexIndex = GetNextVertexIndex(unStartVertexIndex);
+    
+    // Now go around the creature, looking for those segments that the 
+    //  above pierces...
+    while(unStartVertexIndex != 
+          GetNextVertexIndex(unCurrentOppositeVertexIndex))
+    {
+        // The line segment we are going to test...
+        LineSegment CandidateLineSegment(
+            cvPointTo32f(GetVertex(unCurrentOppositeVertexIndex)), 
+            cvPointTo32f(GetVertex(
+                    GetNextVertexIndex(unCurrentOppositeVertexIndex))));
+        
+        // Ah ha! We have found a segment that intersects the orthogonal...
+        if(IsLineSegmentsIntersect(OrthogonalLineSegment, 
+                                   CandidateLineSegment))
+        {
+            // How far away were they?
+            double const dDistanceBetweenMiddleOfLineSegments = 
+                DistanceBetweenLineSegments(StartingLineSegment, 
+                                            CandidateLineSegment);
+            
+            // Was distance closer than anything encountered thus far?
+            if(dDistanceBetweenMiddleOfLineSegments < 
+               dClosestOppositeVertexDistanceFound)
+            {
+                // Make a note of where it was and how far away it was...
+                unClosestOppositeVertexIndexFound   = 
+                    unCurrentOppositeVertexIndex;
+                dClosestOppositeVertexDistanceFound = 
+                    dDistanceBetweenMiddleOfLineSegments;
+            }
+        }
+        
+        // Let's move to the next segment and try that one...
+        unCurrentOppositeVertexIndex = 
+            GetNextVertexIndex(unCurrentOppositeVertexIndex);
+    }
+
+    // Return the index...
+    return unClosestOppositeVertexIndexFound;
 }
 
 // Find the vertex on the contour the given length away, starting in increasing 
-//  order... O(n)
+//  order... O(log n)
+inline unsigned int const Worm::FindVertexIndexByLength(
+    unsigned int const &unStartVertexIndex, 
+    double const &dPerimeterLength) const
+{
+    // Count the vertices passed somewhere of our own. A shared dummy would be
+    //  written by every worm refreshing at once...
+    unsigned int unVerticesTraversed = 0;
+
+    // Find it...
+    return FindVertexIndexByLength(
+        unStartVertexIndex, dPerimeterLength, unVerticesTraversed);
+}
+
+// Find the vertex on the contour the given length away, starting in increasing 
+//  order, also counting the vertices passed along the way. The arc length 
+//  table turns the walk into a binary search... O(log n)
 inline unsigned int const Worm::FindVertexIndexByLength(
     unsigned int const &unStartVertexIndex, 
     double const &dPerimeterLength,
     unsigned int &unVerticesTraversed) const
 {
-    /* TODO: We can do much better than this right down to logarithmic time by 
-             using a skip list some how. Deal with it later after we're sure 
-             this one even works properly at all. */
+    // Walk it instead, if asked...
+    if(bReferenceMode)
+        return FindVertexIndexByLengthLinearly(
+            unStartVertexIndex, dPerimeterLength, unVerticesTraversed);
 
+    // Variables...
+    unsigned int const  unVertices  = CurrentContour.Size();
+    double const        dPerimeter  = ArcLengths.back();
+
+    // This should never happen, so we make sure...
+    assert(unStartVertexIndex < unVertices);
+
+    // Nowhere to go, or no way to get there...
+    if(dPerimeterLength == 0.0 || dPerimeter <= 0.0)
+    {
+        // We haven't moved...
+        unVerticesTraversed = 0;
+        return unStartVertexIndex;
+    }
+
+    // Where we want to end up as arc length from the first vertex, and how
+    //  many laps around the contour it takes to get there. Past the first lap,
+    //  each lap adds the full perimeter to the arc length...
+    double const    dTarget     = ArcLengths[unStartVertexIndex] + 
+                                  dPerimeterLength;
+    double          dLaps       = floor(dTarget / dPerimeter);
+    double          dRemainder  = dTarget - dLaps * dPerimeter;
+
+    // Walking forwards, stop at the first vertex at least that far along...
+    if(dPerimeterLength > 0)
+    {
+        // Landing exactly on the first vertex is the end of the previous lap,
+        //  in case the last few vertices are there too...
+        if(dRemainder <= 0.0 && dLaps > 0.0)
+        {
+            dLaps      -= 1.0;
+            dRemainder  = dPerimeter;
+        }
+
+        // Search...
+        unsigned int const unArcIndex = 
+            std::lower_bound(ArcLengths.begin(), ArcLengths.end(), dRemainder) 
+                - ArcLengths.begin();
+
+        // Count the vertices we passed...
+        unVerticesTraversed = 
+            (unsigned int) dLaps * unVertices + unArcIndex - unStartVertexIndex;
+
+        // The arc index past the last vertex is the first vertex again...
+        return unArcIndex % unVertices;
+    }
+
+    // Walking backwards, stop at the last vertex at most that far along...
+    else
+    {
+        // Search...
+        unsigned int const unArcIndex = 
+            std::upper_bound(ArcLengths.begin(), ArcLengths.end(), dRemainder) 
+                - ArcLengths.begin() - 1;
+
+        // Count the vertices we passed. The laps are zero or negative...
+        unVerticesTraversed = unStartVertexIndex - unArcIndex + 
+                              (unsigned int) -dLaps * unVertices;
+
+        // The arc index past the last vertex is the first vertex again...
+        return unArcIndex % unVertices;
+    }
+}
+
+// Find the vertex on the contour the given length away by walking there one
+//  vertex at a time. This is the reference for FindVertexIndexByLength()... 
+//  O(n)
+inline unsigned int const Worm::FindVertexIndexByLengthLinearly(
+    unsigned int const &unStartVertexIndex, 
+    double const &dPerimeterLength,
+    unsigned int &unVerticesTraversed) const
+{
     // Variables...
     register    double          dDistanceWalkedAccumulator  = 0.0f;
                 unsigned int    unCurrentVertexIndex        = 0;
@@ -153,7 +423,7 @@ inline unsigned int const Worm::FindVertexIndexByLength(
 
 /* Get the average brightness of the area within a contour...
 inline double const Worm::GetAverageBrightness(CvContour const &Contour,
-                                               IplImage const &GrayImage) const
+                                               cv::Mat const &GrayImage) const
 {
     // Variables...
     IplImage   *pMaskImage          = NULL;
@@ -217,64 +487,27 @@ if(AverageBrightness.val[0] == 0.0f)
 // Get the maximum brightness along a line...
 inline double const Worm::GetLineMaximumBrightness(
     LineSegment const &A,
-    IplImage const &GrayImage) const
+    cv::Mat const &GrayImage) const
 {
     // Variables...
-    CvPoint                 FirstPoint(cvPointFrom32f(A.first));
-    CvPoint                 SecondPoint(cvPointFrom32f(A.second));
-    CvLineIterator          LineIterator;
-    int                     nPixelIndex     = 0;
-    register unsigned char  MaxBrightness   = 0x00;
-    CvPoint                 CurrentPoint    = cvPoint(0, 0);
-
-    // Make sure the line is within the image boundary...
-    cvClipLine(cvGetSize(&GrayImage), &FirstPoint, &SecondPoint);
+    unsigned char           MaxBrightness   = 0x00;
 
-    // Initialize pixel iterator...
-    int const nPixels = cvInitLineIterator(&GrayImage, FirstPoint, SecondPoint,
-                                           &LineIterator, 8, 0);
-
-/*cvLine(const_cast<IplImage *>(&GrayImage), cvPointFrom32f(Line.first), 
-       cvPointFrom32f(Line.second), CV_RGB(0xFF, 0xFF, 0xFF));*/
+    // Initialize pixel iterator. It clips the line to the image boundary for
+    //  us...
+    cv::LineIterator LineIterator(GrayImage, cvPointFrom32f(A.first), 
+                                  cvPointFrom32f(A.second), 8);
 
     // Scan each pixel, totaling as we go...
-    for(nPixelIndex = 0; nPixelIndex < nPixels; ++nPixelIndex)
+    for(int nPixelIndex = 0; nPixelIndex < LineIterator.count; 
+        ++nPixelIndex, ++LineIterator)
     {
-        // Discard those points that are not on the vermiform contour...
-        
-            // Calculate where the current point falls on the image plane...
-
-                // Calculate pixel offset into image data...
-                unsigned int const unOffset = 
-                    LineIterator.ptr - (unsigned char *)(GrayImage.imageData);
-
-                // Y-coordinate is the ratio of image offset to the size of 
-                //  aligned image row in bytes...
-                CurrentPoint.y  = unOffset / GrayImage.widthStep;
-                
-                // X-coordinate is a bit more complicated, with the divisor
-                //  being the size of a pixel. One byte for unsigned 8-bit 
-                //  grayscale...
-                CurrentPoint.x = 
-                    (unOffset - CurrentPoint.y * GrayImage.widthStep) / 
-                    (1 * sizeof(unsigned char));
-        
-            // Point does not lie on the vermiform...
-            if(cvPointPolygonTest(pContour, cvPointTo32f(CurrentPoint), 0) < 0)
-            {
-                // Discard and seek to next point...
-                CV_NEXT_LINE_POINT(LineIterator);
-                continue;
-            }
+        // Discard those points that are not on the vermiform...
+        cv::Point const CurrentPoint = LineIterator.pos();
+        if(!IsInterior(cvPoint(CurrentPoint.x, CurrentPoint.y)))
+            continue;
 
         // We want the brightest pixel we can find...
-        MaxBrightness = std::max(MaxBrightness, LineIterator.ptr[0]);
-
-/*cvLine(const_cast<IplImage *>(&GrayImage), CurrentPoint, CurrentPoint,
-       CV_RGB(0xFF, 0xFF, 0xFF));*/
-
-        // Seek to next point...
-        CV_NEXT_LINE_POINT(LineIterator);
+        MaxBrightness = std::max(MaxBrightness, **LineIterator);
     }
 
     // Return the average brightness...
@@ -287,48 +520,103 @@ inline unsigned int Worm::GetNextVertexIndex(unsigned int const &unVertexIndex)
     const
 {
     // This should never happen, so we make sure...
-    assert((int) unVertexIndex < pContour->total);
+    assert(unVertexIndex < CurrentContour.Size());
     
     // The next index is just one more than the given - unless at the end where 
     //  it jumps back to the beginning...
-    return ((int) unVertexIndex + 1 < pContour->total) ? (unVertexIndex + 1) 
+    return (unVertexIndex + 1 < CurrentContour.Size()) ? (unVertexIndex + 1) 
                                                        : 0;
 }
 
-// Get the total surrounding brightness of a central point ...
+// Get the point on the contour the given arc length around from the first 
+//  vertex, between the two vertices it falls between... O(log n)
+inline CvPoint2D32f Worm::GetPointByArcLength(double dArcLength) const
+{
+    // Variables...
+    unsigned int const  unVertices  = CurrentContour.Size();
+    double const        dPerimeter  = ArcLengths.back();
+
+    // Bring it around to within the perimeter...
+    dArcLength = fmod(dArcLength, dPerimeter);
+    if(dArcLength < 0.0)
+        dArcLength += dPerimeter;
+
+    // Find the edge it falls on...
+    unsigned int const unVertexIndex = std::min<unsigned int>(
+        std::upper_bound(ArcLengths.begin(), ArcLengths.end(), dArcLength) - 
+            ArcLengths.begin() - 1,
+        unVertices - 1);
+
+    // How far along that edge? The closed contour repeats the first vertex at
+    //  the end, so the next one along is always just after...
+    double const dEdgeLength = ContourEdgeLengths[unVertexIndex];
+    float const fAlong = (dEdgeLength > 0.0) ? 
+        (float) ((dArcLength - ArcLengths[unVertexIndex]) / dEdgeLength) : 
+        0.0f;
+
+    // Interpolate between its two vertices...
+    return cvPoint2D32f(
+        ContourPoints.X[unVertexIndex] + fAlong * 
+            (ContourPoints.X[unVertexIndex + 1] - 
+             ContourPoints.X[unVertexIndex]),
+        ContourPoints.Y[unVertexIndex] + fAlong * 
+            (ContourPoints.Y[unVertexIndex + 1] - 
+             ContourPoints.Y[unVertexIndex]));
+}
+
+// Get the total surrounding brightness of a central point. This is the 
+//  brightest pixel on the worm in each of the row and the column through the 
+//  centre, added together...
 inline double const Worm::GetSurroundingBrightness(
     CvPoint Centre, 
-    IplImage const &GrayImage) const
+    cv::Mat const &GrayImage) const
 {
     // Constants...
-    unsigned int const  unRadius            = 10;
+    int const           nRadius             = 10;
 
-    // Create a cross over the given centre point...
-    
-        // Form the vertical component...
-        LineSegment const
-            Vertical(cvPoint2D32f(Centre.x, Centre.y - unRadius),
-                     cvPoint2D32f(Centre.x, Centre.y + unRadius));
-        
-        // Form the horizontal component...
-        LineSegment const 
-            Horizontal(cvPoint2D32f(Centre.x - unRadius, Centre.y),
-                       cvPoint2D32f(Centre.x + unRadius, Centre.y));
+    // Variables...
+    unsigned char       HorizontalMaximum   = 0x00;
+    unsigned char       VerticalMaximum     = 0x00;
+
+    // Scan the row through the centre, clipped to the image...
+    if(Centre.y >= 0 && Centre.y < GrayImage.rows)
+    {
+        // Pixels in the row...
+        unsigned char const *pRow = GrayImage.ptr<unsigned char>(Centre.y);
+
+        // Brightest on the worm...
+        for(int nX = std::max(Centre.x - nRadius, 0); 
+            nX <= std::min(Centre.x + nRadius, GrayImage.cols - 1); 
+          ++nX)
+        {
+            if(IsInterior(cvPoint(nX, Centre.y)))
+                HorizontalMaximum = std::max(HorizontalMaximum, pRow[nX]);
+        }
+    }
+
+    // Scan the column through the centre, clipped to the image...
+    if(Centre.x >= 0 && Centre.x < GrayImage.cols)
+    {
+        // Brightest on the worm...
+        for(int nY = std::max(Centre.y - nRadius, 0); 
+            nY <= std::min(Centre.y + nRadius, GrayImage.rows - 1); 
+          ++nY)
+        {
+            if(IsInterior(cvPoint(Centre.x, nY)))
+                VerticalMaximum = std::max(VerticalMaximum, 
+                    GrayImage.at<unsigned char>(nY, Centre.x));
+        }
+    }
 
     // Return the maximum brightness on the cross...
-    return GetLineMaximumBrightness(Vertical, GrayImage) +
-           GetLineMaximumBrightness(Horizontal, GrayImage);
+    return (double) HorizontalMaximum + VerticalMaximum;
 }
 
-// Get the actual vertex of the given vertex index in the contour, O(1) 
-//  average...
-inline CvPoint &Worm::GetVertex(unsigned int const &unVertexIndex) const
+// Get the actual vertex of the given vertex index in the contour, θ(1)...
+inline CvPoint Worm::GetVertex(unsigned int const &unVertexIndex) const
 {
-    // This should never happen, so we make sure...
-    assert((int) unVertexIndex < pContour->total);
-    
-    // Find the actual vertex and return it...
-    return *((CvPoint *) cvGetSeqElem((CvSeq *) pContour, unVertexIndex));
+    // Plain index into the contiguous vertices...
+    return CurrentContour.Vertex(unVertexIndex);
 }
 
 // Get the index of the previous vertex in the contour after the given index, 
@@ -337,11 +625,33 @@ inline unsigned int Worm::GetPreviousVertexIndex(
     unsigned int const &unVertexIndex) const
 {
     // This should never happen...
-    assert((int) unVertexIndex < pContour->total);
+    assert(unVertexIndex < CurrentContour.Size());
     
     // The previous index is just one less than the given - unless at the start 
     //  where it jumps back to the end... 
-    return (unVertexIndex == 0) ? (pContour->total - 1) : (unVertexIndex - 1);
+    return (unVertexIndex == 0) ? (CurrentContour.Size() - 1) 
+                                : (unVertexIndex - 1);
+}
+
+// Length from head to tail in the last frame alone...
+double const &Worm::FrameLength() const
+{
+    // Return it...
+    return dFrameLength;
+}
+
+// Width in the last frame alone...
+double const &Worm::FrameWidth() const
+{
+    // Return it...
+    return dFrameWidth;
+}
+
+// Half the perimeter, averaged the same way as the length...
+double const &Worm::HalfPerimeter() const
+{
+    // Return it...
+    return dHalfPerimeter;
 }
 
 // Best guess as to the head's position at this moment in time, since it 
@@ -368,11 +678,11 @@ CvPoint const &Worm::Head() const
 inline bool Worm::IsFirstHeadCloisterCheck(
     unsigned int const &unCandidateHeadVertexIndex,
     unsigned int const &unCandidateTailVertexIndex,
-    IplImage const     &GrayImage) const
+    cv::Mat const      &GrayImage) const
 {
     // Variables...
-    CvPoint const  &CandidateHeadStart  = GetVertex(unCandidateHeadVertexIndex);
-    CvPoint const  &CandidateTailStart  = GetVertex(unCandidateTailVertexIndex);
+    CvPoint const   CandidateHeadStart  = GetVertex(unCandidateHeadVertexIndex);
+    CvPoint const   CandidateTailStart  = GetVertex(unCandidateTailVertexIndex);
 /*    unsigned int    unTempIndexOne      = 0;
     unsigned int    unTempIndexTwo      = 0;
     CvPoint         EndPoint            = cvPoint(0, 0);*/
@@ -448,7 +758,7 @@ inline bool Worm::IsFirstHeadCloisterCheck(
 inline bool Worm::IsFirstProbablyHeadViaCloisterCheck(
     unsigned int const &unCandidateHeadVertexIndex,
     unsigned int const &unCandidateTailVertexIndex,
-    IplImage const     &GrayImage) const
+    cv::Mat const      &GrayImage) const
 {
     // Variables...
     unsigned int    unStartVertexIndex  = 0;
@@ -535,30 +845,80 @@ dTemp = dTemp;
     return (dCandidateHeadBrightness > dCandidateTailBrightness);
 }*/
 
+// Is the given pixel on or inside the worm? θ(1)
+inline bool Worm::IsInterior(CvPoint const &Point) const
+{
+    // Test against the contour itself, if asked... θ(n)
+    if(bReferenceMode)
+        return CurrentContour.Contains(cvPoint2D32f(Point.x, Point.y)) >= 0;
+
+    // Find the pixel in the mask...
+    cv::Rect const &Bounds  = CurrentContour.BoundingRectangle();
+    int const       nColumn = Point.x - Bounds.x;
+    int const       nRow    = Point.y - Bounds.y;
+
+    // Outside of the bounding rectangle is outside of the worm...
+    if(nColumn < 0 || nColumn >= InteriorMask.cols || 
+       nRow < 0 || nRow >= InteriorMask.rows)
+        return false;
+
+    // Look it up...
+    return InteriorMask.at<unsigned char>(nRow, nColumn) != 0;
+}
+
 // Best guess of the length from head to tail, considering everything we've 
 //  seen thus far...
-inline double const &Worm::Length() const
+double const &Worm::Length() const
 {
+    // Along the midline, unless it was never traced...
+    if(unLengthRefreshes == 0)
+        return dHalfPerimeter;
+
     // Return it...
     return dLength;
 }
 
+// Number of refreshes the length was measured along the midline in...
+unsigned int const Worm::LengthRefreshes() const
+{
+    // Return it...
+    return unLengthRefreshes;
+}
+
+// The midline in this frame, from head to tail, as MIDLINE_POINTS points 
+//  evenly spaced along it...
+SlitherMath::PointArrays const &Worm::Midline() const
+{
+    // Return it...
+    return CurrentMidline;
+}
+
+// The posture in this frame...
+Worm::PostureDescriptor const &Worm::Posture() const
+{
+    // Return it...
+    return CurrentPosture;
+}
+
 // Find the vertex index in the contour sequence that contains either end of 
-//  the worm, and update width while we're at it... θ(n)
+//  the worm, and update width while we're at it. Not found if no probe could 
+//  be aimed into the worm, which answers the first vertex instead... θ(n)
 inline unsigned int Worm::PinchShiftForAnEnd(
-    IplImage const &GrayImage, 
+    cv::Mat const &GrayImage, 
+    bool &bFound,
     IterationDirection Direction)
 {
     // Variables...
     unsigned int        unProbeAttempt                      = 0;
     unsigned int        unStartVertexIndex                  = 0;
-    unsigned int        unCurrentOppositeVertexIndex        = 0;
     unsigned int        unClosestOppositeVertexIndexFound   = 0;
-    double              dClosestOppositeVertexDistanceFound = Infinity;
     LineSegment         StartingLineSegment;
     LineSegment         OrthogonalLineSegment;
     LineSegment         CorrectedOrthogonal;
 
+    // Not found until we find otherwise...
+    bFound = false;
+
     // Keep trying to make an orthogonal from the starting vertex that points
     //  into the worm...
     do
@@ -583,7 +943,7 @@ inline unsigned int Worm::PinchShiftForAnEnd(
         CorrectedOrthogonal = OrthogonalLineSegment;
         for(unsigned int unOrthogonalCorrection = 1;
             unOrthogonalCorrection <= 40 && 
-            cvPointPolygonTest(pContour, CorrectedOrthogonal.second, 0) <= 0.0f;
+            CurrentContour.Contains(CorrectedOrthogonal.second) <= 0.0f;
           ++unOrthogonalCorrection)
         {
             // Preserve precision by starting with the original orthogonal...
@@ -601,8 +961,7 @@ inline unsigned int Worm::PinchShiftForAnEnd(
         }
 
         // We had found a good orthogonal...
-        if(cvPointPolygonTest(pContour, CorrectedOrthogonal.second, 0) 
-            > 0.0f)
+        if(CurrentContour.Contains(CorrectedOrthogonal.second) > 0.0f)
             break;
 
         // We had not found a good orthogonal...
@@ -629,7 +988,8 @@ inline unsigned int Worm::PinchShiftForAnEnd(
     // Extend the directed orthogonal line segment out very far and clip to the 
     //  very edge of the image...
     AdjustDirectedLineSegmentLength(OrthogonalLineSegment, 10000.0f);
-    ClipLineSegment(cvGetSize(&GrayImage), OrthogonalLineSegment);
+    ClipLineSegment(cvSize(GrayImage.cols, GrayImage.rows), 
+                    OrthogonalLineSegment);
 
 /*cvLine(const_cast<IplImage *>(&GrayImage), cvPointFrom32f(OrthogonalLineSegment.first), 
        cvPointFrom32f(OrthogonalLineSegment.second),
@@ -641,46 +1001,18 @@ inline unsigned int Worm::PinchShiftForAnEnd(
     //  be somewhere on the other side, though not necessarily directly 
     //  opposite...
     
-        // Start searching beginning with the next neighbour of our starting 
-        //  segment...
-        unCurrentOppositeVertexIndex = GetNextVertexIndex(unStartVertexIndex);
-        
-        // Now go around the creature, looking for those segments that the 
-        //  above pierces...
-        while(unStartVertexIndex != 
-              GetNextVertexIndex(unCurrentOppositeVertexIndex))
-        {
-            // The line segment we are going to test...
-            LineSegment CandidateLineSegment(
-                cvPointTo32f(GetVertex(unCurrentOppositeVertexIndex)), 
-                cvPointTo32f(GetVertex(
-                        GetNextVertexIndex(unCurrentOppositeVertexIndex))));
-            
-            // Ah ha! We have found a segment that intersects the orthogonal...
-            if(IsLineSegmentsIntersect(OrthogonalLineSegment, 
-                                       CandidateLineSegment))
-            {
-                // How far away were they?
-                double const dDistanceBetweenMiddleOfLineSegments = 
-                    DistanceBetweenLineSegments(StartingLineSegment, 
-                                                CandidateLineSegment);
-                
-                // Was distance closer than anything encountered thus far?
-                if(dDistanceBetweenMiddleOfLineSegments < 
-                   dClosestOppositeVertexDistanceFound)
-                {
-                    // Make a note of where it was and how far away it was...
-                    unClosestOppositeVertexIndexFound   = 
-                        unCurrentOppositeVertexIndex;
-                    dClosestOppositeVertexDistanceFound = 
-                        dDistanceBetweenMiddleOfLineSegments;
-                }
-            }
-            
-            // Let's move to the next segment and try that one...
-            unCurrentOppositeVertexIndex = 
-                GetNextVertexIndex(unCurrentOppositeVertexIndex);
-        }
+        // Only the edges near the orthogonal could be pierced by it, unless
+        //  we were asked to check them all...
+        if(bReferenceMode)
+            unClosestOppositeVertexIndexFound = 
+                FindOppositeVertexIndexLinearly(
+                    unStartVertexIndex, StartingLineSegment, 
+                    OrthogonalLineSegment);
+        else
+            unClosestOppositeVertexIndexFound = 
+                FindOppositeVertexIndex(
+                    unStartVertexIndex, StartingLineSegment, 
+                    OrthogonalLineSegment);
 
     // We now have both the start and opposite side vertex of the worm. This is
     //  all we need now for the shifting...
@@ -770,14 +1102,15 @@ inline unsigned int Worm::PinchShiftForAnEnd(
 
     // The index of the vertex of the head / tail is either vertex, since they 
     //  converged...
+    bFound = true;
     return unVertexIndexSideA;
 }
 
 // Get the bounding rectangle for the worm...
-CvRect const &Worm::Rectangle() const
+cv::Rect const &Worm::Rectangle() const
 {
     // Return it...
-    return pContour->rect;
+    return CurrentContour.BoundingRectangle();
 }
 
 // Best guess as to the tail's position at this moment in time, since it 
@@ -800,57 +1133,65 @@ CvPoint const &Worm::Tail() const
 
 // Refresh the worm's metrics based on its new contour... (area, length, width, 
 //  et cetera)
-inline void Worm::Refresh(CvContour const &NewContour, 
-                          IplImage const &GrayImage)
+void Worm::Refresh(Outline const &NewContour, cv::Mat const &GrayImage)
 {
     // Image must be a 8-bit, unsigned, grayscale...
-    assert(GrayImage.depth == IPL_DEPTH_8U);
-
-    // Image must not have a region of interest set...
-    assert(GrayImage.roi == NULL);
+    assert(GrayImage.type() == CV_8UC1);
 
     // Remember that how many times we have updated, which we need for 
     //  calculating arithmetic means...
   ++unRefreshes;
 
-    // Forget the old contour if we have one yet. This works by restoring the 
-    //  old contour sequence blocks to the base storage pool. This is θ(1) 
-    //  running time, usually...
-    if(pContour)
-        cvClearSeq((CvSeq *) pContour);
+    // Copy the new contour over the old one. The vertices are contiguous, so
+    //  this reuses our existing storage unless the worm grew...
+    CurrentContour = NewContour;
 
-    // Clone the new contour sequence into our storage pool...
-    pContour = (CvContour *) cvCloneSeq((CvSeq *) &NewContour, pStorage);
-
-        // For some reason the bounding rectangle in the header is skipped.
-        //  Intel bug?
-        pContour->rect = NewContour.rect;
-
-    // Update the gravitational centre from this image...
+    // Update the gravitational centre from the contour's moments...
     UpdateGravitationalCentre();
 
     // Update the approximate area from the area calculated in this image...
-    UpdateArea(fabs(cvContourArea(pContour)));
+    UpdateArea(CurrentContour.Area());
+
+    // Measure along the contour once so walking it later is a search... θ(n)
+    UpdateArcLengths();
+
+    // Index its edges for the pinches below and rasterize its interior for 
+    //  the brightness checks, unless they will test the contour directly... 
+    //  θ(n) and θ(area)
+    if(!bReferenceMode)
+    {
+        ContourEdges.Build(CurrentContour);
+        UpdateInteriorMask();
+    }
+
+    // The length is about half the perimeter all the way around the worm. 
+    //  That's only good enough to find the ends with, so it is measured along
+    //  the midline between them once they are found. Half the perimeter is
+    //  also what candidates are compared with, so keep its own average over
+    //  every refresh, which stands in for the length until a midline is...
+    double const dHalfPerimeterAtThisMoment = CurrentContour.Perimeter() / 2.0;
+    dHalfPerimeter = ((dHalfPerimeter * (unRefreshes - 1)) + 
+                      dHalfPerimeterAtThisMoment) / unRefreshes;
+    dFrameLength = dHalfPerimeterAtThisMoment;
 
-    // Update the approximate length from the length calculated in *this* image.
-    //  The length is about half the perimeter all the way around the worm...
-    double const dLengthAtThisMoment = 
-        cvArcLength(pContour, CV_WHOLE_SEQ, true) / 2.0;
-    UpdateLength(dLengthAtThisMoment);
+    // Nothing measured across it yet in this frame...
+    dFrameWidth = 0.0;
 
     // Find both ends... (head and tail)
 
         // Find an end, either will do... θ(n)
+        bool bMysteryEndFound = false;
         unsigned int const unMysteryEndVertexIndex = 
-            PinchShiftForAnEnd(GrayImage, Forwards);
+            PinchShiftForAnEnd(GrayImage, bMysteryEndFound, Forwards);
 
         // Find the other end of the worm which must be approximately the 
         //  length of the worm away... O(n)
         /*unsigned int const unOtherMysteryEndVertexIndex = 
             FindVertexIndexByLength(unMysteryEndVertexIndex, 
                                     dLengthAtThisMoment);*/
+        bool bOtherMysteryEndFound = false;
         unsigned int const unOtherMysteryEndVertexIndex = 
-            PinchShiftForAnEnd(GrayImage, Backwards);
+            PinchShiftForAnEnd(GrayImage, bOtherMysteryEndFound, Backwards);
 
         // Make a reasonably intelligent guess as to which end is which, based 
         //  only on *this* image alone...
@@ -872,6 +1213,87 @@ inline void Worm::Refresh(CvContour const &NewContour,
                 UpdateHeadAndTail(unOtherMysteryEndVertexIndex, 
                                   unMysteryEndVertexIndex);
             }
+
+    // Trace the midline from whichever end is now the best guess for the head
+    //  to the other. A search that gave up answered the first vertex, which 
+    //  is seldom an end, so unless both found theirs the midline is left with
+    //  no length between its ends and isn't traced at all...
+    CvPoint const       HeadVertex          = Head();
+    CvPoint const       MysteryEndVertex    = 
+        GetVertex(unMysteryEndVertexIndex);
+    bool const          bMysteryEndIsHead   = 
+        (MysteryEndVertex.x == HeadVertex.x && 
+         MysteryEndVertex.y == HeadVertex.y);
+    unsigned int const  unMidlineHeadIndex  = bMysteryEndIsHead ? 
+        unMysteryEndVertexIndex : unOtherMysteryEndVertexIndex;
+    unsigned int const  unMidlineTailIndex  = 
+        !(bMysteryEndFound && bOtherMysteryEndFound) ? unMidlineHeadIndex :
+        bMysteryEndIsHead ? unOtherMysteryEndVertexIndex : 
+                            unMysteryEndVertexIndex;
+    double const        dMidlineLength      = 
+        UpdateMidline(unMidlineHeadIndex, unMidlineTailIndex);
+
+        // Average the length along it instead of half the perimeter, which 
+        //  overestimates it for a curled worm, over only the refreshes it 
+        //  could be traced in...
+        if(dMidlineLength > 0.0)
+        {
+          ++unLengthRefreshes;
+            UpdateLength(dMidlineLength);
+            dFrameLength = dMidlineLength;
+        }
+
+    // Describe the posture along it...
+    UpdatePosture();
+}
+
+// Set the basis each posture's tangent angles are projected onto, as up to 
+//  MAXIMUM_POSTURE_MODES modes of POSTURE_ANGLES angles each, one after the 
+//  other. Empty for none. Affects every worm...
+bool Worm::SetPostureBasis(std::vector<float> const &Basis)
+{
+    // Not a whole number of modes, or too many of them...
+    if(Basis.size() % POSTURE_ANGLES != 0 || 
+       Basis.size() / POSTURE_ANGLES > MAXIMUM_POSTURE_MODES)
+        return false;
+
+    // Store...
+    PostureBasis    = Basis;
+    unPostureModes  = (unsigned int) Basis.size() / POSTURE_ANGLES;
+
+    // Done...
+    return true;
+}
+
+// Use the slower but straightforward reference algorithms, to validate the 
+//  faster ones against. Affects every worm...
+void Worm::SetReferenceMode(bool const bEnable)
+{
+    // Set it...
+    bReferenceMode = bEnable;
+}
+
+// Update the arc length from the first vertex to each of the others, with the
+//  full perimeter at the end... θ(n)
+inline void Worm::UpdateArcLengths()
+{
+    // Variables...
+    unsigned int const unVertices = CurrentContour.Size();
+
+    // Lay the vertices out as a closed contour and measure every edge at 
+    //  once, the last wrapping around to the first...
+    LoadClosedContour(CurrentContour.Vertices(), ContourPoints);
+    SlitherMath::EdgeLengths(ContourPoints, ContourEdgeLengths);
+
+    // Only ever grows, so this doesn't allocate after the first few frames...
+    ArcLengths.resize(unVertices + 1);
+
+    // Accumulate each edge in turn...
+    ArcLengths[0] = 0.0;
+    for(unsigned int unVertexIndex = 0; unVertexIndex < unVertices; 
+      ++unVertexIndex)
+        ArcLengths[unVertexIndex + 1] = 
+            ArcLengths[unVertexIndex] + ContourEdgeLengths[unVertexIndex];
 }
 
 // Update the approximate area, based on the value at this moment in time. This 
@@ -885,18 +1307,11 @@ inline void Worm::UpdateArea(double const &dAreaAtThisMoment)
     dArea = std::max(dArea, dAreaAtThisMoment);
 }
 
-// Update the gravitational centre from this image...
+// Update the gravitational centre from the contour's moments...
 inline void Worm::UpdateGravitationalCentre()
 {
-    // Variables...
-    CvMoments   CurrentMoment;
-
-    // Calculate all moments of the contour...
-    cvMoments(pContour, &CurrentMoment);
-
-    // Extract the centre of gravity...
-    GravitationalCentre.x = int(CurrentMoment.m10 / CurrentMoment.m00);
-    GravitationalCentre.y = int(CurrentMoment.m01 / CurrentMoment.m00);
+    // The moments were already calculated when the contour was found...
+    GravitationalCentre = CurrentContour.Centre();
 }
 
 // Update the approximate head and tail position, based on the value at this 
@@ -906,8 +1321,8 @@ inline void Worm::UpdateHeadAndTail(unsigned int const &unHeadVertexIndex,
                                     unsigned int const &unTailVertexIndex)
 {
     // Get the location of the supposed head and tail in this frame...
-    CvPoint    &CurrentHeadVertex = GetVertex(unHeadVertexIndex);
-    CvPoint    &CurrentTailVertex = GetVertex(unTailVertexIndex);
+    CvPoint const   CurrentHeadVertex = GetVertex(unHeadVertexIndex);
+    CvPoint const   CurrentTailVertex = GetVertex(unTailVertexIndex);
 
     // Either we have no previous data to compare by, and so we assume initial
     //  data to be correct for starting, or, we have data already. In the latter
@@ -942,15 +1357,226 @@ inline void Worm::UpdateHeadAndTail(unsigned int const &unHeadVertexIndex,
     }
 }
 
+// Update the interior mask by rasterizing the contour into its bounding 
+//  rectangle... θ(area)
+inline void Worm::UpdateInteriorMask()
+{
+    // Variables...
+    cv::Rect const             &Bounds   = CurrentContour.BoundingRectangle();
+    vector<cv::Point> const    &Vertices = CurrentContour.Vertices();
+
+    // Grow the backing pixels if the worm no longer fits. They never shrink, 
+    //  so this stops allocating once the worm has been seen at its largest...
+    if(InteriorMaskPixels.rows < Bounds.height || 
+       InteriorMaskPixels.cols < Bounds.width)
+        InteriorMaskPixels.create(
+            std::max(InteriorMaskPixels.rows, Bounds.height),
+            std::max(InteriorMaskPixels.cols, Bounds.width), 
+            CV_8UC1);
+
+    // The mask is just the top left corner of them...
+    InteriorMask = 
+        InteriorMaskPixels(cv::Rect(0, 0, Bounds.width, Bounds.height));
+
+    // Nothing to fill...
+    if(Vertices.empty())
+        return;
+
+    // Clear and then fill the contour, shifted so the bounding rectangle's 
+    //  corner is the mask's origin. Edges are filled too...
+    cv::Point const    *pVertices   = &Vertices.front();
+    int const           nVertices   = Vertices.size();
+    InteriorMask.setTo(cv::Scalar(0x00));
+    cv::fillPoly(InteriorMask, &pVertices, &nVertices, 1, cv::Scalar(0xff), 8, 
+                 0, -Bounds.tl());
+}
+
 // Update the approximate length, based on the value at this moment in time. 
 //  This will help us make a more informed answer when asked via Length() for
 //  the length. θ(1) space and time...
 inline void Worm::UpdateLength(double const &dLengthAtThisMoment)
 {
-    // Store the new arithmetic mean in constant space. Just multiply your old
-    //  average by n, add x_{n+1}, and then divide the whole thing by n+1...
-    dLength = ((dLength * unRefreshes) + dLengthAtThisMoment) / 
-              (unRefreshes + 1);
+    // Store the new arithmetic mean in constant space. This measurement was 
+    //  already counted, so the old average was of the n-1 before it. Just 
+    //  multiply it by n-1, add x_n, and then divide the whole thing by n...
+    dLength = ((dLength * (unLengthRefreshes - 1)) + dLengthAtThisMoment) / 
+              unLengthRefreshes;
+}
+
+// Update the midline from head to tail, and the curvature along it, by 
+//  averaging the two sides of the contour between them at the same fraction 
+//  of the way along each. Returns its length, or zero if it couldn't be 
+//  traced... θ(n + m)
+inline double Worm::UpdateMidline(unsigned int const &unHeadVertexIndex,
+                                  unsigned int const &unTailVertexIndex)
+{
+    // Variables...
+    double const    dPerimeter      = ArcLengths.back();
+    double          dMidlineLength  = 0.0;
+
+    // Nothing there until we find otherwise...
+    CurrentMidline.X.clear();
+    CurrentMidline.Y.clear();
+    MidlineCurvature.clear();
+
+        // Both ends are the same, so there is no midline between them...
+        if(unHeadVertexIndex == unTailVertexIndex || dPerimeter <= 0.0)
+            return 0.0;
+
+    // How far it is from head to tail going forwards around the contour, and
+    //  going backwards...
+    double const dHeadArcLength = ArcLengths[unHeadVertexIndex];
+    double dForwards = ArcLengths[unTailVertexIndex] - dHeadArcLength;
+    if(dForwards < 0.0)
+        dForwards += dPerimeter;
+    double const dBackwards = dPerimeter - dForwards;
+
+    // Walk down both sides at once, the same fraction of the way along each, 
+    //  and take the point half way between them... O(m log n)
+    MatchedMidline.X.resize(MIDLINE_POINTS);
+    MatchedMidline.Y.resize(MIDLINE_POINTS);
+    for(unsigned int unPoint = 0; unPoint < MIDLINE_POINTS; ++unPoint)
+    {
+        double const        dFraction   = 
+            (double) unPoint / (MIDLINE_POINTS - 1);
+        CvPoint2D32f const  Left        = 
+            GetPointByArcLength(dHeadArcLength + dFraction * dForwards);
+        CvPoint2D32f const  Right       = 
+            GetPointByArcLength(dHeadArcLength - dFraction * dBackwards);
+        MatchedMidline.X[unPoint] = (Left.x + Right.x) / 2.0f;
+        MatchedMidline.Y[unPoint] = (Left.y + Right.y) / 2.0f;
+    }
+
+    // Measure each of its segments at once, and all of it... θ(m)
+    MidlineSegmentLengths.resize(MIDLINE_POINTS - 1);
+    DistancesBetweenPoints(
+        &MatchedMidline.X[0], &MatchedMidline.Y[0], &MatchedMidline.X[1], 
+        &MatchedMidline.Y[1], MIDLINE_POINTS - 1, &MidlineSegmentLengths[0]);
+    for(unsigned int unSegment = 0; unSegment < MIDLINE_POINTS - 1; 
+      ++unSegment)
+        dMidlineLength += MidlineSegmentLengths[unSegment];
+
+        // The sides met at a point...
+        if(dMidlineLength <= 0.0)
+            return 0.0;
+
+    // Space its points out evenly along it, since the sides are seldom the 
+    //  same length in the same places... θ(m)
+    double const    dSpacing        = dMidlineLength / (MIDLINE_POINTS - 1);
+    unsigned int    unSegment       = 0;
+    double          dSegmentStart   = 0.0;
+    CurrentMidline.X.resize(MIDLINE_POINTS);
+    CurrentMidline.Y.resize(MIDLINE_POINTS);
+    for(unsigned int unPoint = 0; unPoint < MIDLINE_POINTS; ++unPoint)
+    {
+        // Find the segment this point falls on...
+        double const dTarget = unPoint * dSpacing;
+        while(unSegment < MIDLINE_POINTS - 2 && 
+              dSegmentStart + MidlineSegmentLengths[unSegment] < dTarget)
+            dSegmentStart += MidlineSegmentLengths[unSegment++];
+
+        // How far along it?
+        float const fAlong = (MidlineSegmentLengths[unSegment] > 0.0f) ? 
+            (float) std::min(std::max((dTarget - dSegmentStart) / 
+                MidlineSegmentLengths[unSegment], 0.0), 1.0) : 
+            0.0f;
+
+        // Interpolate...
+        CurrentMidline.X[unPoint] = MatchedMidline.X[unSegment] + fAlong * 
+            (MatchedMidline.X[unSegment + 1] - MatchedMidline.X[unSegment]);
+        CurrentMidline.Y[unPoint] = MatchedMidline.Y[unSegment] + fAlong * 
+            (MatchedMidline.Y[unSegment + 1] - MatchedMidline.Y[unSegment]);
+    }
+
+    // The curvature at each point but the ends is how far the midline turns 
+    //  there, over the spacing... θ(m)
+    MidlineCurvature.resize(MIDLINE_POINTS - 2);
+    for(unsigned int unPoint = 1; unPoint < MIDLINE_POINTS - 1; ++unPoint)
+    {
+        // The segments either side...
+        float const fInX = CurrentMidline.X[unPoint] - 
+                           CurrentMidline.X[unPoint - 1];
+        float const fInY = CurrentMidline.Y[unPoint] - 
+                           CurrentMidline.Y[unPoint - 1];
+        float const fOutX = CurrentMidline.X[unPoint + 1] - 
+                            CurrentMidline.X[unPoint];
+        float const fOutY = CurrentMidline.Y[unPoint + 1] - 
+                            CurrentMidline.Y[unPoint];
+
+        // The angle between them, from their cross and dot products...
+        MidlineCurvature[unPoint - 1] = (float) (atan2(
+            fInX * fOutY - fInY * fOutX, fInX * fOutX + fInY * fOutY) / 
+                dSpacing);
+    }
+
+    // Done...
+    return dMidlineLength;
+}
+
+// Update the posture from the midline's tangent angles, projecting them onto
+//  the posture basis... θ(m + mk) for k modes
+inline void Worm::UpdatePosture()
+{
+    // Variables...
+    float   DeltaX[POSTURE_ANGLES];
+    float   DeltaY[POSTURE_ANGLES];
+    float   fMeanAngle  = 0.0f;
+
+    // Nothing to describe until we find otherwise...
+    CurrentPosture.bValid   = false;
+    CurrentPosture.unModes  = 0;
+
+        // No midline to take it from...
+        if(CurrentMidline.X.size() != MIDLINE_POINTS)
+            return;
+
+    // Take the direction of each midline segment...
+    for(unsigned int unAngle = 0; unAngle < POSTURE_ANGLES; ++unAngle)
+    {
+        DeltaX[unAngle] = CurrentMidline.X[unAngle + 1] - 
+                          CurrentMidline.X[unAngle];
+        DeltaY[unAngle] = CurrentMidline.Y[unAngle + 1] - 
+                          CurrentMidline.Y[unAngle];
+    }
+
+    // ...and find all of their angles at once with OpenCV's vectorized
+    //  arctangent, good to about a two hundredth of a radian...
+    cv::hal::fastAtan32f(DeltaY, DeltaX, TangentAngles, POSTURE_ANGLES, false);
+
+    // Unwrap them, so the worm curling past a half turn doesn't jump a whole
+    //  turn, and take their mean...
+    for(unsigned int unAngle = 1; unAngle < POSTURE_ANGLES; ++unAngle)
+    {
+        float const fTurn = TangentAngles[unAngle] - TangentAngles[unAngle - 1];
+        if(fTurn > Pi)
+            TangentAngles[unAngle] -= 2.0f * (float) Pi;
+        else if(fTurn < -Pi)
+            TangentAngles[unAngle] += 2.0f * (float) Pi;
+    }
+    for(unsigned int unAngle = 0; unAngle < POSTURE_ANGLES; ++unAngle)
+        fMeanAngle += TangentAngles[unAngle];
+    fMeanAngle /= POSTURE_ANGLES;
+
+    // Take the mean away, and store each in steps, saturating on the rare 
+    //  worm curled up more than a few turns...
+    for(unsigned int unAngle = 0; unAngle < POSTURE_ANGLES; ++unAngle)
+    {
+        TangentAngles[unAngle] -= fMeanAngle;
+        CurrentPosture.TangentAngles[unAngle] = cv::saturate_cast<short>(
+            TangentAngles[unAngle] * POSTURE_ANGLE_STEPS);
+    }
+
+    // Project them onto each mode of the basis with OpenCV's vectorized dot
+    //  product. The headers only wrap what's already there...
+    cv::Mat const Angles(1, POSTURE_ANGLES, CV_32FC1, TangentAngles);
+    for(unsigned int unMode = 0; unMode < unPostureModes; ++unMode)
+    {
+        cv::Mat const Mode(1, POSTURE_ANGLES, CV_32FC1, 
+            const_cast<float *>(&PostureBasis[unMode * POSTURE_ANGLES]));
+        CurrentPosture.Projections[unMode] = (float) Angles.dot(Mode);
+    }
+    CurrentPosture.unModes  = (unsigned char) unPostureModes;
+    CurrentPosture.bValid   = true;
 }
 
 // Update the approximate width, based on the value at this moment in time. 
@@ -962,6 +1588,9 @@ inline void Worm::UpdateWidth(double const &dWidthAtThisMoment)
     // the line segment formed between the two will probably have an upper 
     // bound of the worm's actual width...
     dWidth = std::max(dWidth, dWidthAtThisMoment);
+
+    // Same for this frame alone...
+    dFrameWidth = std::max(dFrameWidth, dWidthAtThisMoment);
 }
 
 // Number of times worm has been refreshed...
@@ -981,8 +1610,7 @@ double const &Worm::Width() const
 // Deconstructor...
 Worm::~Worm()
 {
-    // Deallocate storage pool...
-    cvReleaseMemStorage(&pStorage);
+
 }
 
 // Output a point...
@@ -1001,7 +1629,7 @@ std::ostream & operator<<(std::ostream &Output, Worm &RequestedWorm)
     // Output attributes of note...
     Output << "\tArea: "        << RequestedWorm.dArea          << std::endl
            << "\tCentre: "      << RequestedWorm.Centre()       << std::endl
-           << "\tLength: "      << RequestedWorm.dLength        << std::endl
+           << "\tLength: "      << RequestedWorm.Length()       << std::endl
            << "\tWidth: "       << RequestedWorm.dWidth         << std::endl
            << "\tHead: "        << RequestedWorm.Head()         << std::endl
            << "\tTail: "        << RequestedWorm.Tail()         << std::endl
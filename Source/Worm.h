@@ -17,13 +17,48 @@
     
     // Standard libraries and STL...
     #include <ostream>
+    #include <vector>
     
     // SlitherMath...
     #include "SlitherMath.h"
 
+    // Contiguous contours and their edge index...
+    #include "Outline.h"
+    #include "EdgeGrid.h"
+
 // Worm class...
 class Worm
 {   
+    // Public constants...
+    public:
+
+        // Points along the midline, from head to tail, tangent angles along
+        //  it, the most posture modes that can be projected onto, and how
+        //  many steps of a tangent angle there are to a radian...
+        enum
+        {
+            MIDLINE_POINTS          = 33,
+            POSTURE_ANGLES          = MIDLINE_POINTS - 1,
+            MAXIMUM_POSTURE_MODES   = 8,
+            POSTURE_ANGLE_STEPS     = 4096
+        };
+
+    // Public types...
+    public:
+
+        // The worm's posture in one frame, in about a hundred bytes. The 
+        //  tangent angle of each midline segment from head to tail, less 
+        //  their mean so that it doesn't matter which way the worm faces, in 
+        //  steps of a POSTURE_ANGLE_STEPS th of a radian. Then how far the 
+        //  angles go along each mode of the posture basis, if there is one...
+        typedef struct PostureDescriptor
+        {
+            short           TangentAngles[POSTURE_ANGLES];
+            float           Projections[MAXIMUM_POSTURE_MODES];
+            unsigned char   unModes;
+            bool            bValid;
+        }PostureDescriptor;
+
     // Public methods...
     public:
 
@@ -32,7 +67,7 @@ class Worm
         
         // Worm constructor just needs to know it's contour and the image it 
         //  rests on...
-        Worm(CvContour const &Contour, IplImage const &GrayImage);
+        Worm(Outline const &Contour, cv::Mat const &GrayImage);
 
         // Explicit copy constructor...
 //        Worm(Worm const & SourceWorm);
@@ -47,18 +82,48 @@ class Worm
             CvPoint const      &Centre() const;
 
             // Get the worm's contour...
-            CvContour const    &Contour() const;
+            Outline const      &Contour() const;
+
+            // Signed curvature along the midline in this frame, in radians 
+            //  per pixel, at each of its points but the two ends. Positive 
+            //  where it turns clockwise as seen on screen...
+            std::vector<float> const &Curvature() const;
+
+            // Length from head to tail in the last frame alone...
+            double const       &FrameLength() const;
+
+            // Width in the last frame alone...
+            double const       &FrameWidth() const;
+
+            // Half the perimeter, averaged over every refresh. This is all a
+            //  candidate's contour can say about its length, so it is what 
+            //  candidates are compared with...
+            double const       &HalfPerimeter() const;
 
             // Best guess as to the head's position at this moment in time, 
             //  since it changes...
             CvPoint const      &Head() const;
 
             // Best guess of the length from head to tail, considering 
-            //  everything we've seen thus far...
+            //  everything we've seen thus far. Averaged along the midline over
+            //  the refreshes it could be traced in, or half the perimeter's 
+            //  average if it never could...
             double const       &Length() const;
 
+            // Number of refreshes the length was measured along the midline 
+            //  in. Zero if the length is still half the perimeter...
+            unsigned int const  LengthRefreshes() const;
+
+            // The midline in this frame, from head to tail, as MIDLINE_POINTS
+            //  points evenly spaced along it. Empty if it couldn't be traced...
+            SlitherMath::PointArrays const &Midline() const;
+
+            // The posture in this frame. Not valid if the midline couldn't be
+            //  traced...
+            PostureDescriptor const &Posture() const;
+
             // Get the bounding rectangle for the worm...
-            CvRect const       &Rectangle() const;
+            cv::Rect const     &Rectangle() const;
 
             // Best guess as to the tail's position at this moment in time, 
             //  since it changes...
@@ -75,7 +140,18 @@ class Worm
 
             // Refresh worm's metrics based on new contour and image data...
             void Refresh(
-                CvContour const &NewContour, IplImage const &GrayImage);
+                Outline const &NewContour, cv::Mat const &GrayImage);
+
+            // Use the slower but straightforward reference algorithms, to
+            //  validate the faster ones against. Affects every worm...
+            static void SetReferenceMode(bool const bEnable);
+
+            // Set the basis each posture's tangent angles are projected onto,
+            //  usually eigenworms, as up to MAXIMUM_POSTURE_MODES modes of 
+            //  POSTURE_ANGLES angles each, one after the other. Empty for 
+            //  none. False, changing nothing, if it isn't that. Affects every
+            //  worm, so set it before tracking starts...
+            static bool SetPostureBasis(std::vector<float> const &Basis);
 
         // Operators...
 
@@ -126,36 +202,65 @@ class Worm
 
         // Accessors...
 
+            // Find the closest edge on the other side of the worm that the
+            //  orthogonal pierces, by testing every edge. This is the reference
+            //  for FindOppositeVertexIndex()... θ(n)
+            unsigned int FindOppositeVertexIndexLinearly(
+                unsigned int const &unStartVertexIndex,
+                SlitherMath::LineSegment const &StartingLineSegment,
+                SlitherMath::LineSegment const &OrthogonalLineSegment) const;
+
             // Find the vertex on the contour a given length away, starting 
-            //  from a given vertex... O(n)
+            //  from a given vertex... O(log n)
+            unsigned int const FindVertexIndexByLength(
+                unsigned int const &unStartVertexIndex, 
+                double const &dPerimeterLength) const;
+
+            // Same, also counting the vertices passed along the way... 
+            //  O(log n)
             unsigned int const FindVertexIndexByLength(
                 unsigned int const &unStartVertexIndex, 
                 double const &dPerimeterLength,
-                unsigned int &unVerticesTraversed = unDummy) const;
+                unsigned int &unVerticesTraversed) const;
+
+            // Find the vertex on the contour a given length away by walking 
+            //  there. This is the reference for FindVertexIndexByLength()... 
+            //  O(n)
+            unsigned int const FindVertexIndexByLengthLinearly(
+                unsigned int const &unStartVertexIndex, 
+                double const &dPerimeterLength,
+                unsigned int &unVerticesTraversed) const;
 
             // Get the maximum brightness along a line...
             double const GetLineMaximumBrightness(
                 SlitherMath::LineSegment const &A,
-                IplImage const &GrayImage) const;
+                cv::Mat const &GrayImage) const;
 
-            // Get the total surrounding brightness of a central point ...
+            // Get the total surrounding brightness of a central point. This
+            //  is the brightest pixel on the worm in each of the row and the 
+            //  column through the centre, added together...
             double const GetSurroundingBrightness(
                 CvPoint Centre,
-                IplImage const &GrayImage) const;
+                cv::Mat const &GrayImage) const;
             
             /* Get the average brightness of the area within a contour...
             double const        GetAverageBrightness(
                                     CvContour const &Contour,
-                                    IplImage const &GrayImage) const;*/
+                                    cv::Mat const &GrayImage) const;*/
 
             // Get the index of the next vertex in the contour after the given 
             //  index, O(1) average...
             unsigned int GetNextVertexIndex(unsigned int const &unVertexIndex) 
                 const;
+
+            // Get the point on the contour the given arc length around from
+            //  the first vertex, between the two vertices it falls between... 
+            //  O(log n)
+            CvPoint2D32f GetPointByArcLength(double dArcLength) const;
             
             // Get the actual vertex of the given vertex index in the contour, 
-            //  O(1) average...
-            CvPoint &GetVertex(unsigned int const &unVertexIndex) const;
+            //  θ(1)...
+            CvPoint GetVertex(unsigned int const &unVertexIndex) const;
             
             // Get the index of the previous vertex in the contour after the 
             //  given index, O(1) average...
@@ -163,16 +268,35 @@ class Worm
                 unsigned int const &unVertexIndex)
                                 const;
 
+            // Is the given pixel on or inside the worm? θ(1)
+            bool IsInterior(CvPoint const &Point) const;
+
         // Mutators...
 
+            // Find the closest edge on the other side of the worm that the
+            //  orthogonal pierces, by testing only the edges that the edge
+            //  grid places near the orthogonal...
+            unsigned int FindOppositeVertexIndex(
+                unsigned int const &unStartVertexIndex,
+                SlitherMath::LineSegment const &StartingLineSegment,
+                SlitherMath::LineSegment const &OrthogonalLineSegment);
+
             // Update the approximate area, based on the value at this moment in
             //  time. This will help us make a more informed answer when asked 
             //  via Area() for the size. θ(1) space and time...
             void UpdateArea(double const &dAreaAtThisMoment);
 
-            // Update the gravitational centre from this image...
+            // Update the arc length from the first vertex to each of the 
+            //  others, with the full perimeter at the end... θ(n)
+            void UpdateArcLengths();
+
+            // Update the gravitational centre from the contour's moments...
             void UpdateGravitationalCentre();
 
+            // Update the interior mask by rasterizing the contour into its 
+            //  bounding rectangle... θ(area)
+            void UpdateInteriorMask();
+
             // Update the approximate head and tail position, based on the value 
             //  at this moment in time. This will help us make a more informed 
             //  answer when asked via Head() or Tail() for the actual 
@@ -185,6 +309,18 @@ class Worm
             //  in time. This will help us make a more informed answer when
             //  asked via Length() for the length. θ(1) space and time...
             void UpdateLength(double const &dLengthAtThisMoment);
+
+            // Update the midline from head to tail, and the curvature along 
+            //  it, by averaging the two sides of the contour between them at
+            //  the same fraction of the way along each. Returns its length, or
+            //  zero if it couldn't be traced... θ(n + m)
+            double UpdateMidline(
+                unsigned int const &unHeadVertexIndex,
+                unsigned int const &unTailVertexIndex);
+
+            // Update the posture from the midline's tangent angles, projecting
+            //  them onto the posture basis... θ(m + mk) for k modes
+            void UpdatePosture();
             
             // Update the approximate width, based on the value at this moment 
             //  in time. This will help us make a more informed answer when
@@ -200,28 +336,64 @@ class Worm
             bool IsFirstHeadCloisterCheck(
                 unsigned int const &unCandidateHeadVertexIndex,
                 unsigned int const &unCandidateTailVertexIndex,
-                IplImage const     &GrayImage) const;
+                cv::Mat const      &GrayImage) const;
             
             // Find the vertex index in the contour sequence that contains 
-            //  either end of the worm, and update width while we're at it... 
-            //  θ(n)
+            //  either end of the worm, and update width while we're at it. 
+            //  Not found if no probe could be aimed into the worm, which 
+            //  answers the first vertex instead... θ(n)
             unsigned int PinchShiftForAnEnd(
-                IplImage const &GrayImage,
+                cv::Mat const &GrayImage,
+                bool &bFound,
                 IterationDirection Direction = Forwards);
 
     // Protected attributes...
     protected:
 
-            // Base storage to store contour sequence and any other dynamic 
-            //  OpenCV data structures...
-            CvMemStorage       *pStorage;
-
-                // Contour around the worm...
-                CvContour      *pContour;
+            // Contour around the worm, with its vertices stored contiguously
+            //  and reused between refreshes...
+            Outline             CurrentContour;
+
+                // Its edges indexed by location, rebuilt on every refresh, and
+                //  the edges near the orthogonal of the current pinch, with
+                //  their ends laid out for testing them all at once...
+                EdgeGrid                    ContourEdges;
+                std::vector<unsigned int>   CandidateEdges;
+                SlitherMath::PointArrays    CandidateStarts;
+                SlitherMath::PointArrays    CandidateEnds;
+                std::vector<int>            CandidateIntersects;
+
+                // Its vertices laid out as a closed contour, the length of
+                //  each edge, and the arc length from the first vertex to each
+                //  vertex, and all the way around at the end. All rebuilt on
+                //  every refresh...
+                SlitherMath::PointArrays    ContourPoints;
+                std::vector<float>          ContourEdgeLengths;
+                std::vector<double>         ArcLengths;
+
+            // Midline from head to tail and the curvature along it, both 
+            //  rebuilt on every refresh, and the midline before it was evenly
+            //  spaced and the length of each of its segments...
+            SlitherMath::PointArrays    CurrentMidline;
+            std::vector<float>          MidlineCurvature;
+            SlitherMath::PointArrays    MatchedMidline;
+            std::vector<float>          MidlineSegmentLengths;
+
+            // Posture in this frame, and its tangent angles in radians before
+            //  they were stored in steps...
+            PostureDescriptor           CurrentPosture;
+            float                       TangentAngles[POSTURE_ANGLES];
+
+                // Its interior rasterized into its bounding rectangle, non-zero
+                //  for every pixel on or inside the contour, and the pixels
+                //  backing it which are reused between refreshes...
+                cv::Mat                     InteriorMask;
+                cv::Mat                     InteriorMaskPixels;
             
             // Some book keeping information that we use for computing 
             //  arithmetic averages for the metrics...
             unsigned int        unRefreshes;
+            unsigned int        unLengthRefreshes;
             
             // The worm's metrics...
             
@@ -231,18 +403,27 @@ class Worm
                 // Centre...
                 CvPoint         GravitationalCentre;
                 
-                // Length of the worm...
+                // Length of the worm, and half its perimeter...
                 double          dLength;
+                double          dHalfPerimeter;
                 
                 // Width of the worm...
                 double          dWidth;
 
+                // Length and width in the last frame alone...
+                double          dFrameLength;
+                double          dFrameWidth;
+
             // Terminal end scores...
             TerminalEndNotes    TerminalA;
             TerminalEndNotes    TerminalB;
             
-            // Dummy default argument parameters...
-            static unsigned int unDummy;
+            // Use the reference algorithms...
+            static bool         bReferenceMode;
+
+            // Posture basis, mode after mode, and how many modes it has...
+            static std::vector<float>   PostureBasis;
+            static unsigned int         unPostureModes;
 
 };
 
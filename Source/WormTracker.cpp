@@ -10,14 +10,166 @@
 #include <new>
 #include <cmath>
 #include <cassert>
+#include <cstdlib>
+#include <cstring>
 #include <algorithm>
 #include <sstream>
 
+// Statics...
+
+    // Use the reference algorithms...
+    bool WormTracker::bReferenceMode = false;
+
+// Segments tiles of a region, each on whichever processor OpenCV gives it. The
+//  tiles are bands of whole rows. Each writes only its own rows of the 
+//  threshold image and reads whatever gray pixels around it it needs, so the
+//  tiles overlap in what they read but never in what they write, and together
+//  give exactly what one pass over the whole region would...
+class TileSegmenter : public cv::ParallelLoopBody
+{
+    // Public methods...
+    public:
+
+        // Constructor...
+        TileSegmenter(cv::Mat const &_GrayImage, cv::Rect const &_Region,
+                      unsigned int const _unTileRows,
+                      bool const _bInletDetection,
+                      unsigned int const _unMorphologySize,
+                      unsigned int const _unThreshold,
+                      unsigned int const _unMaxThresholdValue,
+                      vector<MorphologyFilter> &_Filters,
+                      cv::Mat &_ThresholdImage)
+            : GrayImage(_GrayImage),
+              Region(_Region),
+              unTileRows(_unTileRows),
+              bInletDetection(_bInletDetection),
+              unMorphologySize(_unMorphologySize),
+              unThreshold(_unThreshold),
+              unMaxThresholdValue(_unMaxThresholdValue),
+              Filters(_Filters),
+              ThresholdImage(_ThresholdImage)
+        {
+        }
+
+        // Segment the given tiles...
+        void operator()(cv::Range const &Tiles) const
+        {
+            // Each tile...
+            for(int nTile = Tiles.start; nTile < Tiles.end; ++nTile)
+            {
+                // Its rows of the region...
+                int const nTop = Region.y + nTile * unTileRows;
+                cv::Rect const Tile(
+                    Region.x, nTop, Region.width, 
+                    std::min((int) unTileRows, Region.br().y - nTop));
+
+                // Open and threshold, with this tile's own scratch...
+                if(bInletDetection)
+                    Filters[nTile].OpenAndThreshold(
+                        GrayImage, Tile, unMorphologySize, unThreshold, 
+                        unMaxThresholdValue, ThresholdImage);
+
+                // Or just threshold...
+                else
+                {
+                    cv::Mat ThresholdTile = ThresholdImage(Tile);
+                    cv::threshold(GrayImage(Tile), ThresholdTile, unThreshold,
+                                  unMaxThresholdValue, cv::THRESH_BINARY);
+                }
+            }
+        }
+
+    // Protected attributes...
+    protected:
+
+        // The frame, the region of it to segment, and the rows in each tile...
+        cv::Mat const              &GrayImage;
+        cv::Rect const              Region;
+        unsigned int const          unTileRows;
+
+        // Artificial intelligence settings...
+        bool const                  bInletDetection;
+        unsigned int const          unMorphologySize;
+        unsigned int const          unThreshold;
+        unsigned int const          unMaxThresholdValue;
+
+        // Each tile's inlet correction, and where they all threshold into...
+        vector<MorphologyFilter>   &Filters;
+        cv::Mat                    &ThresholdImage;
+};
+
+// Refreshes worms, each on whichever processor OpenCV gives it. Once every 
+//  worm has been paired with its candidate, refreshing one touches nothing 
+//  but that worm, so they can all go at once. New worms are created in the
+//  null slots left for them at the end of the tracking table...
+class WormRefresher : public cv::ParallelLoopBody
+{
+    // Public methods...
+    public:
+
+        // Constructor...
+        WormRefresher(
+            vector<pair<unsigned int, unsigned int> > const &_Refreshes,
+            vector<Outline> const &_Candidates, cv::Mat const &_GrayImage,
+            vector<Worm *> &_TrackingTable)
+            : Refreshes(_Refreshes),
+              Candidates(_Candidates),
+              GrayImage(_GrayImage),
+              TrackingTable(_TrackingTable)
+        {
+        }
+
+        // Refresh or create the given worms...
+        void operator()(cv::Range const &Range) const
+        {
+            // Each worm...
+            for(int nRefresh = Range.start; nRefresh < Range.end; ++nRefresh)
+            {
+                // Which worm and which candidate...
+                unsigned int const unWormIndex  = Refreshes[nRefresh].first;
+                Outline const &Contour = Candidates[Refreshes[nRefresh].second];
+
+                // Let's hope they are really one and the same. Refresh it 
+                //  with the new information...
+                if(TrackingTable[unWormIndex])
+                    TrackingTable[unWormIndex]->Refresh(Contour, GrayImage);
+
+                // Or breathe life into a new worm from it...
+                else
+                    TrackingTable[unWormIndex] = new Worm(Contour, GrayImage);
+            }
+        }
+
+    // Protected attributes...
+    protected:
+
+        // Each worm and the index of the candidate to refresh it with...
+        vector<pair<unsigned int, unsigned int> > const    &Refreshes;
+
+        // The candidates and the frame they were found in...
+        vector<Outline> const      &Candidates;
+        cv::Mat const              &GrayImage;
+
+        // The worms...
+        vector<Worm *>             &TrackingTable;
+};
+
 // Default constructor...
 WormTracker::WormTracker()
     : fFieldOfViewDiameter(0.0f),
-      pGrayImage(NULL),
-      pThinkingImage(NULL),
+      ImageSize(cvSize(0, 0)),
+      bThinkingRequested(true),
+      bAutoCalibration(false),
+      CalibrationMethod(ThresholdCalibrator::TRIANGLE),
+      unCandidatesFound(0),
+      unRescanInterval(0),
+      unFramesSinceRescan(0),
+      bRescanNeeded(true),
+      unCoarseScale(0),
+      unTileRows(0),
+      bRecordTimeSeries(false),
+      nCentroidColumns(0),
+      nCentroidRows(0),
       unWormsJustAdded(0),
       unCurrentFrame(0),
       unTotalFrames(0),
@@ -26,7 +178,9 @@ WormTracker::WormTracker()
       unMinimumCandidateSize(150),
       unMaximumCandidateSize(255),
       bInletDetection(true),
-      unMorphologySize(5)
+      unMorphologySize(5),
+      unBackgroundScale(0),
+      unBackgroundLearning(6)
 {
     // Initialize the thinking label font...
     
@@ -41,35 +195,51 @@ WormTracker::WormTracker()
                    fHorizontalScale, fVerticalScale, unThickness, unLineWidth);
 }
 
-// Add new worm to tracker...
-void WormTracker::Add(CvContour const &WormContour)
+// Sample a frame, without tracking it, to pick the threshold and candidate 
+//  size window from. True once the estimate has converged...
+bool WormTracker::AddCalibrationFrame(cv::Mat const &NewGrayImage)
 {
-    // We cannot do anything without at least the gray image...
-    assert(pGrayImage);
+    // Image must be a 8-bit, unsigned, grayscale...
+    assert(NewGrayImage.type() == CV_8UC1);
+
+    // Lock resources...
+    wxMutexLocker   Lock(ResourcesMutex);
 
-    // Breathe life into a new worm from the given contour...
-    Worm &NewWorm = *(new Worm(WormContour, *pGrayImage));
+    // Remember the frame size for unit conversions...
+    ImageSize = cvSize(NewGrayImage.cols, NewGrayImage.rows);
 
-    // Add new worm...
-    TrackingTable.push_back(&NewWorm);
-    
-    // Increment just found count...
-  ++unWormsJustAdded;
+    // Prepare it just as it would be before thresholding, flattened and with
+    //  the inlets corrected. Only a few frames are sampled, so the reference
+    //  opening will do...
+    cv::Mat SourceImage = NewGrayImage;
+    if(Background.IsEnabled())
+    {
+        Background.Flatten(NewGrayImage, FlattenedImage);
+        SourceImage = FlattenedImage;
+    }
+    if(bInletDetection)
+        cv::morphologyEx(SourceImage, CalibrationImage, cv::MORPH_OPEN,
+            cv::getStructuringElement(cv::MORPH_RECT, 
+                cv::Size(unMorphologySize, unMorphologySize)));
+    else
+        SourceImage.copyTo(CalibrationImage);
+
+    // Sample it...
+    return Calibrator.AddFrame(CalibrationImage);
 }
 
-// Add a text label to the thinking image at a point...
-void WormTracker::AddThinkingLabel(string const sLabel, CvPoint Point)
+// Add a text label to a thinking image at a point...
+void WormTracker::AddThinkingLabel(
+    cv::Mat &ThinkingImage, string const &sLabel, CvPoint Point)
 {
-    cv::Mat pThinkingMatImage = cv::cvarrToMat(pThinkingImage); 
-    
     // Draw label line...
-    cv::line(pThinkingMatImage, cvPoint(Point.x + 20, Point.y + 20), Point,
+    cv::line(ThinkingImage, cvPoint(Point.x + 20, Point.y + 20), Point,
 	   CV_RGB(0xfe, 0x00, 0x00)); 
     //cvLine(pThinkingImage, cvPoint(Point.x + 20, Point.y + 20), Point,
     //       CV_RGB(0xfe, 0x00, 0x00));
 
     // Draw text...
-    cv::putText(pThinkingMatImage, sLabel, cvPoint(Point.x + 25, Point.y + 25),  cv::FONT_HERSHEY_PLAIN, 0.7,
+    cv::putText(ThinkingImage, sLabel, cvPoint(Point.x + 25, Point.y + 25),  cv::FONT_HERSHEY_PLAIN, 0.7,
 	    CV_RGB(0xfe, 0x00, 0x00));
     //cvPutText(pThinkingImage, sLabel.c_str(), 
     //          cvPoint(Point.x + 25, Point.y + 25), &ThinkingLabelFont,
@@ -77,16 +247,29 @@ void WormTracker::AddThinkingLabel(string const sLabel, CvPoint Point)
 }
 
 // Advance frame...
+void WormTracker::Advance(IplImage const &NewGrayImage)
+{
+    // Wrap the image's pixels in a header without copying them...
+    Advance(cv::cvarrToMat(&NewGrayImage));
+}
+
+// Advance frame without copying it, numbering it as the next frame tracked...
+void WormTracker::Advance(cv::Mat const &NewGrayImage)
+{
+    // Frames tracked are the only frames there are...
+    Advance(NewGrayImage, unCurrentFrame);
+}
+
+// Same, numbering it by where it was in its video. Working buffers are 
+//  allocated on the first frame and reused thereafter, so only a change in
+//  frame size allocates...
 //  2020/06/13 - Fixed contour drawing by using cvScalar
 // functions instead of CV_RGB which does not return a CvScalar any more 
-void WormTracker::Advance(IplImage const &NewGrayImage)
+void WormTracker::Advance(cv::Mat const &NewGrayImage, 
+                          unsigned int const unSourceFrame)
 {
-    // Variables...
-    CvMemStorage   *pStorage        = NULL;
-    CvContour      *pFirstContour   = NULL;
-    CvContour      *pCurrentContour = NULL;
-    unsigned int    unFoundIndex    = (unsigned) - 1;
-    CvSize const    ImageSize       = cvGetSize(&NewGrayImage);
+    // Image must be a 8-bit, unsigned, grayscale...
+    assert(NewGrayImage.type() == CV_8UC1);
 
     // Lock resources...
     wxMutexLocker   Lock(ResourcesMutex);
@@ -94,199 +277,403 @@ void WormTracker::Advance(IplImage const &NewGrayImage)
     // Lock should have been gained successfully...
     assert(Lock.IsOk());
 
-    // Release the old image, if any...
-    if(pGrayImage)
-        cvReleaseImage(&pGrayImage);
-        
-    // Release the old thinking image, if any...
-    if(pThinkingImage)
-        cvReleaseImage(&pThinkingImage);
-    
-    // Allocate and clone the new one...
-    pGrayImage = cvCloneImage(&NewGrayImage);
-    
-        // Failed...
-        if(!pGrayImage)
-            throw bad_alloc();
-
-    // Prepare the thinking image...
-	// 2020/06/13 - using cv::Mat to get around
-	//issues with cvConvertImage in OpenCV 4
-	cv::Mat pGrayMatImage = cv::cvarrToMat(pGrayImage); 
-	cv::Mat pThinkingMatImage(cvGetSize(pGrayImage), CV_8UC1);
-	//convert to grayscale
-	cv::cvtColor(pGrayMatImage, pThinkingMatImage, CV_GRAY2BGR);
-	  
-	// Allocate...
-        //pThinkingImage = cvCreateImage(ImageSize, IPL_DEPTH_8U, 3);
-	
-	//replace pGrayImage
-	IplImage copyThinkingImg = cvIplImage(pThinkingMatImage);
-	pThinkingImage = &copyThinkingImg;
-        
-        
-            // Failed...
-            if(!pThinkingImage)
-                throw bad_alloc();
+    // Remember the frame size for unit conversions...
+    ImageSize = cvSize(NewGrayImage.cols, NewGrayImage.rows);
+
+    // Cover the frame with centroid cells, if they don't already...
+    if(nCentroidColumns != ImageSize.width / CENTROID_CELL_SIZE + 1 ||
+       nCentroidRows != ImageSize.height / CENTROID_CELL_SIZE + 1)
+        RebuildCentroidGrid();
+
+    // Flatten out uneven illumination, if asked to, and threshold that 
+    //  instead. The worms themselves still see the frame as it was...
+    if(Background.IsEnabled())
+        Background.Flatten(NewGrayImage, FlattenedImage);
+    cv::Mat const &SegmentationImage = 
+        Background.IsEnabled() ? FlattenedImage : NewGrayImage;
+
+    // Size the working buffers to the frame. This allocates only when the 
+    //  frame size changes. Only the reference inlet correction needs the 
+    //  opened image on its own...
+    ThresholdImage.create(NewGrayImage.rows, NewGrayImage.cols, CV_8UC1);
+    if(bInletDetection && bReferenceMode)
+        MorphologicalImage.create(
+            NewGrayImage.rows, NewGrayImage.cols, CV_8UC1);
+
+    // Rebuild the reference inlet correction kernel only if its size has 
+    //  changed...
+    if(bInletDetection && bReferenceMode && 
+       MorphologyKernel.rows != (int) unMorphologySize)
+        MorphologyKernel = cv::getStructuringElement(cv::MORPH_RECT,
+            cv::Size(unMorphologySize, unMorphologySize));
+
+    // Decide where to look for worms. Between rescans, only look around the 
+    //  worms we already know about...
+    int64 const nCoarseStart = cv::getTickCount();
+    Regions.clear();
+    if(unRescanInterval > 0 && !bRescanNeeded && 
+       unFramesSinceRescan < unRescanInterval)
+        GatherRegions();
+
+    // Otherwise, or if there are none to look around, rescan the whole frame
+    //  to pick up newcomers...
+    bool const bCoarse      = (unCoarseScale > 1 && !bReferenceMode);
+    bool const bFullFrame   = Regions.empty();
+    if(bFullFrame)
+    {
+        // Either just where a reduced copy of it says there could be 
+        //  contours...
+        if(bCoarse)
+        {
+            GatherCoarseRegions(SegmentationImage);
+          ++Timings.unCoarseScans;
+        }
 
-        // Copy in the original grayscale image as colour now...
-        //cvConvertImage(pGrayImage, pThinkingImage, CV_GRAY2BGR);
+        // ...or all of it...
+        else
+            Regions.push_back(
+                cv::Rect(0, 0, ImageSize.width, ImageSize.height));
 
-    // Image must be a 8-bit, unsigned, grayscale...
-    assert(pGrayImage->depth == IPL_DEPTH_8U);
+        // Rescanned...
+        unFramesSinceRescan = 0;
+        bRescanNeeded       = false;
+    }
+    else
+      ++unFramesSinceRescan;
+
+    // Find the contours in each region...
+    int64 const nSegmentationStart = cv::getTickCount();
+    unCandidatesFound = 0;
+    for(vector<cv::Rect>::const_iterator Iterator = Regions.begin();
+        Iterator != Regions.end();
+      ++Iterator)
+        SegmentRegion(SegmentationImage, *Iterator, bFullFrame && !bCoarse);
+    int64 const nTrackingStart = cv::getTickCount();
+
+    // Gather the contours that could be worms, and their lengths...
+    PossibleCandidates.clear();
+    CandidateLengths.clear();
+    for(unsigned int unCandidateIndex = 0; 
+        unCandidateIndex < unCandidatesFound;
+      ++unCandidateIndex)
+    {
+        // Get the current candidate...
+        Outline const &CurrentContour = Candidates[unCandidateIndex];
 
-    // Image must not have a region of interest set...
-    assert(pGrayImage->roi == NULL);
+        // Not a possible worm, ignore it...
+        if(!IsPossibleWorm(CurrentContour))
+            continue;
 
-    // Apply morphological operations to get rid of inlets in worm contours...
+        // Remember it, and half way around it, which is as near its length
+        //  as its contour alone can tell...
+        PossibleCandidates.push_back(unCandidateIndex);
+        CandidateLengths.push_back(CurrentContour.Perimeter() / 2.0);
+    }
 
-        // Duplicate the gray image before editing...
-        IplImage *pMorphologicalImage = cvCloneImage(pGrayImage);
+    // Pair them with the worms we know about. When the tracker is being shown
+    //  the worms for the first time, every one is new...
+    AssignCandidates(NewGrayImage);
+
+    // Remember how each worm matched was in this frame, if asked to...
+    if(bRecordTimeSeries)
+        RecordTimeSeries(unSourceFrame);
+
+    // Account for the time spent in each stage...
+    int64 const nTrackingEnd = cv::getTickCount();
+    double const dTickFrequency = cv::getTickFrequency();
+  ++Timings.unFrames;
+    Timings.dCoarseSeconds       += 
+        (nSegmentationStart - nCoarseStart) / dTickFrequency;
+    Timings.dSegmentationSeconds += 
+        (nTrackingStart - nSegmentationStart) / dTickFrequency;
+    Timings.dTrackingSeconds     += 
+        (nTrackingEnd - nTrackingStart) / dTickFrequency;
+    
+    // Keep this frame and every worm on it for the thinking image, if it 
+    //  has been asked for since the last was kept. The frame must outlive
+    //  this call, so it is copied, but it is only drawn on when asked for...
+    if(bThinkingRequested)
+    {
+        // The frame, still in grayscale...
+        NewGrayImage.copyTo(ThinkingFrame);
 
-        // User requested the operation, so edit the image...
-        if(bInletDetection)
+        // Every worm still on the plate...
+        ThinkingWorms.clear();
+        for(unsigned int unWormIndex = 0; unWormIndex < TrackingTable.size();
+          ++unWormIndex)
         {
-            // Allocate conversion kernel...
-            IplConvKernel *pConversionKernel = cvCreateStructuringElementEx(
-                unMorphologySize, unMorphologySize, unMorphologySize / 2, 
-                unMorphologySize / 2, CV_SHAPE_RECT);
+            // Retired worms are no longer on the plate...
+            if(IsRetired(unWormIndex))
+                continue;
+
+            // Remember how it was...
+            Worm const &CurrentWorm = GetWorm(unWormIndex);
+            ThinkingWorm Shown;
+            Shown.Vertices      = CurrentWorm.Contour().Vertices();
+            Shown.Head          = CurrentWorm.Head();
+            Shown.Centre        = CurrentWorm.Centre();
+            Shown.Tail          = CurrentWorm.Tail();
+            Shown.unWormIndex   = unWormIndex;
+            Shown.unRefreshes   = CurrentWorm.Refreshes();
+            ThinkingWorms.push_back(Shown);
+        }
 
-            // Eroding and then dilating the image is same as the higher order
-            //  operation of opening...
-            
-                // Erode...
-                cvErode(pGrayImage, pMorphologicalImage, pConversionKernel, 1);
-            
-                // Dilate...
-                cvDilate(
-                    pMorphologicalImage, pMorphologicalImage, pConversionKernel, 
-                    1);
+        // Kept until asked for again...
+        bThinkingRequested = false;
+    }
+
+    // Advance frame counter...
+  ++unCurrentFrame;
+}
+
+// Use the threshold and candidate size window estimated from the frames 
+//  sampled since the last reset, if any...
+void WormTracker::ApplyCalibration()
+{
+    // Variables...
+    double  dMinimumArea    = 0.0;
+    double  dMaximumArea    = 0.0;
+
+    // Lock resources...
+    wxMutexLocker   Lock(ResourcesMutex);
+
+    // Nothing sampled...
+    if(Calibrator.GetFramesSampled() == 0)
+        return;
+
+    // Use the threshold...
+    unThreshold = Calibrator.GetThreshold();
+
+    // And the candidate size window, in thousandths of a millimeter², if any
+    //  blobs were seen to judge it by...
+    if(Calibrator.GetAreaWindow(dMinimumArea, dMaximumArea))
+    {
+        unMinimumCandidateSize = (unsigned int) std::floor(
+            ConvertSquarePixelsToSquareMillimeters(dMinimumArea) * 1000.0);
+        unMaximumCandidateSize = (unsigned int) std::ceil(
+            ConvertSquarePixelsToSquareMillimeters(dMaximumArea) * 1000.0);
+    }
+}
+
+// Pair this frame's possible worms with the worms being tracked for the least
+//  total cost, each with at most one. Only pairings within a gate are costed,
+//  which splits the problem into small connected components that are each 
+//  solved alone. Left over candidates become new worms and left over worms 
+//  miss a frame...
+void WormTracker::AssignCandidates(cv::Mat const &GrayImage)
+{
+    // Variables...
+    unsigned int const  unCandidates    = PossibleCandidates.size();
+    unsigned int const  unWorms         = TrackingTable.size();
+    unsigned int const  unNodes         = unCandidates + unWorms;
+    double              dGate           = CENTROID_CELL_SIZE;
+
+    // A worm can't have moved much more than its own length since the last 
+    //  frame, so gate on the longest one still being tracked. Half the 
+    //  perimeter never underestimates it, even when the worm is curled...
+    for(unsigned int unWormIndex = 0; unWormIndex < unWorms; ++unWormIndex)
+    {
+        if(!IsRetired(unWormIndex))
+            dGate = std::max(dGate, 
+                             TrackingTable[unWormIndex]->HalfPerimeter());
+    }
 
-            // Done with conversion kernel...
-            cvReleaseStructuringElement(&pConversionKernel);
+    // Every candidate and worm starts out in a component of its own...
+    ComponentParents.resize(unNodes);
+    for(unsigned int unNode = 0; unNode < unNodes; ++unNode)
+        ComponentParents[unNode] = unNode;
+
+    // No worm has been paired with a candidate to refresh it with yet...
+    WormRefreshes.clear();
+
+    // Cost every pairing within the gate, joining their components...
+    AssignmentEdges.clear();
+    for(unsigned int unCandidate = 0; unCandidate < unCandidates; ++unCandidate)
+    {
+        // The candidate's size and where it is. Its area and centre were 
+        //  cached with its moments when it was found...
+        Outline const &CandidateContour = 
+            Candidates[PossibleCandidates[unCandidate]];
+        CvPoint const   CandidateCentre     = CandidateContour.Centre();
+        double const    dCandidateArea      = CandidateContour.Area();
+        double const    dCandidateLength    = CandidateLengths[unCandidate];
+
+        // Worms close enough that they could have become this one...
+        FindWormsNear(CandidateCentre, dGate, NearbyWorms);
+
+        // Cost each...
+        for(vector<unsigned int>::const_iterator Iterator = 
+                NearbyWorms.begin();
+            Iterator != NearbyWorms.end();
+          ++Iterator)
+        {
+            // Worm to cost...
+            unsigned int const  unWormIndex = *Iterator;
+            Worm const         &CurrentWorm = *TrackingTable[unWormIndex];
+            double const        dArea       = CurrentWorm.Area();
+            double const        dLength     = CurrentWorm.HalfPerimeter();
+
+            // How far it would have moved, and how much it would have grown or
+            //  shrunk, each as a fraction so that none outweighs the others...
+            AssignmentEdge Edge;
+            Edge.unCandidate    = unCandidate;
+            Edge.unWorm         = unWormIndex;
+            Edge.unComponent    = 0;
+            Edge.dCost          = 
+                SlitherMath::DistanceBetweenTwoPoints(
+                    CandidateCentre, CurrentWorm.Centre()) / dGate +
+                fabs(dCandidateArea - dArea) / 
+                    std::max(std::max(dCandidateArea, dArea), 1.0) +
+                fabs(dCandidateLength - dLength) / 
+                    std::max(std::max(dCandidateLength, dLength), 1.0);
+            AssignmentEdges.push_back(Edge);
+
+            // Join their components under whichever root is lower, so that 
+            //  each component's root is its first candidate...
+            unsigned int const unCandidateRoot = 
+                FindComponentRoot(unCandidate);
+            unsigned int const unWormRoot = 
+                FindComponentRoot(unCandidates + unWormIndex);
+            ComponentParents[std::max(unCandidateRoot, unWormRoot)] = 
+                std::min(unCandidateRoot, unWormRoot);
         }
+    }
 
-    // Find the contours in the threshold image...
+    // Label each pairing with its component and bring each component's 
+    //  together, in the same order however the worms nearby were found...
+    for(vector<AssignmentEdge>::iterator Iterator = AssignmentEdges.begin();
+        Iterator != AssignmentEdges.end();
+      ++Iterator)
+        Iterator->unComponent = FindComponentRoot(Iterator->unCandidate);
+    std::sort(AssignmentEdges.begin(), AssignmentEdges.end());
 
-        // Create threshold...
-        IplImage *pThresholdImage = cvCloneImage(pMorphologicalImage);
-        cvThreshold(
-            pMorphologicalImage, pThresholdImage, unThreshold, 
-            unMaxThresholdValue, CV_THRESH_BINARY);
+    // Nothing has been matched yet...
+    NodesMatched.assign(unNodes, false);
+    ComponentSlots.resize(unNodes);
 
-        // Allocate contour storage space...
-        pStorage = cvCreateMemStorage(0);
-        
-        // Find contours...
-        cvFindContours(
-            pThresholdImage, pStorage, (CvSeq **) &pFirstContour, 
-            sizeof(CvContour), CV_RETR_LIST, CV_CHAIN_APPROX_NONE, 
-            cvPoint(0, 0));
-
-        // Cleanup...
-        cvReleaseImage(&pThresholdImage);
-        cvReleaseImage(&pMorphologicalImage);
-
-    // Check to see if the tracker is being shown all the worms at once for
-    //  the first time...
-    bool const bInitialDiscovery = Tracking() > 0 ? false : true;
-
-    // Go through each contour found...
-    for(pCurrentContour = pFirstContour; pCurrentContour;
-        pCurrentContour = (CvContour *) pCurrentContour->h_next)
+    // Solve each component alone...
+    unsigned int unLastEdge = 0;
+    for(unsigned int unFirstEdge = 0; unFirstEdge < AssignmentEdges.size();
+        unFirstEdge = unLastEdge)
     {
-        // Not a possible worm, ignore it...
-        if(!IsPossibleWorm(*pCurrentContour))
-            continue;
+        // Find where this component's pairings end...
+        unsigned int const unComponent = 
+            AssignmentEdges[unFirstEdge].unComponent;
+        for(unLastEdge = unFirstEdge; 
+            unLastEdge < AssignmentEdges.size() && 
+            AssignmentEdges[unLastEdge].unComponent == unComponent;
+          ++unLastEdge);
+
+        // Give each of its candidates a row and each of its worms a column, in
+        //  the order they are first seen. Candidates are already in order, 
+        //  but a worm was seen before only if its slot says so...
+        ComponentCandidates.clear();
+        ComponentWorms.clear();
+        for(unsigned int unEdge = unFirstEdge; unEdge < unLastEdge; ++unEdge)
+        {
+            // Pairing...
+            AssignmentEdge const &Edge = AssignmentEdges[unEdge];
+
+            // First time seeing this candidate...
+            if(ComponentCandidates.empty() || 
+               ComponentCandidates.back() != Edge.unCandidate)
+            {
+                ComponentSlots[Edge.unCandidate] = ComponentCandidates.size();
+                ComponentCandidates.push_back(Edge.unCandidate);
+            }
+
+            // First time seeing this worm...
+            unsigned int &unWormSlot = 
+                ComponentSlots[unCandidates + Edge.unWorm];
+            if(unWormSlot >= ComponentWorms.size() || 
+               ComponentWorms[unWormSlot] != Edge.unWorm)
+            {
+                unWormSlot = ComponentWorms.size();
+                ComponentWorms.push_back(Edge.unWorm);
+            }
+        }
+
+        // Lay out its costs densely, with the pairings outside the gate never
+        //  to be made...
+        unsigned int const unRows       = ComponentCandidates.size();
+        unsigned int const unColumns    = ComponentWorms.size();
+        ComponentCosts.assign(unRows * unColumns, SlitherMath::Infinity);
+        for(unsigned int unEdge = unFirstEdge; unEdge < unLastEdge; ++unEdge)
+        {
+            AssignmentEdge const &Edge = AssignmentEdges[unEdge];
+            ComponentCosts[ComponentSlots[Edge.unCandidate] * unColumns + 
+                           ComponentSlots[unCandidates + Edge.unWorm]] = 
+                Edge.dCost;
+        }
 
-        // Possible worm and initiating for first time, assume every worm
-        //  unique...
-        else if(bInitialDiscovery)
-            Add(*pCurrentContour);
+        // Solve...
+        SlitherMath::SolveAssignment(
+            ComponentCosts, unRows, unColumns, ComponentAssignments);
 
-        // Possible worm and some things are already known about the world...
-        else
+        // Note each worm that was matched with its candidate, to be refreshed
+        //  with the rest once every component is solved...
+        for(unsigned int unRow = 0; unRow < unRows; ++unRow)
         {
-            // Find the nearest worm to this one...
-            unFoundIndex = FindNearestWorm(*pCurrentContour);
-            
-            // Let's hope they are really one and the same. Refresh it with the
-            //  new information...
-            TrackingTable.at(unFoundIndex)->Refresh(*pCurrentContour, 
-                                                    *pGrayImage);
+            // Not matched...
+            if(ComponentAssignments[unRow] < 0)
+                continue;
+
+            // Which candidate and which worm...
+            unsigned int const unCandidate  = ComponentCandidates[unRow];
+            unsigned int const unWormIndex  = 
+                ComponentWorms[ComponentAssignments[unRow]];
+
+            // Let's hope they are really one and the same. It hasn't missed
+            //  this frame...
+            WormRefreshes.push_back(make_pair(
+                unWormIndex, PossibleCandidates[unCandidate]));
+            WormMissedFrames[unWormIndex] = 0;
+
+            // Both are spoken for...
+            NodesMatched[unCandidate]                = true;
+            NodesMatched[unCandidates + unWormIndex] = true;
         }
     }
-    
-    // Cleanup...
-    cvReleaseMemStorage(&pStorage); 
-    
-    // Show some information on each worm contour...
-    for(unsigned int unWormIndex = 0; unWormIndex < TrackingTable.size();
-      ++unWormIndex)
+
+    // Every worm that wasn't matched missed this frame, and is retired once it
+    //  has missed too many in a row...
+    for(unsigned int unWormIndex = 0; unWormIndex < unWorms; ++unWormIndex)
     {
-        // Get the current worm...
-        Worm const &CurrentWorm = GetWorm(unWormIndex);
+        // Matched, or already retired...
+        if(NodesMatched[unCandidates + unWormIndex] || IsRetired(unWormIndex))
+            continue;
 
-        // Draw the contours onto the thinking image...
-	
-	// 2020/06/13 - since we cannot use CV_RGB(r,g,b) as it no longer
-	//returns a CvScalar, we need to use cvScalar(b,g,r)
-	//The RGB value is (0x00, 0x00, 0xfe)	
-	//ref: https://www.rubydoc.info/github/gonzedge/ruby-opencv/OpenCV/CvScalar
-	CvScalar externColour = cvScalar(0xfe, 0x00, 0x00);
-	CvScalar holeColour = cvScalar(0xfe, 0x00, 0x00);	
-        cvDrawContours(pThinkingImage, (CvSeq *) &CurrentWorm.Contour(),
-                       externColour, holeColour, 0, 
-                       1);
-	
-        // Show some information about the worm on the thinking image...
-        AddThinkingLabel("head", CurrentWorm.Head());
-        std::ostringstream ssCentre;
-        ssCentre << "(worm " << unWormIndex + 1 << ", updated " 
-                 << CurrentWorm.Refreshes() << ")";
-        AddThinkingLabel(ssCentre.str(), CurrentWorm.Centre());
-        AddThinkingLabel("tail", CurrentWorm.Tail());
+        // Missed another. It may have wandered off, so look everywhere next 
+        //  frame...
+        bRescanNeeded = true;
+        if(++WormMissedFrames[unWormIndex] > MAXIMUM_MISSED_FRAMES)
+            RetireWorm(unWormIndex);
     }
-    
-    // Show one millimeter legend...
-    
-        // Convert one millimeter to pixels...
-        unsigned int const unLegendLength = 
-            (unsigned int) ConvertMillimetersToPixels(1.0f);
-	
-	// Fixing line and text to work with OpenCV 4
-	//C++ API	
-        // Draw the legend line...
-        //cvLine(pThinkingImage, 
-        //       cvPoint(50, ImageSize.height - 5),
-        //       cvPoint(50 + unLegendLength, ImageSize.height - 5),
-        //       CV_RGB(0x00, 0x00, 0xff), 2);
-
-	cv::line(pThinkingMatImage, 
-               cvPoint(50, ImageSize.height - 5),
-               cvPoint(50 + unLegendLength, ImageSize.height - 5),
-               CV_RGB(0x00, 0x00, 0xff), 2);
-
-        // Draw label...
-        //cvPutText(pThinkingImage, "1 mm", 
-        //            cvPoint(50 + unLegendLength + 5, ImageSize.height - 3), 
-        //            &ThinkingLabelFont, CV_RGB(0x00, 0x00, 0xff));
-	
-	cv::putText(pThinkingMatImage, "1 mm", 
-                    cvPoint(50 + unLegendLength + 5, ImageSize.height - 3), 
-                    cv::FONT_HERSHEY_PLAIN, 0.7, CV_RGB(0x00, 0x00, 0xff));
 
+    // Every candidate that wasn't matched is a new worm. Leave a slot at the
+    //  end of the table for each. It has missed no frames yet...
+    for(unsigned int unCandidate = 0; unCandidate < unCandidates; ++unCandidate)
+    {
+        // Matched...
+        if(NodesMatched[unCandidate])
+            continue;
 
-    // Advance frame counter...
-  ++unCurrentFrame;
+        // Make room for it...
+        WormRefreshes.push_back(make_pair(
+            (unsigned int) TrackingTable.size(), 
+            PossibleCandidates[unCandidate]));
+        TrackingTable.push_back(NULL);
+        WormMissedFrames.push_back(0);
+      ++unWormsJustAdded;
+    }
+
+    // Refresh them all...
+    RefreshWorms(GrayImage);
 }
 
 // Convert from pixels to millimeters...
 double WormTracker::ConvertMillimetersToPixels(double const dMillimeters) const
 {
-    // Get the image size...
-    CvSize const ImageSize = cvGetSize(pGrayImage);
-
     // Convert units...
     return ((ImageSize.width / fFieldOfViewDiameter) * dMillimeters);
 }
@@ -294,9 +681,6 @@ double WormTracker::ConvertMillimetersToPixels(double const dMillimeters) const
 // Convert millimeters to pixels...
 double WormTracker::ConvertPixelsToMillimeters(double const dPixels) const
 {
-    // Get the image size...
-    CvSize const ImageSize = cvGetSize(pGrayImage);
-
     // Convert units...
     return ((fFieldOfViewDiameter / ImageSize.width) * dPixels);
 }
@@ -311,7 +695,7 @@ double WormTracker::ConvertSquarePixelsToSquareMillimeters(
 
 // How many underlying rectangles does given one rest upon?
 unsigned int const WormTracker::CountRectanglesIntersected(
-    CvRect const &Rectangle) const
+    cv::Rect const &Rectangle) const
 {
     // Variables...
     unsigned int unIntersections = 0;
@@ -333,6 +717,156 @@ unsigned int const WormTracker::CountRectanglesIntersected(
     return unIntersections;
 }
 
+// Find the root of a node's connected component, flattening the path to it 
+//  along the way...
+unsigned int WormTracker::FindComponentRoot(unsigned int const unNode)
+{
+    // Variables...
+    unsigned int unRoot = unNode;
+
+    // Climb to the root...
+    while(ComponentParents[unRoot] != unRoot)
+        unRoot = ComponentParents[unRoot];
+
+    // Point everything on the way straight at it...
+    for(unsigned int unCurrent = unNode; unCurrent != unRoot;)
+    {
+        unsigned int const unParent = ComponentParents[unCurrent];
+        ComponentParents[unCurrent] = unRoot;
+        unCurrent = unParent;
+    }
+
+    // Done...
+    return unRoot;
+}
+
+// Gather the regions of a full frame scan that could have any contours in them
+//  from a reduced copy of the frame, merged wherever they overlap. Every 
+//  contour is traced along bright pixels that touch a dark one, and so lies in
+//  cells with a bright pixel and a dark one in or next to them. Inlet 
+//  correction only darkens, and never further than a kernel from a dark 
+//  pixel, so cells that far from one are as near as it needs looking. Each 
+//  cluster of such cells holds the whole of every contour in it, so finding
+//  the contours in just those gives the same contours as the whole frame. θ(n)
+//  in pixels, but only reading them...
+void WormTracker::GatherCoarseRegions(cv::Mat const &GrayImage)
+{
+    // Variables...
+    cv::Rect const  Frame(0, 0, ImageSize.width, ImageSize.height);
+    int const       nScale      = (int) unCoarseScale;
+    int const       nColumns    = (GrayImage.cols + nScale - 1) / nScale;
+    int const       nRows       = (GrayImage.rows + nScale - 1) / nScale;
+    float const     fMinimumArea = (float) unMinimumCandidateSize / 1000.0f;
+
+    // How many cells away a dark pixel can still put a contour...
+    int const nReach = bInletDetection ? 
+        ((int) unMorphologySize + nScale - 1) / nScale : 1;
+
+    // Find the darkest and brightest pixel in each cell...
+    CoarseDarkest.create(nRows, nColumns, CV_8UC1);
+    CoarseBrightest.create(nRows, nColumns, CV_8UC1);
+    CoarseDarkest.setTo(cv::Scalar(0xff));
+    CoarseBrightest.setTo(cv::Scalar(0x00));
+    for(int nRow = 0; nRow < GrayImage.rows; ++nRow)
+    {
+        // This row and the cells it is in...
+        unsigned char const *pPixels    = GrayImage.ptr<unsigned char>(nRow);
+        unsigned char       *pDarkest   = 
+            CoarseDarkest.ptr<unsigned char>(nRow / nScale);
+        unsigned char       *pBrightest = 
+            CoarseBrightest.ptr<unsigned char>(nRow / nScale);
+
+        // Each pixel...
+        for(int nColumn = 0; nColumn < GrayImage.cols; ++nColumn)
+        {
+            unsigned char const ucPixel = pPixels[nColumn];
+            int const           nCell   = nColumn / nScale;
+            pDarkest[nCell]     = std::min(pDarkest[nCell], ucPixel);
+            pBrightest[nCell]   = std::max(pBrightest[nCell], ucPixel);
+        }
+    }
+
+    // Mark the cells with a bright pixel and a dark one within reach...
+    cv::compare(CoarseDarkest, cv::Scalar(unThreshold), CoarseDark, 
+                cv::CMP_LE);
+    cv::dilate(CoarseDark, CoarseDark, cv::getStructuringElement(
+        cv::MORPH_RECT, cv::Size(2 * nReach + 1, 2 * nReach + 1)));
+    cv::compare(CoarseBrightest, cv::Scalar(unThreshold), CoarseMarks, 
+                cv::CMP_GT);
+    cv::bitwise_and(CoarseMarks, CoarseDark, CoarseMarks);
+
+    // Cluster them...
+    int const nLabels = cv::connectedComponentsWithStats(
+        CoarseMarks, CoarseLabels, CoarseStatistics, CoarseCentroids, 8, 
+        CV_32S);
+
+    // Each cluster's cells, at full resolution...
+    for(int nLabel = 1; nLabel < nLabels; ++nLabel)
+    {
+        // Its rectangle, and a pixel more so that no contour in it touches 
+        //  the edge...
+        int const *pStatistics = CoarseStatistics.ptr<int>(nLabel);
+        cv::Rect const Region(
+            pStatistics[cv::CC_STAT_LEFT] * nScale - 1,
+            pStatistics[cv::CC_STAT_TOP] * nScale - 1,
+            pStatistics[cv::CC_STAT_WIDTH] * nScale + 2,
+            pStatistics[cv::CC_STAT_HEIGHT] * nScale + 2);
+
+        // Too small to enclose a worm, whatever is in it...
+        if(ConvertSquarePixelsToSquareMillimeters(
+            double(Region.width - 2) * (Region.height - 2)) < fMinimumArea)
+            continue;
+
+        // Look there...
+        Regions.push_back(Region & Frame);
+    }
+
+    // Merge them wherever they overlap...
+    MergeRegions();
+}
+
+// Gather the regions around every worm still being tracked, padded for how 
+//  far it might have moved and merged wherever they overlap...
+void WormTracker::GatherRegions()
+{
+    // Variables...
+    cv::Rect const  Frame(0, 0, ImageSize.width, ImageSize.height);
+    int const       nPadding = 
+        std::max((int) REGION_PADDING, (int) unMorphologySize);
+
+    // Pad each active worm's bounding rectangle, keeping it on the frame...
+    for(unsigned int unWormIndex = 0; unWormIndex < TrackingTable.size();
+      ++unWormIndex)
+    {
+        // Retired worms are no longer looked for...
+        if(IsRetired(unWormIndex))
+            continue;
+
+        // Pad...
+        cv::Rect const &Bounds = TrackingTable[unWormIndex]->Rectangle();
+        cv::Rect const Region(Bounds.x - nPadding, Bounds.y - nPadding,
+                              Bounds.width + 2 * nPadding, 
+                              Bounds.height + 2 * nPadding);
+        Regions.push_back(Region & Frame);
+    }
+
+    // Merge them wherever they overlap...
+    MergeRegions();
+}
+
+// Get the cell containing the given point, clamped to the frame...
+unsigned int WormTracker::GetCentroidCell(CvPoint const &Point) const
+{
+    // Row and column...
+    int const nColumn = std::min(std::max(Point.x / CENTROID_CELL_SIZE, 0), 
+                                 nCentroidColumns - 1);
+    int const nRow    = std::min(std::max(Point.y / CENTROID_CELL_SIZE, 0), 
+                                 nCentroidRows - 1);
+
+    // Row major...
+    return nRow * nCentroidColumns + nColumn;
+}
+
 // Get the current frame index...
 unsigned int const WormTracker::GetCurrentFrameIndex() const
 {
@@ -343,26 +877,103 @@ unsigned int const WormTracker::GetCurrentFrameIndex() const
     return unCurrentFrame;
 }
 
-// Get a copy of the current thinking image. Caller frees...
+// Get a copy of the current thinking image, drawn now from the last frame
+//  kept for it, or null if none has been yet. Each call asks for the next 
+//  frame to be kept too. Caller frees...
 IplImage *WormTracker::GetThinkingImage() const
 {
-    // Lock resources...
-    wxMutexLocker   Lock(ResourcesMutex);
-    
-    // If a deadlock was encountered, just abort...
-    if(!Lock.IsOk())
-        return NULL;
-
-    // Clone the thinking image, if any...
-    if(pThinkingImage) {
-	cerr << "Trying to clone image..." << endl;
-        return cvCloneImage(pThinkingImage);
+    // Variables...
+    IplImage               *pThinkingImage  = NULL;
+    cv::Mat                 ThinkingImage;
+    vector<ThinkingWorm>    Worms;
+    unsigned int            unLegendLength  = 0;
+
+    // Take what we need from the frame kept while holding the lock, and then
+    //  draw on it without, so the tracker isn't kept waiting...
+    {
+        // Lock resources...
+        wxMutexLocker   Lock(ResourcesMutex);
+
+        // If a deadlock was encountered, just abort...
+        if(!Lock.IsOk())
+            return NULL;
+
+        // Keep the next frame for whoever asks next...
+        bThinkingRequested = true;
+
+        // No frame kept yet...
+        if(ThinkingFrame.empty())
+            return NULL;
+
+        // Allocate...
+        pThinkingImage = cvCreateImage(
+            cvSize(ThinkingFrame.cols, ThinkingFrame.rows), IPL_DEPTH_8U, 3);
+
+            // Failed...
+            if(!pThinkingImage)
+                throw bad_alloc();
+
+        // Share its pixels so the C++ drawing functions can draw onto it...
+        ThinkingImage = cv::cvarrToMat(pThinkingImage);
+
+        // Copy in the frame as colour, the worms on it, and the length of a
+        //  millimeter...
+        cv::cvtColor(ThinkingFrame, ThinkingImage, cv::COLOR_GRAY2BGR);
+        Worms           = ThinkingWorms;
+        unLegendLength  = (unsigned int) ConvertMillimetersToPixels(1.0f);
     }
-    // Otherwise, no thinking image available yet...
-    else {
-	cerr << "Cannot clone image!" << endl;
-        return NULL;
+
+    // Show some information on each worm...
+    for(vector<ThinkingWorm>::const_iterator Iterator = Worms.begin();
+        Iterator != Worms.end();
+      ++Iterator)
+    {
+        // Draw its contour...
+        cv::polylines(ThinkingImage, Iterator->Vertices, true,
+                      cv::Scalar(0xfe, 0x00, 0x00), 1);
+
+        // Label its ends and centre...
+        AddThinkingLabel(ThinkingImage, "head", Iterator->Head);
+        std::ostringstream ssCentre;
+        ssCentre << "(worm " << Iterator->unWormIndex + 1 << ", updated " 
+                 << Iterator->unRefreshes << ")";
+        AddThinkingLabel(ThinkingImage, ssCentre.str(), Iterator->Centre);
+        AddThinkingLabel(ThinkingImage, "tail", Iterator->Tail);
     }
+
+    // Show one millimeter legend...
+    cv::line(ThinkingImage, 
+             cvPoint(50, ThinkingImage.rows - 5),
+             cvPoint(50 + unLegendLength, ThinkingImage.rows - 5),
+             CV_RGB(0x00, 0x00, 0xff), 2);
+    cv::putText(ThinkingImage, "1 mm", 
+                cvPoint(50 + unLegendLength + 5, ThinkingImage.rows - 3), 
+                cv::FONT_HERSHEY_PLAIN, 0.7, CV_RGB(0x00, 0x00, 0xff));
+
+    // Done...
+    return pThinkingImage;
+}
+
+// Get the time spent in each stage of advancing frames since the last reset...
+StageTimings WormTracker::GetStageTimings() const
+{
+    // Lock resources...
+    wxMutexLocker   Lock(ResourcesMutex);
+
+    // Return them...
+    return Timings;
+}
+
+// Get a worm's measurements from every frame it was matched in since the last
+//  reset, oldest first, in pixels...
+bool WormTracker::GetTimeSeries(
+    unsigned int const unWormIndex, vector<WormSample> &Samples) const
+{
+    // Lock resources...
+    wxMutexLocker   Lock(ResourcesMutex);
+
+    // Copy them out...
+    return TimeSeries.GetSamples(unWormIndex, Samples);
 }
 
 // Get the total number of frames...
@@ -396,95 +1007,152 @@ unsigned int const WormTracker::GetWormsAddedSinceLastCheck()
     return unTemp;
 }
 
-// Find the nearest worm to given...
-unsigned int WormTracker::FindNearestWorm(CvContour const &WormContour) const
+// Find every active worm whose centre is within the given radius of a point,
+//  looking only in the cells around it...
+void WormTracker::FindWormsNear(CvPoint const &Point, double const dRadius,
+                                vector<unsigned int> &Worms) const
 {
-    // Variables...
-    CvMoments       WormMoment;
-    CvPoint         WormCentre              = {0, 0};
-    double          dDistanceToClosestWorm  = FLT_MAX;
-    unsigned int    unClosestWormIndex      = (unsigned) -1;
-
-    // It doesn't make sense to ask us if we have no data...
-    assert(Tracking() != 0);
-
-    // Calculate the gravitational centre of the given contour...
-
-        // Compute all moments of the contour...
-        cvMoments(&WormContour, &WormMoment);
+    // Check every worm instead, if asked...
+    if(bReferenceMode)
+        return FindWormsNearLinearly(Point, dRadius, Worms);
+
+    // Start with nothing...
+    Worms.clear();
+
+    // Nothing binned yet...
+    if(CentroidCells.empty())
+        return;
+
+    // The cells the circle's bounding square covers, clamped to the frame as
+    //  worm centres are...
+    int const nReach        = (int) ceil(dRadius);
+    int const nFirstColumn  = std::min(std::max(
+        (Point.x - nReach) / CENTROID_CELL_SIZE, 0), nCentroidColumns - 1);
+    int const nLastColumn   = std::min(std::max(
+        (Point.x + nReach) / CENTROID_CELL_SIZE, 0), nCentroidColumns - 1);
+    int const nFirstRow     = std::min(std::max(
+        (Point.y - nReach) / CENTROID_CELL_SIZE, 0), nCentroidRows - 1);
+    int const nLastRow      = std::min(std::max(
+        (Point.y + nReach) / CENTROID_CELL_SIZE, 0), nCentroidRows - 1);
+
+    // Check each worm in each of them...
+    for(int nRow = nFirstRow; nRow <= nLastRow; ++nRow)
+    {
+        for(int nColumn = nFirstColumn; nColumn <= nLastColumn; ++nColumn)
+        {
+            // Cell...
+            vector<unsigned int> const &Cell = 
+                CentroidCells[nRow * nCentroidColumns + nColumn];
+            for(vector<unsigned int>::const_iterator Iterator = Cell.begin();
+                Iterator != Cell.end();
+              ++Iterator)
+            {
+                // Close enough...
+                if(SlitherMath::DistanceBetweenTwoPoints(
+                    Point, TrackingTable[*Iterator]->Centre()) <= dRadius)
+                    Worms.push_back(*Iterator);
+            }
+        }
+    }
+}
 
-        // Extract centre of gravity...
-        WormCentre.x = int(WormMoment.m10 / WormMoment.m00);
-        WormCentre.y = int(WormMoment.m01 / WormMoment.m00);
+// Find every active worm whose centre is within the given radius of a point by
+//  checking every worm. This is the reference for FindWormsNear()... θ(n)
+void WormTracker::FindWormsNearLinearly(CvPoint const &Point, 
+                                        double const dRadius,
+                                        vector<unsigned int> &Worms) const
+{
+    // Start with nothing...
+    Worms.clear();
 
-    // Check each worm's proximity to this one...
+    // Check each worm's proximity to the point...
     for(unsigned int unWormIndex = 0; unWormIndex < TrackingTable.size();
       ++unWormIndex)
     {
-        // Worm to check...
-        Worm const &CurrentWorm = *TrackingTable.at(unWormIndex);
-
-        // How far away is the given worm to this iteration's...
-        double const dDistanceToWorm = 
-            cvSqrt(pow(double(WormCentre.x) - CurrentWorm.Centre().x, 2) + 
-                   pow(double(WormCentre.y) - CurrentWorm.Centre().y, 2));
+        // Retired worms are never matched...
+        if(IsRetired(unWormIndex))
+            continue;
 
-        // Remember only if its centre of mass has best proximity...
-        if(dDistanceToWorm < dDistanceToClosestWorm)
-        {
-            // Make a note of how close it was and which worm...
-            dDistanceToClosestWorm  = dDistanceToWorm;
-            unClosestWormIndex      = unWormIndex;
-        }
+        // Close enough...
+        if(SlitherMath::DistanceBetweenTwoPoints(
+            Point, TrackingTable[unWormIndex]->Centre()) <= dRadius)
+            Worms.push_back(unWormIndex);
     }
-    
-    // Return index...
-    return unClosestWormIndex;
+}
+
+// Use the same field of view and artificial intelligence magic as another
+//  tracker...
+void WormTracker::ImportSettings(WormTracker const &Source)
+{
+    // Field of view...
+    fFieldOfViewDiameter    = Source.fFieldOfViewDiameter;
+
+    // How often to rescan the whole frame, and how to tile it...
+    SetRescanInterval(Source.unRescanInterval);
+    SetTiledSegmentation(Source.unTileRows);
+    SetCoarseDetection(Source.unCoarseScale);
+
+    // Artificial intelligence magic...
+    SetArtificialIntelligenceMagic(
+        Source.unThreshold,
+        Source.unMaxThresholdValue,
+        Source.unMinimumCandidateSize,
+        Source.unMaximumCandidateSize,
+        Source.bInletDetection,
+        Source.unMorphologySize);
+    SetBackgroundModel(Source.unBackgroundScale, Source.unBackgroundLearning);
+    SetAutoCalibration(Source.bAutoCalibration, Source.CalibrationMethod);
+
+    // Whether to record the time series, and how much of it to keep in 
+    //  memory...
+    SetTimeSeriesRecording(Source.bRecordTimeSeries);
+    SetTimeSeriesResidentLimit(Source.TimeSeries.GetResidentLimit());
+}
+
+// Is the threshold and candidate size window picked automatically for each 
+//  media?
+bool WormTracker::IsAutoCalibrating() const
+{
+    // Return it...
+    return bAutoCalibration;
 }
 
 // Do any points on the mystery contour lie on the image exterior?
-bool WormTracker::IsAnyPointOnImageExterior(CvContour const &MysteryContour)
+bool WormTracker::IsAnyPointOnImageExterior(Outline const &MysteryContour)
     const
 {
     // Image size...
-    CvSize const Size = cvGetSize(pGrayImage);
+    CvSize const &Size = ImageSize;
 
-    // Check each point to see if any lie on image exterior...
-    for(unsigned int unVertexIndex = 0; 
-        unVertexIndex < (unsigned) MysteryContour.total; 
-        unVertexIndex++)
-    {
-        // Get the point...
-        CvPoint const &Point = *((CvPoint *) 
-            cvGetSeqElem((CvSeq *) &MysteryContour, unVertexIndex));
+    // The bounding rectangle touches the extreme vertices, so there is no need
+    //  to check every point...
+    cv::Rect const &Bounds = MysteryContour.BoundingRectangle();
 
-        // On either the left or right extremity...
-        if(Point.x == 0 || Point.x == Size.width)
-            return true;
+    // On either the left or right extremity. The bounding rectangle ends one
+    //  past its last column and row...
+    if(Bounds.x == 0 || Bounds.br().x == Size.width)
+        return true;
 
-        // On either the top or bottom extremity...
-        if(Point.y == 0 || Point.y == Size.height)
-            return true;
-    }
+    // On either the top or bottom extremity...
+    if(Bounds.y == 0 || Bounds.br().y == Size.height)
+        return true;
 
     // Every vertex came out non-tangent to the exterior...
     return false;
 }
 
 // Could this contour be a worm, independent of what we know?
-bool WormTracker::IsPossibleWorm(CvContour const &MysteryContour) const
+bool WormTracker::IsPossibleWorm(Outline const &MysteryContour) const
 {
-    cerr << "FOV: " << fFieldOfViewDiameter << endl;
     // Too few vertices...
-    if(MysteryContour.total < 6) {
-	cerr << "Contours: " << MysteryContour.total << endl;
+    if(MysteryContour.Size() < 6)
         return false;
-    }
+
     // We must have had the field of view diameter set...
     assert(fFieldOfViewDiameter > 0.0f);
 
     // Calculate the pixel area of the worm...
-    double const dPixelArea = fabs(cvContourArea(&MysteryContour));
+    double const dPixelArea = MysteryContour.Area();
     
     // Convert the pixel area to mm²...
     double const dMillimeterArea = 
@@ -505,8 +1173,8 @@ bool WormTracker::IsPossibleWorm(CvContour const &MysteryContour) const
 }
 
 // Do the two rectangles have a non-zero intersection area?
-bool WormTracker::IsRectanglesIntersect(CvRect const &RectangleOne,
-                                        CvRect const &RectangleTwo) const
+bool WormTracker::IsRectanglesIntersect(cv::Rect const &RectangleOne,
+                                        cv::Rect const &RectangleTwo) const
 {
     // Check...
     return (RectangleOne.x < RectangleTwo.x + RectangleTwo.width) && 
@@ -515,6 +1183,125 @@ bool WormTracker::IsRectanglesIntersect(CvRect const &RectangleOne,
            (RectangleOne.y + RectangleOne.height > RectangleTwo.y);
 }
 
+// Is every worm's measurements from every frame being recorded?
+bool WormTracker::IsRecordingTimeSeries() const
+{
+    // Return it...
+    return bRecordTimeSeries;
+}
+
+// Has the worm gone unmatched for too long to still be tracked?
+bool WormTracker::IsRetired(unsigned int const unWormIndex) const
+{
+    // Check...
+    return WormMissedFrames.at(unWormIndex) > MAXIMUM_MISSED_FRAMES;
+}
+
+// Merge the regions that overlap until none do, so that no contour is found 
+//  twice...
+void WormTracker::MergeRegions()
+{
+    // Variables...
+    bool            bMerged = false;
+
+    // A merged region can overlap ones already checked, so go around again 
+    //  whenever anything merges...
+    do
+    {
+        // Nothing merged yet on this pass...
+        bMerged = false;
+
+        // Check each pair...
+        for(unsigned int unFirst = 0; unFirst < Regions.size(); ++unFirst)
+        {
+            for(unsigned int unSecond = unFirst + 1; 
+                unSecond < Regions.size();)
+            {
+                // Apart...
+                if(!IsRectanglesIntersect(Regions[unFirst], Regions[unSecond]))
+                {
+                  ++unSecond;
+                    continue;
+                }
+
+                // Take the second into the first, and the last into its 
+                //  place...
+                Regions[unFirst] |= Regions[unSecond];
+                Regions[unSecond] = Regions.back();
+                Regions.pop_back();
+                bMerged = true;
+            }
+        }
+    }
+    while(bMerged);
+}
+
+// Size the centroid cells to the frame and bin every worm again...
+void WormTracker::RebuildCentroidGrid()
+{
+    // Enough cells to cover the frame...
+    nCentroidColumns    = ImageSize.width / CENTROID_CELL_SIZE + 1;
+    nCentroidRows       = ImageSize.height / CENTROID_CELL_SIZE + 1;
+
+    // Empty them. Each keeps its storage from before...
+    CentroidCells.resize(nCentroidColumns * nCentroidRows);
+    for(vector<vector<unsigned int> >::iterator Iterator = 
+            CentroidCells.begin();
+        Iterator != CentroidCells.end();
+      ++Iterator)
+        Iterator->clear();
+
+    // Bin every worm again...
+    WormCentroidCells.clear();
+    for(unsigned int unWormIndex = 0; unWormIndex < TrackingTable.size();
+      ++unWormIndex)
+        UpdateCentroidCell(unWormIndex);
+}
+
+// Refresh every worm matched this frame with its candidate and breathe life 
+//  into a new worm from every candidate left over, all at once on whichever
+//  processors OpenCV gives them, and then bin them all...
+void WormTracker::RefreshWorms(cv::Mat const &GrayImage)
+{
+    // Refresh them...
+    WormRefresher const Refresher(
+        WormRefreshes, Candidates, GrayImage, TrackingTable);
+    cv::Range const Range(0, WormRefreshes.size());
+
+        // One after another, when validating...
+        if(bReferenceMode)
+            Refresher(Range);
+
+        // Otherwise all at once...
+        else
+            cv::parallel_for_(Range, Refresher);
+
+    // Each has probably moved, or is new, so bin it again. The new worms 
+    //  come last, in the order they were added, as binning them expects...
+    for(vector<pair<unsigned int, unsigned int> >::const_iterator Iterator = 
+            WormRefreshes.begin();
+        Iterator != WormRefreshes.end();
+      ++Iterator)
+        UpdateCentroidCell(Iterator->first);
+}
+
+// Stop matching a worm, but keep it in the tracking table so its history can
+//  still be reported...
+void WormTracker::RetireWorm(unsigned int const unWormIndex)
+{
+    // Cell it was in...
+    unsigned int &unCell = WormCentroidCells.at(unWormIndex);
+
+    // Already out of the cells...
+    if(unCell == (unsigned) -1)
+        return;
+
+    // Take it out of its cell, so it is never found nearby again...
+    vector<unsigned int> &OldCell = CentroidCells[unCell];
+    OldCell.erase(std::find(OldCell.begin(), OldCell.end(), unWormIndex));
+    unCell = (unsigned) -1;
+}
+
 // The number of worms we are currently tracking...
 unsigned int WormTracker::Tracking() const
 {
@@ -541,16 +1328,37 @@ void WormTracker::Reset(unsigned int const _unTotalFrames)
         
         // Clear the dead pointer table space...
         TrackingTable.clear();
+        WormMissedFrames.clear();
+
+        // Forget their measurements from every frame, keeping the memory...
+        TimeSeries.Clear();
+
+        // Forget where they were. The cells are sized again on the next 
+        //  frame...
+        CentroidCells.clear();
+        WormCentroidCells.clear();
+        nCentroidColumns    = 0;
+        nCentroidRows       = 0;
+
+    // Forget the frame size, and the illumination learnt from the frames...
+    ImageSize = cvSize(0, 0);
+    Background.Reset();
+
+    // Sample afresh for the next calibration...
+    Calibrator.Reset();
+
+    // Start timing afresh...
+    Timings = StageTimings();
 
-    // Cleanup the gray image, if any...
-    if(pGrayImage)
-        cvReleaseImage(&pGrayImage);
-    pGrayImage = NULL;
+    // Scan the whole of the next frame...
+    unFramesSinceRescan = 0;
+    bRescanNeeded       = true;
 
-    // Cleanup the thinking image, if any...
-    if(pThinkingImage)
-        cvReleaseImage(&pThinkingImage);
-    pThinkingImage = NULL;
+    // Forget the frame kept for the thinking image, if any, and keep the 
+    //  next so there is always one to show...
+    ThinkingFrame.release();
+    ThinkingWorms.clear();
+    bThinkingRequested = true;
         
     // Worms just added in this frame...
     unWormsJustAdded = 0;
@@ -560,6 +1368,162 @@ void WormTracker::Reset(unsigned int const _unTotalFrames)
     unTotalFrames   = _unTotalFrames;
 }
 
+// Add every worm matched this frame to its time series, numbered by where it
+//  was in its video...
+void WormTracker::RecordTimeSeries(unsigned int const unSourceFrame)
+{
+    // Check each worm...
+    for(unsigned int unWormIndex = 0; unWormIndex < TrackingTable.size();
+      ++unWormIndex)
+    {
+        // Not matched this frame...
+        if(WormMissedFrames[unWormIndex] != 0)
+            continue;
+
+        // How it was...
+        Worm const &CurrentWorm = GetWorm(unWormIndex);
+        WormSample Sample;
+        Sample.unFrame  = unSourceFrame;
+        Sample.CentreX  = (short) CurrentWorm.Centre().x;
+        Sample.CentreY  = (short) CurrentWorm.Centre().y;
+        Sample.HeadX    = (short) CurrentWorm.Head().x;
+        Sample.HeadY    = (short) CurrentWorm.Head().y;
+        Sample.TailX    = (short) CurrentWorm.Tail().x;
+        Sample.TailY    = (short) CurrentWorm.Tail().y;
+        Sample.fLength  = (float) CurrentWorm.FrameLength();
+        Sample.fWidth   = (float) CurrentWorm.FrameWidth();
+        Sample.fArea    = (float) CurrentWorm.Contour().Area();
+
+        // ...and its posture, which the sample must have room for...
+        static_assert(
+            (int) WormSample::POSTURE_ANGLES == (int) Worm::POSTURE_ANGLES &&
+            (int) WormSample::MAXIMUM_POSTURE_MODES == 
+                (int) Worm::MAXIMUM_POSTURE_MODES,
+            "WormSample's posture must be the same size as the worm's");
+        Worm::PostureDescriptor const &Posture = CurrentWorm.Posture();
+        memcpy(Sample.TangentAngles, Posture.TangentAngles, 
+               sizeof(Sample.TangentAngles));
+        memcpy(Sample.Projections, Posture.Projections, 
+               sizeof(Sample.Projections));
+        Sample.unPostureModes   = Posture.unModes;
+        Sample.bPostureValid    = Posture.bValid;
+
+        // Add it to the end of its series...
+        TimeSeries.Append(unWormIndex, Sample);
+    }
+}
+
+// Find the contours in a region of the frame and swap them into the candidate
+//  pool after those already found. Contours cut off by the edge of a region 
+//  that isn't the whole frame are dropped, and the next frame rescanned...
+void WormTracker::SegmentRegion(cv::Mat const &GrayImage, 
+                                cv::Rect const &Region, bool const bFullFrame)
+{
+    // Variables...
+    cv::Rect const  Frame(0, 0, ImageSize.width, ImageSize.height);
+    cv::Mat         ThresholdRegion = ThresholdImage(Region);
+    cv::Mat         SourceRegion    = GrayImage(Region);
+
+    // Split a tall enough region into tiles and segment each on its own 
+    //  processor...
+    if(!bReferenceMode && unTileRows > 0 && 
+       Region.height > (int) unTileRows)
+    {
+        // Enough tiles to cover it, each with its own inlet correction 
+        //  scratch...
+        unsigned int const unTiles = 
+            (Region.height + unTileRows - 1) / unTileRows;
+        if(TileFilters.size() < unTiles)
+            TileFilters.resize(unTiles);
+
+        // Segment them all...
+        cv::parallel_for_(cv::Range(0, unTiles), 
+            TileSegmenter(GrayImage, Region, unTileRows, bInletDetection,
+                          unMorphologySize, unThreshold, unMaxThresholdValue,
+                          TileFilters, ThresholdImage));
+    }
+
+    // Apply morphological operations to get rid of inlets in worm contours,
+    //  thresholding in the same pass...
+    else if(bInletDetection && !bReferenceMode)
+        InletFilter.OpenAndThreshold(GrayImage, Region, unMorphologySize,
+                                     unThreshold, unMaxThresholdValue,
+                                     ThresholdImage);
+
+    // Or separately with OpenCV, which is the reference for the above...
+    else
+    {
+        // Apply morphological operations to get rid of inlets in worm 
+        //  contours...
+        if(bInletDetection)
+        {
+            // Eroding and then dilating the image is same as the higher order
+            //  operation of opening. Dilating the region reads the eroded 
+            //  pixels just outside it, so erode a kernel's width further out.
+            //  The threshold image is free until later, so use it as scratch
+            //  between the two...
+            cv::Rect const Eroded = 
+                (Region + cv::Size(2 * unMorphologySize, 
+                                   2 * unMorphologySize) - 
+                 cv::Point(unMorphologySize, unMorphologySize)) & Frame;
+            cv::Mat ErodedRegion = ThresholdImage(Eroded);
+            cv::Mat OpenedRegion = MorphologicalImage(Region);
+            
+                // Erode...
+                cv::erode(GrayImage(Eroded), ErodedRegion, MorphologyKernel);
+            
+                // Dilate...
+                cv::dilate(ThresholdImage(Region), OpenedRegion, 
+                           MorphologyKernel);
+
+            // Threshold the opened image instead...
+            SourceRegion = OpenedRegion;
+        }
+
+        // Create threshold...
+        cv::threshold(SourceRegion, ThresholdRegion, unThreshold, 
+                      unMaxThresholdValue, cv::THRESH_BINARY);
+    }
+
+    // Find contours, in frame coordinates. Each is a contiguous run of 
+    //  vertices...
+    cv::findContours(ThresholdRegion, Contours, cv::RETR_LIST, 
+                     cv::CHAIN_APPROX_NONE, Region.tl());
+
+    // Only ever grow the candidate pool so its outlines keep their storage
+    //  between frames...
+    if(Candidates.size() < unCandidatesFound + Contours.size())
+        Candidates.resize(unCandidatesFound + Contours.size());
+
+    // Swap each contour's vertices into a candidate, which caches its 
+    //  bounding rectangle and moments. The candidate's vertex array from the
+    //  last frame goes back to findContours() to be refilled...
+    for(unsigned int unContourIndex = 0; unContourIndex < Contours.size();
+      ++unContourIndex)
+    {
+        // Swap...
+        Outline &Candidate = Candidates[unCandidatesFound];
+        Candidate.Assign(Contours[unContourIndex]);
+
+        // Cut off by the region's edge, other than where that is the frame's.
+        //  This is the background around the region's worms, or something 
+        //  that has outgrown its region. A worm cut off like this goes 
+        //  unmatched, which already has the next frame rescanned...
+        cv::Rect const &Bounds = Candidate.BoundingRectangle();
+        if(!bFullFrame &&
+           ((Bounds.x == Region.x && Region.x > 0) ||
+            (Bounds.y == Region.y && Region.y > 0) ||
+            (Bounds.br().x == Region.br().x && 
+                Region.br().x < ImageSize.width) ||
+            (Bounds.br().y == Region.br().y && 
+                Region.br().y < ImageSize.height)))
+            continue;
+
+        // Keep it...
+      ++unCandidatesFound;
+    }
+}
+
 // Set the field of view diameter...
 void WormTracker::SetFieldOfViewDiameter(float const fDiameter)
 {
@@ -585,6 +1549,122 @@ void WormTracker::SetArtificialIntelligenceMagic(
     unMorphologySize        = _unMorphologySize;
 }
 
+// Pick the threshold and candidate size window automatically for each media
+//  from a sample of its frames, by the given method, before tracking it...
+void WormTracker::SetAutoCalibration(
+    bool const _bAutoCalibration,
+    ThresholdCalibrator::Method const _CalibrationMethod)
+{
+    // Store...
+    bAutoCalibration    = _bAutoCalibration;
+    CalibrationMethod   = _CalibrationMethod;
+
+    // Start sampling afresh with the method...
+    Calibrator.SetMethod(CalibrationMethod);
+}
+
+// Find where to look on each full frame scan from a copy reduced so many times
+//  on each side, then find the contours only there at full resolution...
+void WormTracker::SetCoarseDetection(unsigned int const _unCoarseScale)
+{
+    // Store...
+    unCoarseScale = _unCoarseScale;
+}
+
+// Flatten uneven illumination before thresholding by subtracting a background
+//  learnt from reduced copies of each frame, or zero scale not to...
+void WormTracker::SetBackgroundModel(
+    unsigned int const _unBackgroundScale,
+    unsigned int const _unBackgroundLearning)
+{
+    // Store, and pass on to the model...
+    unBackgroundScale       = _unBackgroundScale;
+    unBackgroundLearning    = _unBackgroundLearning;
+    Background.SetParameters(unBackgroundScale, unBackgroundLearning);
+}
+
+// Use the slower but straightforward reference algorithms, here and in every 
+//  worm, to validate the faster ones against. Affects every tracker...
+void WormTracker::SetReferenceMode(bool const bEnable)
+{
+    // Set ours and the worms'...
+    bReferenceMode = bEnable;
+    Worm::SetReferenceMode(bEnable);
+}
+
+// Search only around the worms already known about, rescanning the whole frame
+//  every so many frames or whenever a worm goes missing. Zero rescans every 
+//  frame...
+void WormTracker::SetRescanInterval(unsigned int const _unRescanInterval)
+{
+    // Store...
+    unRescanInterval = _unRescanInterval;
+}
+
+// Record every worm's measurements from every frame it is matched in from now
+//  on...
+void WormTracker::SetTimeSeriesRecording(bool const bEnable)
+{
+    // Store...
+    bRecordTimeSeries = bEnable;
+}
+
+// Keep no more than so many chunks of every worm's measurements from every
+//  frame in memory, spilling the oldest to a temporary file, or zero to keep
+//  them all in memory...
+void WormTracker::SetTimeSeriesResidentLimit(unsigned int const unResidentLimit)
+{
+    // Store...
+    TimeSeries.SetResidentLimit(unResidentLimit);
+}
+
+// Split the segmentation of each frame into tiles of so many rows, each on its
+//  own processor. The result is the same as without. Zero doesn't tile...
+void WormTracker::SetTiledSegmentation(unsigned int const _unTileRows)
+{
+    // Store...
+    unTileRows = _unTileRows;
+}
+
+// Move a worm into the cell its centre is now in, or bin it for the first time
+//  if it is new. Retired worms are never binned...
+void WormTracker::UpdateCentroidCell(unsigned int const unWormIndex)
+{
+    // Retired, so only note that it is in no cell if it is being binned for 
+    //  the first time, as when every worm is binned again...
+    if(IsRetired(unWormIndex))
+    {
+        if(unWormIndex == WormCentroidCells.size())
+            WormCentroidCells.push_back((unsigned) -1);
+        return;
+    }
+
+    // Cell it is in now...
+    unsigned int const unCell = 
+        GetCentroidCell(TrackingTable.at(unWormIndex)->Centre());
+
+    // New worm, so just bin it...
+    if(unWormIndex == WormCentroidCells.size())
+    {
+        CentroidCells[unCell].push_back(unWormIndex);
+        WormCentroidCells.push_back(unCell);
+        return;
+    }
+
+    // Hasn't left its cell...
+    if(WormCentroidCells.at(unWormIndex) == unCell)
+        return;
+
+    // Take it out of its old cell, which holds only a few worms...
+    vector<unsigned int> &OldCell = 
+        CentroidCells[WormCentroidCells[unWormIndex]];
+    OldCell.erase(std::find(OldCell.begin(), OldCell.end(), unWormIndex));
+
+    // Put it in its new one...
+    CentroidCells[unCell].push_back(unWormIndex);
+    WormCentroidCells[unWormIndex] = unCell;
+}
+
 // Deconstructor...
 WormTracker::~WormTracker()
 {
@@ -596,14 +1676,6 @@ WormTracker::~WormTracker()
         // Deallocate
         delete *Iterator;
     }
-
-    // Cleanup the gray image, if any...
-    if(pGrayImage)
-        cvReleaseImage(&pGrayImage);
-
-    // Cleanup the thinking image, if any...
-    if(pThinkingImage)
-        cvReleaseImage(&pThinkingImage);   
 }
 
 // Output some info on current tracker state......
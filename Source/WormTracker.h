@@ -13,6 +13,18 @@
     // Worm class...
     #include "Worm.h"
 
+    // Opening and thresholding in one pass...
+    #include "MorphologyFilter.h"
+
+    // Flattening uneven illumination...
+    #include "BackgroundModel.h"
+
+    // Picking the threshold and candidate sizes automatically...
+    #include "ThresholdCalibrator.h"
+
+    // Every worm's measurements from every frame...
+    #include "TimeSeriesPool.h"
+
     // OpenCV...
     #include <opencv2/opencv.hpp>
     // 2020/06/10 - deprecated header, using new one
@@ -34,6 +46,32 @@
     // Using the standard namespace...
     using namespace std;
 
+// Time spent in each stage of advancing frames, since the last reset. Finding
+//  the contours includes refining the coarse regions at full resolution...
+typedef struct StageTimings
+{
+    // Inline constructor initializer...
+    StageTimings()
+        : unFrames(0),
+          unCoarseScans(0),
+          dCoarseSeconds(0.0),
+          dSegmentationSeconds(0.0),
+          dTrackingSeconds(0.0)
+    {
+    }
+
+    // Frames advanced, and how many of those were rescanned coarsely...
+    unsigned int    unFrames;
+    unsigned int    unCoarseScans;
+
+    // Seconds spent finding where to look coarsely, finding the contours, 
+    //  and matching them with worms...
+    double          dCoarseSeconds;
+    double          dSegmentationSeconds;
+    double          dTrackingSeconds;
+
+}StageTimings;
+
 // WormTracker class...
 class WormTracker
 {   
@@ -60,26 +98,71 @@ class WormTracker
             // Get the current frame index...
             unsigned int const  GetCurrentFrameIndex() const;
 
-            // Get a copy of the current thinking image. Caller frees...
+            // Get a copy of the current thinking image, drawn now from the
+            //  last frame kept for it, or null if none has been yet. Each
+            //  call asks for the next frame to be kept too. Caller frees...
             IplImage           *GetThinkingImage() const;
             
+            // Get the time spent in each stage of advancing frames since the
+            //  last reset...
+            StageTimings        GetStageTimings() const;
+
+            // Get a worm's measurements from every frame it was matched in
+            //  since the last reset, oldest first, in pixels. False if those
+            //  spilled to disk couldn't be read back...
+            bool                GetTimeSeries(
+                                    unsigned int const unWormIndex,
+                                    vector<WormSample> &Samples) const;
+
             // Get the total number of frames...
             unsigned int const  GetTotalFrames() const;
 
             // Get the nth worm, or null worm if no more...
             Worm const         &GetWorm(unsigned int const unIndex) const;
 
+            // Is the threshold and candidate size window picked 
+            //  automatically for each media?
+            bool                IsAutoCalibrating() const;
+
+            // Is every worm's measurements from every frame being recorded?
+            bool                IsRecordingTimeSeries() const;
+
+            // Has the worm gone unmatched for too long to still be tracked?
+            bool                IsRetired(unsigned int const unWormIndex) const;
+
             // The number of worms we are currently tracking...
             unsigned int        Tracking() const;
 
         // Mutators...
 
+            // Sample a frame, without tracking it, to pick the threshold and 
+            //  candidate size window from. True once the estimate has 
+            //  converged and no more are needed...
+            bool                AddCalibrationFrame(
+                                    cv::Mat const &NewGrayImage);
+
             // Advance frame...
             void                Advance(IplImage const &NewGrayImage);
-	    void Advance(cv::Mat const &NewGrayMat);
+
+            // Advance frame without copying it, numbering it as the next 
+            //  frame tracked...
+            void                Advance(cv::Mat const &NewGrayImage);
+
+            // Same, numbering it by where it was in its video, as any time 
+            //  series records it...
+            void                Advance(cv::Mat const &NewGrayImage,
+                                        unsigned int const unSourceFrame);
+
+            // Use the threshold and candidate size window estimated from the
+            //  frames sampled since the last reset, if any...
+            void                ApplyCalibration();
 
             // Get the number of worms just added since last check...
             unsigned int const  GetWormsAddedSinceLastCheck();
+
+            // Use the same field of view and artificial intelligence magic as
+            //  another tracker...
+            void                ImportSettings(WormTracker const &Source);
             
             // Reset the tracker...
             void                Reset(unsigned int const _unTotalFrames);
@@ -93,9 +176,63 @@ class WormTracker
                 bool const          _bInletDetection,
                 unsigned int        _unMorphologySize);
 
+            // Pick the threshold and candidate size window automatically for
+            //  each media from a sample of its frames, by the given method,
+            //  before tracking it. Off by default...
+            void                SetAutoCalibration(
+                                    bool const _bAutoCalibration,
+                                    ThresholdCalibrator::Method const 
+                                        _CalibrationMethod = 
+                                            ThresholdCalibrator::TRIANGLE);
+
+            // Find where to look on each full frame scan from a copy reduced
+            //  so many times on each side, then find the contours only there
+            //  at full resolution. Zero or one scans the full frame at full 
+            //  resolution, which is the default...
+            void                SetCoarseDetection(
+                                    unsigned int const _unCoarseScale);
+
+            // Flatten uneven illumination before thresholding by subtracting
+            //  a background learnt from copies of each frame reduced so many
+            //  times on each side, or zero not to, which is the default. Each
+            //  frame moves the background one 2^n th of the way towards it...
+            void                SetBackgroundModel(
+                                    unsigned int const _unBackgroundScale,
+                                    unsigned int const _unBackgroundLearning);
+
             // Set the field of view diameter...
             void                SetFieldOfViewDiameter(float const fDiameter);
 
+            // Use the slower but straightforward reference algorithms, here 
+            //  and in every worm, to validate the faster ones against. Affects
+            //  every tracker...
+            static void         SetReferenceMode(bool const bEnable);
+
+            // Search only around the worms already known about, rescanning 
+            //  the whole frame every so many frames or whenever a worm goes 
+            //  missing. Zero rescans every frame, which is the default...
+            void                SetRescanInterval(
+                                    unsigned int const _unRescanInterval);
+
+            // Record every worm's measurements from every frame it is 
+            //  matched in from now on, so they can be had from 
+            //  GetTimeSeries(). Off by default...
+            void                SetTimeSeriesRecording(bool const bEnable);
+
+            // Keep no more than so many chunks of every worm's measurements
+            //  from every frame in memory, spilling the oldest to a temporary
+            //  file, or zero to keep them all in memory. Each chunk holds a
+            //  thousand or so frames of one worm...
+            void                SetTimeSeriesResidentLimit(
+                                    unsigned int const unResidentLimit);
+
+            // Split the segmentation of each frame into tiles of so many rows,
+            //  each on its own processor, for very large frames. The result 
+            //  is the same as without. Zero doesn't tile, which is the 
+            //  default...
+            void                SetTiledSegmentation(
+                                    unsigned int const _unTileRows);
+
         // Operators...
 
             // Output some info on current tracker state......
@@ -105,6 +242,65 @@ class WormTracker
         // Deconstructor...
        ~WormTracker();
 
+    // Protected constants...
+    protected:
+
+        // Side length, in pixels, of the square cells that worm centres are 
+        //  binned into, how many frames in a row a worm can go unmatched 
+        //  before it is retired, and how far in pixels around each worm to 
+        //  look for it between rescans...
+        enum
+        {
+            CENTROID_CELL_SIZE      = 64,
+            MAXIMUM_MISSED_FRAMES   = 15,
+            REGION_PADDING          = 24
+        };
+
+    // Protected types...
+    protected:
+
+        // A worm as it was on the frame kept for the thinking image...
+        typedef struct ThinkingWorm
+        {
+            // Its contour's vertices...
+            vector<cv::Point>   Vertices;
+
+            // Where its head, centre, and tail were...
+            CvPoint             Head;
+            CvPoint             Centre;
+            CvPoint             Tail;
+
+            // Its index in the tracking table and its refreshes by then...
+            unsigned int        unWormIndex;
+            unsigned int        unRefreshes;
+
+        }ThinkingWorm;
+
+        // A candidate that could be a worm, within the gate. Candidates and 
+        //  worms joined by these make up the connected components of the 
+        //  assignment, each of which is solved alone...
+        typedef struct AssignmentEdge
+        {
+            // Indices into the possible candidates and the tracking table...
+            unsigned int    unCandidate;
+            unsigned int    unWorm;
+
+            // Cost of pairing them, and the component they are in...
+            double          dCost;
+            unsigned int    unComponent;
+
+            // Order by component, then candidate, then worm...
+            bool operator<(AssignmentEdge const &Other) const
+            {
+                if(unComponent != Other.unComponent)
+                    return unComponent < Other.unComponent;
+                if(unCandidate != Other.unCandidate)
+                    return unCandidate < Other.unCandidate;
+                return unWorm < Other.unWorm;
+            }
+
+        }AssignmentEdge;
+
     // Protected methods...
     protected:
 
@@ -112,29 +308,88 @@ class WormTracker
             
             // How many underlying rectangles does given one rest upon?
             unsigned int const CountRectanglesIntersected(
-                CvRect const &Rectangle) const;
+                cv::Rect const &Rectangle) const;
+
+            // Find every active worm whose centre is within the given radius
+            //  of a point, looking only in the cells around it...
+            void FindWormsNear(CvPoint const &Point, double const dRadius,
+                               vector<unsigned int> &Worms) const;
 
-            // Find the nearest worm to given...
-            unsigned int FindNearestWorm(CvContour const &WormContour) const;
+            // Find every active worm whose centre is within the given radius 
+            //  of a point by checking every worm. This is the reference for 
+            //  FindWormsNear()... θ(n)
+            void FindWormsNearLinearly(CvPoint const &Point, 
+                                       double const dRadius,
+                                       vector<unsigned int> &Worms) const;
+
+            // Get the cell containing the given point, clamped to the frame...
+            unsigned int GetCentroidCell(CvPoint const &Point) const;
 
             // Do any points on the mystery contour lie on the image exterior?
-            bool IsAnyPointOnImageExterior(CvContour const &MysteryContour)
+            bool IsAnyPointOnImageExterior(Outline const &MysteryContour)
                 const;
 
             // Could this contour be a worm, independent of what we know?
-            bool IsPossibleWorm(CvContour const &MysteryContour) const;
+            bool IsPossibleWorm(Outline const &MysteryContour) const;
 
             // Do the two rectangles have a non-zero intersection area?
-            bool IsRectanglesIntersect(CvRect const &RectangleOne,
-                                       CvRect const &RectangleTwo) const;
+            bool IsRectanglesIntersect(cv::Rect const &RectangleOne,
+                                       cv::Rect const &RectangleTwo) const;
 
         // Mutators...
 
-            // Add new worm to tracker...
-            void Add(CvContour const &WormContour);
+            // Add a text label to a thinking image at a point...
+            static void AddThinkingLabel(cv::Mat &ThinkingImage,
+                                         string const &sLabel, CvPoint Point);
+
+            // Pair this frame's possible worms with the worms being tracked
+            //  for the least total cost, each with at most one. Left over 
+            //  candidates become new worms and left over worms miss a frame...
+            void AssignCandidates(cv::Mat const &GrayImage);
+
+            // Find the root of a node's connected component, flattening the
+            //  path to it along the way...
+            unsigned int FindComponentRoot(unsigned int const unNode);
+
+            // Gather the regions of a full frame scan that could have any 
+            //  contours in them from a reduced copy of the frame, merged 
+            //  wherever they overlap...
+            void GatherCoarseRegions(cv::Mat const &GrayImage);
 
-            // Add a text label to the thinking image at a point...
-            void AddThinkingLabel(string const sLabel, CvPoint Point);
+            // Gather the regions around every worm still being tracked, 
+            //  padded for how far it might have moved and merged wherever 
+            //  they overlap...
+            void GatherRegions();
+
+            // Merge the regions that overlap until none do, so that no 
+            //  contour is found twice...
+            void MergeRegions();
+
+            // Size the centroid cells to the frame and bin every worm again...
+            void RebuildCentroidGrid();
+
+            // Refresh every worm matched this frame with its candidate and 
+            //  breathe life into a new worm from every candidate left over,
+            //  all at once on whichever processors OpenCV gives them, and 
+            //  then bin them all...
+            void RefreshWorms(cv::Mat const &GrayImage);
+
+            // Stop matching a worm, but keep it in the tracking table so its 
+            //  history can still be reported...
+            void RetireWorm(unsigned int const unWormIndex);
+
+            // Add every worm matched this frame to its time series, numbered
+            //  by where it was in its video...
+            void RecordTimeSeries(unsigned int const unSourceFrame);
+
+            // Find the contours in a region of the frame and swap them into 
+            //  the candidate pool after those already found...
+            void SegmentRegion(cv::Mat const &GrayImage, 
+                               cv::Rect const &Region, bool const bFullFrame);
+
+            // Move a worm into the cell its centre is now in, or bin it for 
+            //  the first time if it is new. Retired worms are never binned...
+            void UpdateCentroidCell(unsigned int const unWormIndex);
 
     // Protected attributes...
     protected:
@@ -145,12 +400,120 @@ class WormTracker
         // Thinking image label font...
 	CvFont              ThinkingLabelFont;
 
-        // Current frame's gray image and thinking image...
-        IplImage           *pGrayImage;
-        IplImage           *pThinkingImage;
+        // Current frame's size...
+        CvSize              ImageSize;
+
+        // Whether the thinking image has been asked for since a frame was 
+        //  last kept for it, and the frame kept and every worm on it. Nothing
+        //  is drawn until it is asked for, and nothing is kept unless it has
+        //  been, so a tracker nobody is watching spends nothing on it...
+        mutable bool            bThinkingRequested;
+        cv::Mat                 ThinkingFrame;
+        vector<ThinkingWorm>    ThinkingWorms;
+
+        // Working buffers, allocated on the first frame and reused until the
+        //  frame size changes...
+        cv::Mat             MorphologicalImage;
+        cv::Mat             ThresholdImage;
+
+        // Inlet correction, opening and thresholding in one pass, and the
+        //  kernel for doing the same with OpenCV as a reference, rebuilt only
+        //  when its size changes...
+        MorphologyFilter    InletFilter;
+        cv::Mat             MorphologyKernel;
+
+        // The illumination learnt so far, and the current frame flattened
+        //  against it for thresholding...
+        BackgroundModel     Background;
+        cv::Mat             FlattenedImage;
+
+        // Whether to calibrate each media and how, the estimate from the
+        //  frames sampled so far, and the frame sampled prepared for it...
+        bool                        bAutoCalibration;
+        ThresholdCalibrator::Method CalibrationMethod;
+        ThresholdCalibrator         Calibrator;
+        cv::Mat                     CalibrationImage;
+
+        // Contours found in the current region, and those kept from every 
+        //  region of the current frame. Both are only ever grown, so the 
+        //  vertex arrays are swapped back and forth and reused between frames
+        //  rather than reallocated. Only the first unCandidatesFound 
+        //  candidates are from this frame...
+        vector<vector<cv::Point> >  Contours;
+        vector<Outline>             Candidates;
+        unsigned int                unCandidatesFound;
+
+        // Regions of the current frame to search, frames between rescans of 
+        //  the whole frame or zero for every frame, frames since the last, 
+        //  and whether the next frame must be rescanned anyways...
+        vector<cv::Rect>            Regions;
+        unsigned int                unRescanInterval;
+        unsigned int                unFramesSinceRescan;
+        bool                        bRescanNeeded;
+
+        // Times each side of the frame is reduced to find where to look on 
+        //  full frame scans, or zero or one not to. Then scratch for doing 
+        //  so. The darkest and brightest pixel in each cell, which cells 
+        //  have both sides of the threshold in or near them, and the 
+        //  clusters of those...
+        unsigned int                unCoarseScale;
+        cv::Mat                     CoarseDarkest;
+        cv::Mat                     CoarseBrightest;
+        cv::Mat                     CoarseDark;
+        cv::Mat                     CoarseMarks;
+        cv::Mat                     CoarseLabels;
+        cv::Mat                     CoarseStatistics;
+        cv::Mat                     CoarseCentroids;
+
+        // Time spent in each stage of advancing frames since the last 
+        //  reset...
+        StageTimings                Timings;
+
+        // Rows in each tile of a region segmented in parallel, or zero for 
+        //  none, and each tile's own inlet correction...
+        unsigned int                unTileRows;
+        vector<MorphologyFilter>    TileFilters;
         
-        // Table of worms being tracked...
-        vector<Worm *>      TrackingTable;
+        // Table of worms being tracked, and how many frames in a row each 
+        //  has gone unmatched...
+        vector<Worm *>          TrackingTable;
+        vector<unsigned int>    WormMissedFrames;
+
+        // Whether to record every worm's measurements from every frame it
+        //  was matched in, and those recorded, each worm's series at its 
+        //  index in the tracking table...
+        bool                    bRecordTimeSeries;
+        TimeSeriesPool          TimeSeries;
+
+        // Indices of the worms whose centres are in each cell, row major, the
+        //  number of cells across and down, and the cell each worm is in...
+        vector<vector<unsigned int> >   CentroidCells;
+        int                             nCentroidColumns;
+        int                             nCentroidRows;
+        vector<unsigned int>            WormCentroidCells;
+
+        // Assignment scratch, only ever grown and so reused between frames.
+        //  These are the candidates that could be worms, their lengths, the 
+        //  gated pairings, each node's parent in its component with 
+        //  candidates first and then worms, and whether each was matched.
+        //  Then for the component being solved, each node's row or column in
+        //  its cost matrix, the candidates and worms those are, the matrix,
+        //  and its solution...
+        vector<unsigned int>            PossibleCandidates;
+        vector<double>                  CandidateLengths;
+        vector<unsigned int>            NearbyWorms;
+        vector<AssignmentEdge>          AssignmentEdges;
+        vector<unsigned int>            ComponentParents;
+        vector<bool>                    NodesMatched;
+        vector<unsigned int>            ComponentSlots;
+        vector<unsigned int>            ComponentCandidates;
+        vector<unsigned int>            ComponentWorms;
+        vector<double>                  ComponentCosts;
+        vector<int>                     ComponentAssignments;
+
+        // Each worm to refresh this frame, or to add past the end of the 
+        //  tracking table, and the index of the candidate to do so with...
+        vector<pair<unsigned int, unsigned int> >   WormRefreshes;
         
         // Worms just added in this frame...
         unsigned int        unWormsJustAdded;
@@ -169,6 +532,11 @@ class WormTracker
         unsigned int        unMaximumCandidateSize;
         bool                bInletDetection;
         unsigned int        unMorphologySize;
+        unsigned int        unBackgroundScale;
+        unsigned int        unBackgroundLearning;
+
+        // Use the reference algorithms...
+        static bool         bReferenceMode;
 };
 
 #endif
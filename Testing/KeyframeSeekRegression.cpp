@@ -0,0 +1,123 @@
+/*
+  Name:         KeyframeSeekRegression.cpp
+  Author:       Kip Warner (Kip@TheVertigo.com)
+  Description:  Checks that seeking to each keyframe found from a video's
+                packets decodes the very frame shown there, by comparing it
+                with the same frame decoded in turn from the start. The video
+                must have B-frames, so that its packets come in a different
+                order than its frames are shown in...
+  Quick Debug:  ffmpeg -f lavfi -i testsrc=duration=10:size=320x240:rate=25 -c:v libx264 -bf 3 -g 25 -pix_fmt yuv420p BFrames.mp4 && g++ -I../Source `pkg-config --cflags opencv4` `wx-config --cflags` KeyframeSeekRegression.cpp ../Source/MediaAnalyzer.cpp ../Source/FrameQueue.cpp ../Source/WormTracker.cpp ../Source/Worm.cpp ../Source/Outline.cpp ../Source/EdgeGrid.cpp ../Source/MorphologyFilter.cpp ../Source/BackgroundModel.cpp ../Source/ThresholdCalibrator.cpp ../Source/SlitherMath.cpp ../Source/TimeSeriesPool.cpp -g3 -o KeyframeSeekRegression -Wall -Werror `pkg-config --libs opencv4` `wx-config --libs` && ./KeyframeSeekRegression BFrames.mp4
+*/
+
+// Includes...
+#include "../Source/MediaAnalyzer.h"
+#include <opencv2/opencv.hpp>
+#include <iostream>
+#include <cstdlib>
+
+// Using the standard namespace...
+using namespace std;
+
+// Entry point...
+int main(int nArguments, char *ppszArguments[])
+{
+    // Variables...
+    WormTracker             Tracker;
+    MediaAnalyzer           Analyzer(Tracker);
+    vector<unsigned int>    Keyframes;
+    unsigned int            unFrames        = 0;
+    vector<cv::Mat>         Frames;
+    cv::Mat                 Frame;
+    unsigned int            unReordered     = 0;
+    bool                    bAllPassed      = true;
+
+    // Print usage...
+    if(nArguments != 2)
+    {
+        cout << "Usage: KeyframeSeekRegression [video]" << endl;
+        return EXIT_FAILURE;
+    }
+
+    // Find the keyframes...
+    cout << "Finding keyframes..." << endl;
+    if(!Analyzer.FindKeyframes(ppszArguments[1], Keyframes, unFrames))
+    {
+        cout << "\t" << Analyzer.GetLastError() << endl;
+        return EXIT_FAILURE;
+    }
+    cout << "\t" << Keyframes.size() << " of " << unFrames << " frames"
+         << endl;
+
+    // Decode every frame in turn...
+    cout << "Decoding every frame..." << endl;
+    cv::VideoCapture Capture(ppszArguments[1]);
+    while(Capture.read(Frame))
+        Frames.push_back(Frame.clone());
+    cout << "\t" << Frames.size() << " frames" << endl;
+    if(Frames.size() != unFrames || Keyframes.empty())
+    {
+        cout << "\t...FAILED" << endl;
+        return EXIT_FAILURE;
+    }
+
+    // Count the keyframes whose packets came in a different place than they
+    //  are shown in, or the check would pass even counting packets...
+    cv::VideoCapture Packets;
+    vector<int> const Parameters = { cv::CAP_PROP_FORMAT, -1 };
+    if(Packets.open(ppszArguments[1], cv::CAP_FFMPEG, Parameters))
+    {
+        unsigned int unPacket   = 0;
+        unsigned int unKeyframe = 0;
+        while(Packets.read(Frame))
+        {
+            if(Packets.get(cv::CAP_PROP_LRF_HAS_KEY_FRAME) != 0.0 &&
+               unKeyframe < Keyframes.size() &&
+               Keyframes[unKeyframe++] != unPacket)
+              ++unReordered;
+          ++unPacket;
+        }
+    }
+    cout << "\t" << unReordered << " keyframes shown out of packet order"
+         << endl;
+    if(unReordered == 0)
+    {
+        cout << "\tThe video has no B-frames before its keyframes" << endl;
+        return EXIT_FAILURE;
+    }
+
+    // Seek straight to each keyframe and compare it with the frame shown
+    //  there...
+    cout << "Seeking to each keyframe..." << endl;
+    for(unsigned int unKeyframe = 0; unKeyframe < Keyframes.size();
+      ++unKeyframe)
+    {
+        // Where it should be shown...
+        unsigned int const unFrame = Keyframes[unKeyframe];
+
+        // Seek and decode it...
+        if(unFrame >= Frames.size() ||
+           !Capture.set(cv::CAP_PROP_POS_FRAMES, unFrame) ||
+           !Capture.read(Frame))
+        {
+            cout << "\tKeyframe at frame " << unFrame << " couldn't be read"
+                 << endl;
+            bAllPassed = false;
+            continue;
+        }
+
+        // The same frame...
+        if(Frame.size() != Frames[unFrame].size() ||
+           cv::norm(Frame, Frames[unFrame], cv::NORM_INF) != 0.0)
+        {
+            cout << "\tKeyframe at frame " << unFrame << " differs" << endl;
+            bAllPassed = false;
+        }
+    }
+
+    // Report...
+    cout << (bAllPassed ? "Keyframes are seeked to exactly."
+                        : "Keyframes are MISPLACED.") << endl;
+
+    // Done...
+    return bAllPassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,227 @@
+/*
+  Name:         MidlineAccuracy.cpp
+  Author:       Kip Warner (Kip@TheVertigo.com)
+  Description:  Checks the midline traced through synthetic worms of known
+                length and curvature, and that a worm whose ends can't be
+                found has no midline measured at all...
+  Quick Debug:  g++ -I../Source `pkg-config --cflags opencv4` MidlineAccuracy.cpp ../Source/Worm.cpp ../Source/Outline.cpp ../Source/EdgeGrid.cpp ../Source/SlitherMath.cpp -g3 -o MidlineAccuracy -Wall -Werror `pkg-config --libs opencv4` && ./MidlineAccuracy
+*/
+
+// Includes...
+#include "SyntheticWorm.h"
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+
+// Using the standard namespace...
+using namespace std;
+
+// Does the midline come out as long as it should and turn as much as it
+//  should everywhere along it, but near the ends where the caps round it off?
+static bool IsMidlineAccurate(Worm const &TestWorm, double const dLength,
+                              double const dCurvature)
+{
+    // Constants. The midline's points are only averaged from pixels, so
+    //  each turns a little more or less than it should, but not on average...
+    double const        dLengthTolerance        = 0.03;
+    double const        dCurvatureTolerance     = 0.015;
+    double const        dMeanCurvatureTolerance = 0.002;
+    unsigned int const  unEndPoints             = 3;
+
+    // Variables...
+    double              dMeanCurvature          = 0.0;
+    unsigned int        unPoints                = 0;
+
+    // Traced at all...
+    if(TestWorm.Midline().X.size() != Worm::MIDLINE_POINTS)
+    {
+        cout << "\tNo midline was traced" << endl;
+        return false;
+    }
+
+    // Long enough...
+    cout << "\tLength " << TestWorm.FrameLength() << " (expected " << dLength
+         << ")" << endl;
+    if(fabs(TestWorm.FrameLength() - dLength) > dLengthTolerance * dLength)
+        return false;
+
+    // Turns as much as it should at each point away from the ends. Which end
+    //  is the head decides which way it turns, so only how much is checked...
+    vector<float> const &Curvature = TestWorm.Curvature();
+    for(unsigned int unPoint = unEndPoints;
+        unPoint < Curvature.size() - unEndPoints;
+      ++unPoint)
+    {
+        // Off by too much...
+        if(fabs(fabs(Curvature[unPoint]) - dCurvature) > dCurvatureTolerance)
+        {
+            cout << "\tCurvature " << Curvature[unPoint] << " at point "
+                 << unPoint + 1 << " (expected " << dCurvature << ")" << endl;
+            return false;
+        }
+
+        // Add it to the mean...
+        dMeanCurvature += fabs(Curvature[unPoint]);
+      ++unPoints;
+    }
+    dMeanCurvature /= unPoints;
+
+    // And on average...
+    cout << "\tMean curvature " << dMeanCurvature << " (expected "
+         << dCurvature << ")" << endl;
+    return (fabs(dMeanCurvature - dCurvature) <= dMeanCurvatureTolerance);
+}
+
+// Entry point...
+int main()
+{
+    // Constants...
+    double const    dHalfWidth  = 8.0;
+    double const    dRadius     = 80.0;
+
+    // Variables...
+    bool            bAllPassed  = true;
+
+    // A straight worm, a capsule 200 pixels between the centres of its caps.
+    //  Its midline runs from the tip of one cap to the tip of the other...
+    {
+        // Alert user...
+        cout << "Straight..." << endl;
+
+        // Outline it, clockwise as seen on screen from the middle of one
+        //  side...
+        vector<cv::Point> Points;
+        AddLine(Points, cv::Point2d(200.0, 200.0 - dHalfWidth),
+                cv::Point2d(300.0, 200.0 - dHalfWidth));
+        AddArc(Points, cv::Point2d(300.0, 200.0), dHalfWidth,
+               -CV_PI / 2.0, CV_PI / 2.0);
+        AddLine(Points, cv::Point2d(300.0, 200.0 + dHalfWidth),
+                cv::Point2d(100.0, 200.0 + dHalfWidth));
+        AddArc(Points, cv::Point2d(100.0, 200.0), dHalfWidth,
+               CV_PI / 2.0, 3.0 * CV_PI / 2.0);
+        AddLine(Points, cv::Point2d(100.0, 200.0 - dHalfWidth),
+                cv::Point2d(200.0, 200.0 - dHalfWidth));
+
+        // Check it...
+        Worm TestWorm;
+        RefreshFrom(TestWorm, Points);
+        if(!IsMidlineAccurate(TestWorm, 200.0 + 2.0 * dHalfWidth, 0.0))
+        {
+            cout << "\t...FAILED" << endl;
+            bAllPassed = false;
+        }
+    }
+
+    // A worm curled around half a circle, with the same caps. Its midline
+    //  follows the circle and then runs out to each tip, turning by one over
+    //  the radius all the way along...
+    {
+        // Alert user...
+        cout << "Half a circle..." << endl;
+
+        // Outline it, from the middle of the outside of the circle around
+        //  and back around the inside. The ends are searched for from the
+        //  first vertex, which mustn't be right where a cap begins...
+        vector<cv::Point> Points;
+        AddArc(Points, cv::Point2d(200.0, 250.0), dRadius + dHalfWidth,
+               3.0 * CV_PI / 2.0, 2.0 * CV_PI);
+        AddArc(Points, cv::Point2d(200.0 + dRadius, 250.0), dHalfWidth,
+               0.0, CV_PI);
+        AddArc(Points, cv::Point2d(200.0, 250.0), dRadius - dHalfWidth,
+               2.0 * CV_PI, CV_PI);
+        AddArc(Points, cv::Point2d(200.0 - dRadius, 250.0), dHalfWidth,
+               0.0, CV_PI);
+        AddArc(Points, cv::Point2d(200.0, 250.0), dRadius + dHalfWidth,
+               CV_PI, 3.0 * CV_PI / 2.0);
+
+        // Check it...
+        Worm TestWorm;
+        RefreshFrom(TestWorm, Points);
+        if(!IsMidlineAccurate(TestWorm, CV_PI * dRadius + 2.0 * dHalfWidth,
+                              1.0 / dRadius))
+        {
+            cout << "\t...FAILED" << endl;
+            bAllPassed = false;
+        }
+    }
+
+    // A worm only a pixel wide, which no probe can be aimed into, so neither
+    //  end can be found. Whatever the searches answer isn't an end, so the
+    //  only length measured must be half the perimeter...
+    {
+        // Alert user...
+        cout << "Ends not found..." << endl;
+
+        // Outline it, out along the line and back...
+        vector<cv::Point> Points;
+        AddLine(Points, cv::Point2d(100.0, 200.0), cv::Point2d(300.0, 200.0));
+        AddLine(Points, cv::Point2d(300.0, 200.0), cv::Point2d(100.0, 200.0));
+
+        // Check it...
+        Worm TestWorm;
+        RefreshFrom(TestWorm, Points);
+        cout << "\tLength " << TestWorm.FrameLength() << " (expected "
+             << TestWorm.Contour().Perimeter() / 2.0 << ")" << endl;
+        if(!TestWorm.Midline().X.empty() ||
+           TestWorm.FrameLength() != TestWorm.Contour().Perimeter() / 2.0 ||
+           TestWorm.LengthRefreshes() != 0 ||
+           TestWorm.Length() != TestWorm.HalfPerimeter())
+        {
+            cout << "\t...FAILED" << endl;
+            bAllPassed = false;
+        }
+    }
+
+    // A straight worm, then one whose ends can't be found. The length is 
+    //  averaged only along the midline traced in the first, while half the
+    //  perimeter is averaged over both...
+    {
+        // Alert user...
+        cout << "Length kept along the midline..." << endl;
+
+        // Outline the straight worm as before, and the one a pixel wide...
+        vector<cv::Point> Straight;
+        AddLine(Straight, cv::Point2d(200.0, 200.0 - dHalfWidth),
+                cv::Point2d(300.0, 200.0 - dHalfWidth));
+        AddArc(Straight, cv::Point2d(300.0, 200.0), dHalfWidth,
+               -CV_PI / 2.0, CV_PI / 2.0);
+        AddLine(Straight, cv::Point2d(300.0, 200.0 + dHalfWidth),
+                cv::Point2d(100.0, 200.0 + dHalfWidth));
+        AddArc(Straight, cv::Point2d(100.0, 200.0), dHalfWidth,
+               CV_PI / 2.0, 3.0 * CV_PI / 2.0);
+        AddLine(Straight, cv::Point2d(100.0, 200.0 - dHalfWidth),
+                cv::Point2d(200.0, 200.0 - dHalfWidth));
+        vector<cv::Point> Thin;
+        AddLine(Thin, cv::Point2d(100.0, 200.0), cv::Point2d(300.0, 200.0));
+        AddLine(Thin, cv::Point2d(300.0, 200.0), cv::Point2d(100.0, 200.0));
+
+        // Refresh from each in turn...
+        Worm TestWorm;
+        RefreshFrom(TestWorm, Straight);
+        double const dMidlineLength     = TestWorm.FrameLength();
+        double const dHalfPerimeter     = TestWorm.Contour().Perimeter() / 2.0;
+        RefreshFrom(TestWorm, Thin);
+        double const dMeanHalfPerimeter =
+            (dHalfPerimeter + TestWorm.Contour().Perimeter() / 2.0) / 2.0;
+
+        // Check it...
+        cout << "\tLength " << TestWorm.Length() << " (expected "
+             << dMidlineLength << "), half perimeter "
+             << TestWorm.HalfPerimeter() << " (expected "
+             << dMeanHalfPerimeter << ")" << endl;
+        if(TestWorm.Refreshes() != 2 || TestWorm.LengthRefreshes() != 1 ||
+           TestWorm.Length() != dMidlineLength ||
+           fabs(TestWorm.HalfPerimeter() - dMeanHalfPerimeter) > 1e-9)
+        {
+            cout << "\t...FAILED" << endl;
+            bAllPassed = false;
+        }
+    }
+
+    // Report...
+    cout << (bAllPassed ? "Midlines are accurate."
+                        : "Midlines are INACCURATE.") << endl;
+
+    // Done...
+    return bAllPassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,273 @@
+/*
+  Name:         PostureAccuracy.cpp
+  Author:       Kip Warner (Kip@TheVertigo.com)
+  Description:  Checks the posture described for synthetic worms of known
+                shape, that a straight worm's tangent angles are all zero
+                away from its ends and that a worm curled around half a circle
+                has the tangent angles and projections onto a known basis it
+                should...
+  Quick Debug:  g++ -I../Source `pkg-config --cflags opencv4` PostureAccuracy.cpp ../Source/Worm.cpp ../Source/Outline.cpp ../Source/EdgeGrid.cpp ../Source/SlitherMath.cpp -g3 -o PostureAccuracy -Wall -Werror `pkg-config --libs opencv4` && ./PostureAccuracy
+*/
+
+// Includes...
+#include "SyntheticWorm.h"
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+
+// Using the standard namespace...
+using namespace std;
+
+// The tangent angles of the worm's posture, in radians...
+static vector<double> GetAngles(Worm const &TestWorm)
+{
+    // Convert each from steps...
+    vector<double> Angles(Worm::POSTURE_ANGLES);
+    for(unsigned int unAngle = 0; unAngle < Worm::POSTURE_ANGLES; ++unAngle)
+        Angles[unAngle] = (double) TestWorm.Posture().TangentAngles[unAngle] /
+                          Worm::POSTURE_ANGLE_STEPS;
+
+    // Done...
+    return Angles;
+}
+
+// The tangent angles a worm curled around half a circle of the given radius
+//  should have, from the tip of one cap to the tip of the other. Its midline
+//  runs straight out of each cap onto the circle and around it, so is cut
+//  into even segments along that, each of which points along its chord...
+static vector<double> GetHalfCircleAngles(cv::Point2d const &Centre,
+                                          double const dRadius,
+                                          double const dHalfWidth)
+{
+    // Variables...
+    vector<cv::Point2d>     Points(Worm::MIDLINE_POINTS);
+    vector<double>          Angles(Worm::POSTURE_ANGLES);
+    double const            dLength = CV_PI * dRadius + 2.0 * dHalfWidth;
+    double                  dMean   = 0.0;
+
+    // Each point along it, up out of one cap, around, and down into the
+    //  other...
+    for(unsigned int unPoint = 0; unPoint < Worm::MIDLINE_POINTS; ++unPoint)
+    {
+        double const dAlong = dLength * unPoint / (Worm::MIDLINE_POINTS - 1);
+        if(dAlong < dHalfWidth)
+            Points[unPoint] = cv::Point2d(Centre.x - dRadius,
+                                          Centre.y + dHalfWidth - dAlong);
+        else if(dAlong > dLength - dHalfWidth)
+            Points[unPoint] = cv::Point2d(Centre.x + dRadius,
+                                          Centre.y + dAlong - dLength +
+                                          dHalfWidth);
+        else
+        {
+            double const dAngle = CV_PI + (dAlong - dHalfWidth) / dRadius;
+            Points[unPoint] = cv::Point2d(Centre.x + dRadius * cos(dAngle),
+                                          Centre.y + dRadius * sin(dAngle));
+        }
+    }
+
+    // The angle of each segment, which never turns as much as half a turn
+    //  from the one before, and their mean...
+    for(unsigned int unAngle = 0; unAngle < Worm::POSTURE_ANGLES; ++unAngle)
+    {
+        Angles[unAngle] = atan2(Points[unAngle + 1].y - Points[unAngle].y,
+                                Points[unAngle + 1].x - Points[unAngle].x);
+        if(unAngle > 0 && Angles[unAngle] - Angles[unAngle - 1] < -CV_PI)
+            Angles[unAngle] += 2.0 * CV_PI;
+        dMean += Angles[unAngle];
+    }
+    dMean /= Worm::POSTURE_ANGLES;
+
+    // Less the mean...
+    for(unsigned int unAngle = 0; unAngle < Worm::POSTURE_ANGLES; ++unAngle)
+        Angles[unAngle] -= dMean;
+
+    // Done...
+    return Angles;
+}
+
+// The furthest apart two sets of tangent angles are, away from the ends. The
+//  ends are found on the outline a pixel or two to the side of the tips of the
+//  caps, so the segments nearest them point a little off...
+static double GetLargestDifference(vector<double> const &First,
+                                   vector<double> const &Second)
+{
+    // Constants...
+    unsigned int const  unEndAngles = 2;
+
+    // Variables...
+    double              dLargest    = 0.0;
+
+    // Check each...
+    for(unsigned int unAngle = unEndAngles;
+        unAngle < First.size() - unEndAngles;
+      ++unAngle)
+        dLargest = max(dLargest, fabs(First[unAngle] - Second[unAngle]));
+
+    // Done...
+    return dLargest;
+}
+
+// The length of a set of tangent angles taken as a vector...
+static double GetNorm(vector<double> const &Angles)
+{
+    // Variables...
+    double dSquares = 0.0;
+
+    // Add up each squared...
+    for(unsigned int unAngle = 0; unAngle < Angles.size(); ++unAngle)
+        dSquares += Angles[unAngle] * Angles[unAngle];
+
+    // Done...
+    return sqrt(dSquares);
+}
+
+// Entry point...
+int main()
+{
+    // Constants. The midline's points are only averaged from pixels, so each
+    //  segment points a little off from where it should. The segments at the
+    //  ends, pointing further off, go into the projections too...
+    double const        dHalfWidth              = 8.0;
+    double const        dRadius                 = 80.0;
+    cv::Point2d const   Centre(200.0, 250.0);
+    double const        dAngleTolerance         = 0.06;
+    double const        dProjectionTolerance    = 0.05;
+
+    // Variables...
+    bool                bAllPassed              = true;
+
+    // The half circle's tangent angles, for a basis whose first mode is the
+    //  half circle itself, whose second is the same everywhere, and whose
+    //  third bends the same way at both ends. Each is of unit length, and the
+    //  half circle is as far along the first as it is long, but lies along
+    //  neither of the others since its angles have no mean and bend opposite
+    //  ways at either end...
+    vector<double> const HalfCircleAngles =
+        GetHalfCircleAngles(Centre, dRadius, dHalfWidth);
+    double const dHalfCircleNorm = GetNorm(HalfCircleAngles);
+    vector<float> Basis(3 * Worm::POSTURE_ANGLES);
+    for(unsigned int unAngle = 0; unAngle < Worm::POSTURE_ANGLES; ++unAngle)
+    {
+        double const dAlong =
+            (unAngle + 0.5) / Worm::POSTURE_ANGLES - 0.5;
+        Basis[unAngle] = (float) (HalfCircleAngles[unAngle] / dHalfCircleNorm);
+        Basis[Worm::POSTURE_ANGLES + unAngle] =
+            (float) (1.0 / sqrt((double) Worm::POSTURE_ANGLES));
+        Basis[2 * Worm::POSTURE_ANGLES + unAngle] =
+            (float) (cos(2.0 * CV_PI * dAlong) * 0.25);
+    }
+    if(!Worm::SetPostureBasis(Basis))
+    {
+        cout << "Posture basis rejected" << endl;
+        return EXIT_FAILURE;
+    }
+
+    // A straight worm, a capsule 200 pixels between the centres of its caps,
+    //  turns nowhere, so every tangent angle is the same as their mean...
+    {
+        // Alert user...
+        cout << "Straight..." << endl;
+
+        // Outline it, clockwise as seen on screen from the middle of one
+        //  side...
+        vector<cv::Point> Points;
+        AddLine(Points, cv::Point2d(200.0, 200.0 - dHalfWidth),
+                cv::Point2d(300.0, 200.0 - dHalfWidth));
+        AddArc(Points, cv::Point2d(300.0, 200.0), dHalfWidth,
+               -CV_PI / 2.0, CV_PI / 2.0);
+        AddLine(Points, cv::Point2d(300.0, 200.0 + dHalfWidth),
+                cv::Point2d(100.0, 200.0 + dHalfWidth));
+        AddArc(Points, cv::Point2d(100.0, 200.0), dHalfWidth,
+               CV_PI / 2.0, 3.0 * CV_PI / 2.0);
+        AddLine(Points, cv::Point2d(100.0, 200.0 - dHalfWidth),
+                cv::Point2d(200.0, 200.0 - dHalfWidth));
+
+        // Describe it...
+        Worm TestWorm;
+        RefreshFrom(TestWorm, Points);
+        vector<double> const Angles = GetAngles(TestWorm);
+        double const dDifference =
+            GetLargestDifference(Angles, vector<double>(Angles.size(), 0.0));
+
+        // Check it...
+        cout << "\tLargest tangent angle " << dDifference << " (expected 0)"
+             << endl;
+        if(!TestWorm.Posture().bValid || dDifference > dAngleTolerance)
+        {
+            cout << "\t...FAILED" << endl;
+            bAllPassed = false;
+        }
+    }
+
+    // A worm curled around half a circle, with the same caps...
+    {
+        // Alert user...
+        cout << "Half a circle..." << endl;
+
+        // Outline it, from the middle of the outside of the circle around
+        //  and back around the inside. The ends are searched for from the
+        //  first vertex, which mustn't be right where a cap begins...
+        vector<cv::Point> Points;
+        AddArc(Points, Centre, dRadius + dHalfWidth,
+               3.0 * CV_PI / 2.0, 2.0 * CV_PI);
+        AddArc(Points, cv::Point2d(Centre.x + dRadius, Centre.y), dHalfWidth,
+               0.0, CV_PI);
+        AddArc(Points, Centre, dRadius - dHalfWidth, 2.0 * CV_PI, CV_PI);
+        AddArc(Points, cv::Point2d(Centre.x - dRadius, Centre.y), dHalfWidth,
+               0.0, CV_PI);
+        AddArc(Points, Centre, dRadius + dHalfWidth,
+               CV_PI, 3.0 * CV_PI / 2.0);
+
+        // Describe it...
+        Worm TestWorm;
+        RefreshFrom(TestWorm, Points);
+        Worm::PostureDescriptor const &Posture = TestWorm.Posture();
+        vector<double> const Angles = GetAngles(TestWorm);
+
+        // Whichever end was taken for the head, it was described from. From
+        //  the other, the half circle's angles come in reverse and are
+        //  opposite, so it lies the other way along the first mode...
+        vector<double> const Reversed(Angles.rbegin(), Angles.rend());
+        double const dForwards  =
+            GetLargestDifference(Angles, HalfCircleAngles);
+        double const dBackwards =
+            GetLargestDifference(Reversed, HalfCircleAngles);
+        double const dSign      = (dForwards <= dBackwards) ? 1.0 : -1.0;
+        double const dDifference = min(dForwards, dBackwards);
+
+        // Check its angles...
+        cout << "\tLargest tangent angle difference " << dDifference
+             << " (expected 0)" << endl;
+        if(!Posture.bValid || dDifference > dAngleTolerance)
+        {
+            cout << "\t...FAILED" << endl;
+            bAllPassed = false;
+        }
+
+        // And how far they go along each mode...
+        double const Expected[] = { dSign * dHalfCircleNorm, 0.0, 0.0 };
+        for(unsigned int unMode = 0; unMode < 3; ++unMode)
+        {
+            // Alert user...
+            cout << "\tMode " << unMode + 1 << " projection "
+                 << Posture.Projections[unMode] << " (expected "
+                 << Expected[unMode] << ")" << endl;
+
+            // Too far off, relative to how long the angles are...
+            if(Posture.unModes != 3 ||
+               fabs(Posture.Projections[unMode] - Expected[unMode]) >
+                    dProjectionTolerance * dHalfCircleNorm)
+            {
+                cout << "\t...FAILED" << endl;
+                bAllPassed = false;
+            }
+        }
+    }
+
+    // Report...
+    cout << (bAllPassed ? "Postures are accurate."
+                        : "Postures are INACCURATE.") << endl;
+
+    // Done...
+    return bAllPassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
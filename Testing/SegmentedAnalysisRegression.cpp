@@ -0,0 +1,182 @@
+/*
+  Name:         SegmentedAnalysisRegression.cpp
+  Author:       Kip Warner (Kip@TheVertigo.com)
+  Description:  Checks that analyzing a video split into segments of time
+                measures the same worms as analyzing it whole, with the same
+                frames in their time series. The video must be long enough
+                to give each segment 120 frames, and sparse enough that each
+                worm is tracked across every boundary...
+  Quick Debug:  g++ -I../Source `pkg-config --cflags opencv4` `wx-config --cflags` SegmentedAnalysisRegression.cpp ../Source/MediaAnalyzer.cpp ../Source/FrameQueue.cpp ../Source/WormTracker.cpp ../Source/Worm.cpp ../Source/Outline.cpp ../Source/EdgeGrid.cpp ../Source/MorphologyFilter.cpp ../Source/BackgroundModel.cpp ../Source/ThresholdCalibrator.cpp ../Source/SlitherMath.cpp ../Source/TimeSeriesPool.cpp -g3 -o SegmentedAnalysisRegression -Wall -Werror `pkg-config --libs opencv4` `wx-config --libs` && ./SegmentedAnalysisRegression Worms.avi
+*/
+
+// Includes...
+#include "../Source/MediaAnalyzer.h"
+#include <wx/init.h>
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+
+// Using the standard namespace...
+using namespace std;
+
+// Analyze the video split into so many segments, or whole if zero, and
+//  collect its measurements and time series. False if it couldn't be...
+static bool Measure(char const *pszPath, unsigned int const unSegments,
+                    vector<WormMeasurement> &Measurements,
+                    vector<vector<WormSample> > &TimeSeries)
+{
+    // A tracker of its own, configured just like the user interface...
+    WormTracker Tracker;
+    Tracker.SetFieldOfViewDiameter(5.0f);
+    Tracker.SetTimeSeriesRecording(true);
+
+    // Analyze...
+    MediaAnalyzer Analyzer(Tracker);
+    Analyzer.SetSegments(unSegments);
+    if(!Analyzer.Analyze(pszPath))
+    {
+        cout << "\t" << Analyzer.GetLastError() << endl;
+        return false;
+    }
+
+    // Collect...
+    Analyzer.GetMeasurements(Measurements);
+    if(!Analyzer.GetTimeSeries(TimeSeries))
+    {
+        cout << "\tTime series couldn't be read back" << endl;
+        return false;
+    }
+    return true;
+}
+
+// Are the two sets of measurements of the same worms, seen in the same
+//  frames of the video? Every frame's length is measured the same either way,
+//  so the averages may only differ by how the sums were rounded...
+static bool IsSameMeasurements(
+    vector<WormMeasurement> const &Whole,
+    vector<vector<WormSample> > const &WholeTimeSeries,
+    vector<WormMeasurement> const &Segmented,
+    vector<vector<WormSample> > const &SegmentedTimeSeries)
+{
+    // Constants...
+    double const dLengthTolerance = 1e-9;
+
+    // Same number...
+    if(Whole.size() != Segmented.size())
+    {
+        cout << "\tMeasured " << Whole.size() << " worms whole, but "
+             << Segmented.size() << " segmented" << endl;
+        return false;
+    }
+
+    // Each the same...
+    for(unsigned int unWormIndex = 0; unWormIndex < Whole.size();
+      ++unWormIndex)
+    {
+        // Measurements to compare...
+        WormMeasurement const &First    = Whole[unWormIndex];
+        WormMeasurement const &Second   = Segmented[unWormIndex];
+
+        // Alert user...
+        cout << "\tWorm " << unWormIndex + 1 << ": length " << First.dLength
+             << " / " << Second.dLength << " mm, " << First.unRefreshes
+             << " / " << Second.unRefreshes << " refreshes" << endl;
+
+        // Seen in as many frames, as long on average, and no wider or larger
+        //  at most...
+        if(First.unRefreshes != Second.unRefreshes ||
+           First.unLengthRefreshes != Second.unLengthRefreshes ||
+           fabs(First.dLength - Second.dLength) >
+                dLengthTolerance * First.dLength ||
+           fabs(First.dHalfPerimeter - Second.dHalfPerimeter) >
+                dLengthTolerance * First.dHalfPerimeter ||
+           First.dWidth != Second.dWidth ||
+           First.dArea != Second.dArea)
+        {
+            cout << "\tWorm " << unWormIndex + 1 << " differs" << endl;
+            return false;
+        }
+
+        // Seen in the same frames...
+        vector<WormSample> const &FirstSeries   = WholeTimeSeries[unWormIndex];
+        vector<WormSample> const &SecondSeries  =
+            SegmentedTimeSeries[unWormIndex];
+        bool bSameFrames = (FirstSeries.size() == SecondSeries.size());
+        for(unsigned int unSample = 0;
+            bSameFrames && unSample < FirstSeries.size();
+          ++unSample)
+            bSameFrames = (FirstSeries[unSample].unFrame ==
+                           SecondSeries[unSample].unFrame);
+        if(!bSameFrames)
+        {
+            cout << "\tWorm " << unWormIndex + 1
+                 << " was seen in different frames" << endl;
+            return false;
+        }
+    }
+
+    // Identical...
+    return true;
+}
+
+// Entry point...
+int main(int nArguments, char *ppszArguments[])
+{
+    // Constants...
+
+        // Segments to split into...
+        unsigned int const  Segments[]  = { 2, 3 };
+        unsigned int const  unSegmentCounts =
+            sizeof(Segments) / sizeof(Segments[0]);
+
+    // Variables...
+    vector<WormMeasurement>     Whole;
+    vector<vector<WormSample> > WholeTimeSeries;
+    vector<WormMeasurement>     Segmented;
+    vector<vector<WormSample> > SegmentedTimeSeries;
+    bool                        bAllPassed  = true;
+
+    // Print usage...
+    if(nArguments != 2)
+    {
+        cout << "Usage: SegmentedAnalysisRegression [video]" << endl;
+        return EXIT_FAILURE;
+    }
+
+    // Segments are threads, which need wxWidgets' base library...
+    wxInitializer Initializer;
+    if(!Initializer.IsOk())
+    {
+        cout << "Unable to initialize wxWidgets..." << endl;
+        return EXIT_FAILURE;
+    }
+
+    // Analyze it whole...
+    cout << "Whole..." << endl;
+    if(!Measure(ppszArguments[1], 0, Whole, WholeTimeSeries))
+        return EXIT_FAILURE;
+
+    // And split into each number of segments...
+    for(unsigned int unIndex = 0; unIndex < unSegmentCounts; ++unIndex)
+    {
+        // Alert user...
+        cout << Segments[unIndex] << " segments..." << endl;
+
+        // Analyze and compare...
+        if(!Measure(ppszArguments[1], Segments[unIndex], Segmented,
+                    SegmentedTimeSeries) ||
+           !IsSameMeasurements(Whole, WholeTimeSeries, Segmented,
+                               SegmentedTimeSeries))
+        {
+            cout << "\t...FAILED" << endl;
+            bAllPassed = false;
+        }
+    }
+
+    // Report...
+    cout << (bAllPassed ? "Segmented analysis matches."
+                        : "Segmented analysis DIFFERS.") << endl;
+
+    // Done...
+    return bAllPassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,96 @@
+/*
+  Name:         SyntheticWorm.h
+  Author:       Kip Warner (Kip@TheVertigo.com)
+  Description:  Outlines of synthetic worms drawn from arcs and lines, and a
+                worm refreshed from one drawn dark on a bright plate, shared
+                by the drivers that check what is measured against what was
+                drawn...
+*/
+
+// Multiple include protection...
+#ifndef _SYNTHETIC_WORM_H_
+#define _SYNTHETIC_WORM_H_
+
+// Includes...
+
+    // Our stuff...
+    #include "../Source/Worm.h"
+
+    // OpenCV...
+    #include <opencv2/opencv.hpp>
+
+    // Standard libraries and STL...
+    #include <vector>
+    #include <cmath>
+
+    // Using the standard namespace...
+    using namespace std;
+
+// Add the pixels along an arc to the end of an outline, without repeating any
+//  one twice in a row...
+inline void AddArc(vector<cv::Point> &Points, cv::Point2d const &Centre,
+                   double const dRadius, double const dFrom,
+                   double const dTo)
+{
+    // Small enough steps that no pixel is skipped...
+    unsigned int const unSteps =
+        (unsigned int) ceil(fabs(dTo - dFrom) * dRadius * 4.0) + 1;
+
+    // Each step...
+    for(unsigned int unStep = 0; unStep <= unSteps; ++unStep)
+    {
+        // Where it is...
+        double const dAngle = dFrom + (dTo - dFrom) * unStep / unSteps;
+        cv::Point const Point(
+            (int) lround(Centre.x + dRadius * cos(dAngle)),
+            (int) lround(Centre.y + dRadius * sin(dAngle)));
+
+        // Add it, if it is a new pixel...
+        if(Points.empty() || Points.back() != Point)
+            Points.push_back(Point);
+    }
+}
+
+// Add the pixels along a line to the end of an outline, without repeating any
+//  one twice in a row...
+inline void AddLine(vector<cv::Point> &Points, cv::Point2d const &From,
+                    cv::Point2d const &To)
+{
+    // Small enough steps that no pixel is skipped...
+    unsigned int const unSteps =
+        (unsigned int) ceil(cv::norm(To - From) * 4.0) + 1;
+
+    // Each step...
+    for(unsigned int unStep = 0; unStep <= unSteps; ++unStep)
+    {
+        // Where it is...
+        cv::Point2d const Along = From + (To - From) * unStep / unSteps;
+        cv::Point const Point(
+            (int) lround(Along.x), (int) lround(Along.y));
+
+        // Add it, if it is a new pixel...
+        if(Points.empty() || Points.back() != Point)
+            Points.push_back(Point);
+    }
+}
+
+// Refresh a worm from the outline, drawn dark on a bright plate...
+inline void RefreshFrom(Worm &TestWorm, vector<cv::Point> Points)
+{
+    // The outline is closed, so it mustn't end where it began...
+    while(Points.size() > 1 && Points.back() == Points.front())
+        Points.pop_back();
+
+    // Draw it...
+    cv::Mat GrayImage(400, 400, CV_8UC1, cv::Scalar(200));
+    cv::Point const *pPoints    = &Points[0];
+    int const        nPoints    = (int) Points.size();
+    cv::fillPoly(GrayImage, &pPoints, &nPoints, 1, cv::Scalar(50));
+
+    // Refresh the worm from it...
+    Outline Contour;
+    Contour.Assign(Points);
+    TestWorm.Refresh(Contour, GrayImage);
+}
+
+#endif
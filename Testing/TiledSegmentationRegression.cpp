@@ -0,0 +1,157 @@
+/*
+  Name:         TiledSegmentationRegression.cpp
+  Author:       Kip Warner (Kip@TheVertigo.com)
+  Description:  Checks that tracking with the frame segmented in parallel
+                tiles, or with where to look found first from a reduced copy
+                of it, finds exactly the same worms as without either...
+  Quick Debug:  g++ -I../Source `pkg-config --cflags opencv4` `wx-config --cflags` TiledSegmentationRegression.cpp ../Source/WormTracker.cpp ../Source/Worm.cpp ../Source/Outline.cpp ../Source/EdgeGrid.cpp ../Source/MorphologyFilter.cpp ../Source/BackgroundModel.cpp ../Source/ThresholdCalibrator.cpp ../Source/SlitherMath.cpp ../Source/TimeSeriesPool.cpp -g3 -o TiledSegmentationRegression -Wall -Werror `pkg-config --libs opencv4` `wx-config --libs` && ./TiledSegmentationRegression TrackerFrame1.png TrackerFrame2.png TrackerFrame3.png TrackerFrame4.png
+*/
+
+// Includes...
+#include "../Source/WormTracker.h"
+#include <opencv2/opencv.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <iostream>
+#include <cstdlib>
+
+// Using the standard namespace...
+using namespace std;
+
+// Do the two trackers know exactly the same worms? Each worm's contour is the
+//  candidate it was matched with this frame...
+static bool IsSameWorms(WormTracker const &Plain, WormTracker const &Variant)
+{
+    // Same number...
+    if(Plain.Tracking() != Variant.Tracking())
+    {
+        cout << "\tTracking " << Plain.Tracking() << " worms plainly, but "
+             << Variant.Tracking() << " otherwise" << endl;
+        return false;
+    }
+
+    // Each the same...
+    for(unsigned int unWormIndex = 0; unWormIndex < Plain.Tracking();
+      ++unWormIndex)
+    {
+        // Worms to compare...
+        Worm const &PlainWorm   = Plain.GetWorm(unWormIndex);
+        Worm const &VariantWorm = Variant.GetWorm(unWormIndex);
+
+        // Every vertex of the contour, and so everything measured from it...
+        if(PlainWorm.Contour().Vertices() != 
+                VariantWorm.Contour().Vertices() ||
+           PlainWorm.Refreshes() != VariantWorm.Refreshes() ||
+           PlainWorm.Length() != VariantWorm.Length() ||
+           PlainWorm.Width() != VariantWorm.Width() ||
+           PlainWorm.Area() != VariantWorm.Area())
+        {
+            cout << "\tWorm " << unWormIndex + 1 << " differs" << endl;
+            return false;
+        }
+    }
+
+    // Identical...
+    return true;
+}
+
+// Entry point...
+int main(int nArguments, char *ppszArguments[])
+{
+    // Constants...
+
+        // Tile heights, from many seams to few...
+        unsigned int const  TileRows[]      = { 1, 7, 16, 64 };
+        unsigned int const  unTilings       = 
+            sizeof(TileRows) / sizeof(TileRows[0]);
+
+        // Times to reduce each side by to find where to look...
+        unsigned int const  CoarseScales[]  = { 4 };
+        unsigned int const  unCoarseScales  = 
+            sizeof(CoarseScales) / sizeof(CoarseScales[0]);
+
+    // Variables...
+    bool                    bAllSame    = true;
+
+    // Print usage...
+    if(nArguments <= 1)
+    {
+        cout << "Usage: TiledSegmentationRegression [frame1.png] ..."
+                " [frameN.png]" << endl
+             << "\t...such that each frame is grayscale." << endl << endl;
+        return 0;
+    }
+
+    // With and without inlet detection, for each tile height and then each
+    //  coarse scale...
+    for(unsigned int unInlet = 0; unInlet < 2; ++unInlet)
+    {
+        for(unsigned int unVariant = 0;
+            unVariant < unTilings + unCoarseScales;
+          ++unVariant)
+        {
+            // Trackers set up the same but for the tiling or coarse scale...
+            WormTracker Plain;
+            WormTracker Variant;
+            Plain.SetFieldOfViewDiameter(5.0f);
+            Plain.SetArtificialIntelligenceMagic(
+                150, 255, 50, 120, unInlet == 1, 5);
+            Variant.ImportSettings(Plain);
+            if(unVariant < unTilings)
+                Variant.SetTiledSegmentation(TileRows[unVariant]);
+            else
+                Variant.SetCoarseDetection(
+                    CoarseScales[unVariant - unTilings]);
+
+            // Alert user...
+            cout << "Inlet detection " << (unInlet ? "on" : "off") << ", ";
+            if(unVariant < unTilings)
+                cout << "tiles of " << TileRows[unVariant] << " rows...";
+            else
+                cout << "reduced " << CoarseScales[unVariant - unTilings]
+                     << " times...";
+            cout << endl;
+
+            // Track each frame with both...
+            for(int nFrame = 1; nFrame < nArguments; ++nFrame)
+            {
+                // Load the image...
+                cv::Mat const GrayImage =
+                    cv::imread(ppszArguments[nFrame], cv::IMREAD_GRAYSCALE);
+                if(GrayImage.empty())
+                {
+                    cerr << "Unable to load " << ppszArguments[nFrame] << endl;
+                    return EXIT_FAILURE;
+                }
+
+                // Advance both...
+                Plain.Advance(GrayImage);
+                Variant.Advance(GrayImage);
+
+                // They must agree...
+                if(!IsSameWorms(Plain, Variant))
+                {
+                    cout << "\t...after " << ppszArguments[nFrame] << endl;
+                    bAllSame = false;
+                    break;
+                }
+            }
+
+            // Where to look must really have been found coarsely...
+            if(unVariant >= unTilings &&
+               Variant.GetStageTimings().unCoarseScans == 0)
+            {
+                cout << "\tNever scanned coarsely" << endl;
+                bAllSame = false;
+            }
+        }
+    }
+
+    // Report...
+    cout << (bAllSame ? "Tiled, coarse, and plain segmentation agree."
+                      : "Tiled, coarse, and plain segmentation DIFFER.")
+         << endl;
+
+    // Done...
+    return bAllSame ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
@@ -0,0 +1,212 @@
+/*
+  Name:         TimeSeriesRoundTrip.cpp
+  Author:       Kip Warner (Kip@TheVertigo.com)
+  Description:  Checks that every sample appended to a time series pool comes
+                back out unchanged and in order, whether it stayed in memory
+                or was spilled to disk and read back, and after the pool is
+                cleared and its chunks reused...
+  Quick Debug:  g++ -I../Source TimeSeriesRoundTrip.cpp ../Source/TimeSeriesPool.cpp -g3 -o TimeSeriesRoundTrip -Wall -Werror && ./TimeSeriesRoundTrip
+*/
+
+// Includes...
+#include "../Source/TimeSeriesPool.h"
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+// Using the standard namespace...
+using namespace std;
+
+// Make up a sample that can only be the given one of the given series...
+static WormSample MakeSample(unsigned int const unSeries,
+                             unsigned int const unSample)
+{
+    // Every field from both, so that any mixed up would show...
+    WormSample Sample;
+    memset(&Sample, 0, sizeof(Sample));
+    Sample.unFrame  = unSample;
+    Sample.CentreX  = (short) unSeries;
+    Sample.CentreY  = (short) (unSample % 30000);
+    Sample.HeadX    = (short) (unSeries + 1);
+    Sample.HeadY    = (short) (unSample % 20000);
+    Sample.TailX    = (short) (unSeries + 2);
+    Sample.TailY    = (short) (unSample % 10000);
+    Sample.fLength  = unSeries * 1000.0f + unSample * 0.5f;
+    Sample.fWidth   = unSeries + unSample * 0.25f;
+    Sample.fArea    = unSeries * 10.0f + unSample;
+    Sample.TangentAngles[unSample % WormSample::POSTURE_ANGLES] =
+        (short) (unSeries + 3);
+    Sample.Projections[unSeries % WormSample::MAXIMUM_POSTURE_MODES] =
+        unSample * 0.125f;
+    Sample.unPostureModes   = (unsigned char) (unSeries + 1);
+    Sample.bPostureValid    = (unSample % 2 == 0);
+
+    // Done...
+    return Sample;
+}
+
+// Append so many samples to each of so many series, a sample to each in turn
+//  as a tracker would one frame after another...
+static void Fill(TimeSeriesPool &Pool, unsigned int const unSeries,
+                 unsigned int const unSamples)
+{
+    // Each frame...
+    for(unsigned int unSample = 0; unSample < unSamples; ++unSample)
+    {
+        // Each series...
+        for(unsigned int unCurrent = 0; unCurrent < unSeries; ++unCurrent)
+            Pool.Append(unCurrent, MakeSample(unCurrent, unSample));
+    }
+}
+
+// Does every series come back out just as it went in, and no more?
+static bool IsRoundTripped(TimeSeriesPool const &Pool,
+                           unsigned int const unSeries,
+                           unsigned int const unSamples)
+{
+    // Variables...
+    vector<WormSample>  Samples;
+
+    // As many series...
+    if(Pool.GetSeriesCount() != unSeries)
+    {
+        cout << "\t" << Pool.GetSeriesCount() << " series (expected "
+             << unSeries << ")" << endl;
+        return false;
+    }
+
+    // Each series...
+    for(unsigned int unCurrent = 0; unCurrent < unSeries; ++unCurrent)
+    {
+        // Read it back...
+        if(!Pool.GetSamples(unCurrent, Samples))
+        {
+            cout << "\tSeries " << unCurrent << " couldn't be read back"
+                 << endl;
+            return false;
+        }
+
+        // As many samples...
+        if(Pool.GetSampleCount(unCurrent) != unSamples ||
+           Samples.size() != unSamples)
+        {
+            cout << "\tSeries " << unCurrent << " has " << Samples.size()
+                 << " samples (expected " << unSamples << ")" << endl;
+            return false;
+        }
+
+        // Each unchanged, and in order...
+        for(unsigned int unSample = 0; unSample < unSamples; ++unSample)
+        {
+            WormSample const Expected = MakeSample(unCurrent, unSample);
+            if(memcmp(&Samples[unSample], &Expected, sizeof(WormSample)) != 0)
+            {
+                cout << "\tSeries " << unCurrent << " sample " << unSample
+                     << " differs" << endl;
+                return false;
+            }
+        }
+    }
+
+    // Series never appended to are empty...
+    if(Pool.GetSampleCount(unSeries) != 0 ||
+       !Pool.GetSamples(unSeries, Samples) || !Samples.empty())
+    {
+        cout << "\tSeries " << unSeries << " isn't empty" << endl;
+        return false;
+    }
+
+    // Identical...
+    return true;
+}
+
+// Entry point...
+int main()
+{
+    // Constants. Enough samples for a few chunks in each series and a partly
+    //  filled one at the end, and few enough chunks allowed in memory that
+    //  most must be spilled...
+    unsigned int const  unSeries        = 5;
+    unsigned int const  unSamples       = 3500;
+    unsigned int const  unResidentLimit = 4;
+
+    // Variables...
+    bool                bAllPassed      = true;
+
+    // Everything kept in memory...
+    {
+        // Alert user...
+        cout << "In memory..." << endl;
+
+        // Fill and check it...
+        TimeSeriesPool Pool;
+        Pool.SetResidentLimit(0);
+        Fill(Pool, unSeries, unSamples);
+        cout << "\t" << Pool.GetSpilledChunks() << " chunks spilled" << endl;
+        if(Pool.GetSpilledChunks() != 0 ||
+           !IsRoundTripped(Pool, unSeries, unSamples))
+        {
+            cout << "\t...FAILED" << endl;
+            bAllPassed = false;
+        }
+    }
+
+    // Most spilled to disk, then cleared and filled again with fewer, which
+    //  reuses the chunks and writes over the spill file...
+    {
+        // Alert user...
+        cout << "Spilled..." << endl;
+
+        // Fill and check it...
+        TimeSeriesPool Pool;
+        Pool.SetResidentLimit(unResidentLimit);
+        Fill(Pool, unSeries, unSamples);
+        cout << "\t" << Pool.GetSpilledChunks() << " chunks spilled" << endl;
+        if(Pool.GetSpilledChunks() == 0 ||
+           !IsRoundTripped(Pool, unSeries, unSamples))
+        {
+            cout << "\t...FAILED" << endl;
+            bAllPassed = false;
+        }
+
+        // Alert user...
+        cout << "Cleared and spilled again..." << endl;
+
+        // Clear, fill, and check it again...
+        Pool.Clear();
+        Fill(Pool, unSeries - 2, unSamples / 2);
+        cout << "\t" << Pool.GetSpilledChunks() << " chunks spilled" << endl;
+        if(Pool.GetSpilledChunks() == 0 ||
+           !IsRoundTripped(Pool, unSeries - 2, unSamples / 2))
+        {
+            cout << "\t...FAILED" << endl;
+            bAllPassed = false;
+        }
+    }
+
+    // Limit lowered after filling, which spills whatever is now over it...
+    {
+        // Alert user...
+        cout << "Limit lowered..." << endl;
+
+        // Fill, lower, and check it...
+        TimeSeriesPool Pool;
+        Pool.SetResidentLimit(0);
+        Fill(Pool, unSeries, unSamples);
+        Pool.SetResidentLimit(unResidentLimit);
+        cout << "\t" << Pool.GetSpilledChunks() << " chunks spilled" << endl;
+        if(Pool.GetSpilledChunks() == 0 ||
+           !IsRoundTripped(Pool, unSeries, unSamples))
+        {
+            cout << "\t...FAILED" << endl;
+            bAllPassed = false;
+        }
+    }
+
+    // Report...
+    cout << (bAllPassed ? "Time series round trip."
+                        : "Time series DON'T round trip.") << endl;
+
+    // Done...
+    return bAllPassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -220,8 +220,14 @@ int main(int nArguments, char *ppszArguments[])
                      << " vertices... " << endl;
                 flush(cout);
 
+            // Copy the contour's vertices out into an outline...
+            vector<cv::Point> Vertices;
+            cv::cvarrToMat(pCurrentContour).copyTo(Vertices);
+            Outline CurrentOutline;
+            CurrentOutline.Assign(Vertices);
+
             // Refresh worm's new state...
-            Nematode.Refresh(*pCurrentContour, *pGrayImage);
+            Nematode.Refresh(CurrentOutline, cv::cvarrToMat(pGrayImage));
 
             // Pick a colour for the contour outline...
             CvScalar Color = CV_RGB(0xFF, 0xFF, 0xFF);